@@ -0,0 +1,187 @@
+#pragma once
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Minimal self-contained benchmark harness for ntl_bench. Each suite is a
+// function registered at static initialization time; it runs its cases
+// through a context that handles filtering, timing and result collection.
+namespace bench
+{
+   // Keeps the compiler from discarding a value or the stores behind it
+   template <typename T>
+   inline void do_not_optimize(const T& value)
+   {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile("" : : "r,m"(value) : "memory");
+#else
+      const volatile char* sink = reinterpret_cast<const volatile char*>(&value);
+      (void)*sink;
+#endif
+   }
+
+   inline void clobber_memory()
+   {
+#if defined(__GNUC__) || defined(__clang__)
+      asm volatile("" : : : "memory");
+#endif
+   }
+
+   struct result
+   {
+      std::string m_Suite;
+      std::string m_Op;
+      std::string m_Type;
+      std::string m_Container;
+      std::size_t m_MaxElems;
+      double m_NsPerElem;
+      std::uint64_t m_Iterations;
+   };
+
+   struct options
+   {
+      std::string m_Filter;
+      double m_MinTimeMs = 10.0;
+      unsigned m_Repetitions = 3;
+      bool m_Json = false;
+   };
+
+   class context
+   {
+   public:
+      explicit context(const options& opts) :
+         m_Options(opts)
+      {
+      }
+
+      const options& get_options() const noexcept
+      {
+         return m_Options;
+      }
+
+      // Full name of a case, matched against --filter
+      static std::string name_of(const result& r);
+
+      bool selected(const result& r) const;
+
+      void add(const result& r);
+
+      const std::vector<result>& results() const noexcept
+      {
+         return m_Results;
+      }
+
+      // Times a batch of containers: setup(c) runs untimed on every
+      // container of the batch, then op(c) runs timed on each of them.
+      // Batches repeat until the minimum time has elapsed; the fastest of
+      // the repetitions is reported, in nanoseconds per element.
+      template <typename Container, typename Setup, typename Op>
+      void run_batched(result r, std::size_t batchSize, std::size_t elemsPerOp, Setup setup, Op op)
+      {
+         if (!selected(r))
+         {
+            return;
+         }
+
+         std::vector<Container> batch(batchSize);
+         double best = 0.0;
+         std::uint64_t totalOps = 0;
+         for (unsigned rep = 0; rep < m_Options.m_Repetitions; ++rep)
+         {
+            std::chrono::steady_clock::duration elapsed{};
+            std::uint64_t ops = 0;
+            while (std::chrono::duration<double, std::milli>(elapsed).count() < m_Options.m_MinTimeMs)
+            {
+               for (Container& c : batch)
+               {
+                  setup(c);
+               }
+
+               clobber_memory();
+               auto start = std::chrono::steady_clock::now();
+               for (Container& c : batch)
+               {
+                  op(c);
+               }
+
+               clobber_memory();
+               elapsed += std::chrono::steady_clock::now() - start;
+               ops += batchSize;
+            }
+
+            double ns = std::chrono::duration<double, std::nano>(elapsed).count() / (double(ops) * elemsPerOp);
+            best = rep == 0 ? ns : (ns < best ? ns : best);
+            totalOps += ops;
+         }
+
+         r.m_NsPerElem = best;
+         r.m_Iterations = totalOps;
+         add(r);
+      }
+
+      // Times op() on its own, for cases whose state cannot live in a batch
+      // of default constructed containers. Reported as run_batched does.
+      template <typename Op>
+      void run(result r, std::size_t elemsPerOp, Op op)
+      {
+         if (!selected(r))
+         {
+            return;
+         }
+
+         double best = 0.0;
+         std::uint64_t totalOps = 0;
+         for (unsigned rep = 0; rep < m_Options.m_Repetitions; ++rep)
+         {
+            std::chrono::steady_clock::duration elapsed{};
+            std::uint64_t ops = 0;
+            while (std::chrono::duration<double, std::milli>(elapsed).count() < m_Options.m_MinTimeMs)
+            {
+               clobber_memory();
+               auto start = std::chrono::steady_clock::now();
+               op();
+               clobber_memory();
+               elapsed += std::chrono::steady_clock::now() - start;
+               ++ops;
+            }
+
+            double ns = std::chrono::duration<double, std::nano>(elapsed).count() / (double(ops) * elemsPerOp);
+            best = rep == 0 ? ns : (ns < best ? ns : best);
+            totalOps += ops;
+         }
+
+         r.m_NsPerElem = best;
+         r.m_Iterations = totalOps;
+         add(r);
+      }
+
+   private:
+      options m_Options;
+      std::vector<result> m_Results;
+   };
+
+   using suite_func = void (*)(context&);
+
+   struct suite
+   {
+      const char* m_Name;
+      suite_func m_Func;
+   };
+
+   std::vector<suite>& registry();
+
+   struct registrar
+   {
+      registrar(const char* name, suite_func func)
+      {
+         registry().push_back(suite{ name, func });
+      }
+   };
+}
+
+#define NTL_BENCH_SUITE(name) \
+   static void name##_suite(::bench::context&); \
+   static ::bench::registrar name##_registrar(#name, &name##_suite); \
+   static void name##_suite(::bench::context& ctx)
@@ -0,0 +1,122 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_vector.h"
+#include "concurrent_bounded_vector.h"
+
+// Worker threads collecting results into one shared vector:
+// concurrent_bounded_vector against a bounded_vector behind a std::mutex,
+// from 1 to 32 threads. Every case appends the same total.
+namespace
+{
+   constexpr std::size_t collect_elems = 1 << 20;
+
+   using concurrent_type = ntl::concurrent_bounded_vector<std::uint64_t, collect_elems>;
+
+   struct locked_vector
+   {
+      std::mutex m_Lock;
+      ntl::bounded_vector<std::uint64_t, collect_elems> m_Elems;
+   };
+
+   // Runs produce(thread, count) on numThreads threads released together;
+   // reset() runs untimed before every repetition
+   template <typename Reset, typename Produce>
+   void run_threads(bench::context& ctx, bench::result r, unsigned numThreads, Reset reset, Produce produce)
+   {
+      if (!ctx.selected(r))
+      {
+         return;
+      }
+
+      std::size_t perThread = collect_elems / numThreads;
+      double best = 0.0;
+      for (unsigned rep = 0; rep < ctx.get_options().m_Repetitions; ++rep)
+      {
+         reset();
+         std::atomic<unsigned> ready(0);
+         std::atomic<bool> go(false);
+         std::vector<std::thread> threads;
+         for (unsigned t = 0; t < numThreads; ++t)
+         {
+            threads.emplace_back([&ready, &go, &produce, t, perThread]()
+            {
+               ready.fetch_add(1);
+               while (!go.load(std::memory_order_acquire))
+               {
+               }
+
+               produce(t, perThread);
+            });
+         }
+
+         while (ready.load() != numThreads)
+         {
+         }
+
+         auto start = std::chrono::steady_clock::now();
+         go.store(true, std::memory_order_release);
+         for (std::thread& th : threads)
+         {
+            th.join();
+         }
+
+         double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (perThread * numThreads);
+         best = rep == 0 ? ns : (ns < best ? ns : best);
+      }
+
+      r.m_NsPerElem = best;
+      r.m_Iterations = static_cast<std::uint64_t>(perThread) * numThreads * ctx.get_options().m_Repetitions;
+      ctx.add(r);
+   }
+
+   std::uint64_t make_result(unsigned thread, std::size_t i)
+   {
+      return std::uint64_t(thread) << 32 | i;
+   }
+}
+
+NTL_BENCH_SUITE(concurrent)
+{
+   std::unique_ptr<concurrent_type> concurrent(new concurrent_type);
+   std::unique_ptr<locked_vector> locked(new locked_vector);
+
+   for (unsigned numThreads : { 1u, 2u, 4u, 8u, 16u, 32u })
+   {
+      const std::string op = "push_back/" + std::to_string(numThreads) + "t";
+
+      run_threads(ctx, bench::result{ "concurrent", op, "uint64", "ntl::concurrent_bounded_vector", collect_elems, 0.0, 0 }, numThreads,
+         [&concurrent]()
+         {
+            concurrent->clear();
+         },
+         [&concurrent](unsigned t, std::size_t count)
+         {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               concurrent->push_back(make_result(t, i));
+            }
+         });
+
+      run_threads(ctx, bench::result{ "concurrent", op, "uint64", "std::mutex+ntl::bounded_vector", collect_elems, 0.0, 0 }, numThreads,
+         [&locked]()
+         {
+            locked->m_Elems.clear();
+         },
+         [&locked](unsigned t, std::size_t count)
+         {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               std::lock_guard<std::mutex> guard(locked->m_Lock);
+               locked->m_Elems.push_back(make_result(t, i));
+            }
+         });
+   }
+}
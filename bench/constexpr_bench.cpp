@@ -0,0 +1,65 @@
+#include <cstdint>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// Lookup tables built by bounded_vector during constant evaluation land in
+// .rodata; the same tables built at runtime cost startup time. The
+// compile-time checks of the constexpr API are in
+// tests/constexpr_vector_test.cpp.
+#if NTL_CONSTEXPR_CONTAINERS
+namespace
+{
+   using crc_table_type = ntl::bounded_vector<std::uint32_t, 256>;
+
+   constexpr std::uint32_t crc32_polynomial = 0xEDB88320u;
+
+   constexpr crc_table_type make_crc32_table(std::uint32_t polynomial)
+   {
+      crc_table_type table;
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+         std::uint32_t crc = i;
+         for (int bit = 0; bit < 8; ++bit)
+         {
+            crc = (crc & 1) != 0 ? polynomial ^ (crc >> 1) : crc >> 1;
+         }
+
+         table.push_back(crc);
+      }
+
+      return table;
+   }
+
+   constexpr crc_table_type s_Crc32Table = make_crc32_table(crc32_polynomial);
+
+   // The polynomial is read through a volatile so the optimizer cannot
+   // fold the runtime build back into a constant
+   crc_table_type build_crc32_table_at_runtime()
+   {
+      volatile std::uint32_t polynomial = crc32_polynomial;
+      return make_crc32_table(polynomial);
+   }
+}
+
+NTL_BENCH_SUITE(constexpr_table)
+{
+   // What a table filled by a static initializer costs at every startup;
+   // the constexpr table costs nothing since it is already in the image
+   ctx.run_batched<crc_table_type>(bench::result{ "constexpr_table", "crc32_build_runtime", "uint32", "ntl::bounded_vector", 256, 0.0, 0 }, 16, 256,
+      [](crc_table_type&) {},
+      [](crc_table_type& t)
+      {
+         t = build_crc32_table_at_runtime();
+         bench::do_not_optimize(t);
+      });
+
+   ctx.run_batched<crc_table_type>(bench::result{ "constexpr_table", "crc32_copy_constexpr", "uint32", "ntl::bounded_vector", 256, 0.0, 0 }, 16, 256,
+      [](crc_table_type&) {},
+      [](crc_table_type& t)
+      {
+         t = s_Crc32Table;
+         bench::do_not_optimize(t);
+      });
+}
+#endif
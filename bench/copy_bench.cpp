@@ -0,0 +1,140 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// Copy construction of a bounded_vector at several fill fractions. The
+// copy touches only size() elements, so its cost follows the fill. A
+// memcpy of the whole object is the cost of copying every slot, which is
+// what the copy constructor used to do. Reported in ns per copy.
+namespace
+{
+   // Raw storage that a copy is constructed into, so only the copy
+   // constructor is timed. The previous copy is destroyed in the untimed
+   // setup.
+   template <typename Vector>
+   class copy_target
+   {
+   public:
+      copy_target() = default;
+      copy_target(const copy_target&) = delete;
+      copy_target& operator = (const copy_target&) = delete;
+
+      ~copy_target()
+      {
+         reset();
+      }
+
+      void reset() noexcept
+      {
+         if (m_Constructed)
+         {
+            get()->~Vector();
+            m_Constructed = false;
+         }
+      }
+
+      void copy_from(const Vector& src)
+      {
+         ::new (static_cast<void*>(&m_Storage)) Vector(src);
+         m_Constructed = true;
+      }
+
+      void memcpy_from(const Vector& src) noexcept
+      {
+         std::memcpy(static_cast<void*>(&m_Storage), static_cast<const void*>(&src), sizeof(Vector));
+      }
+
+      Vector* get() noexcept
+      {
+         return reinterpret_cast<Vector*>(&m_Storage);
+      }
+
+   private:
+      std::aligned_storage_t<sizeof(Vector), alignof(Vector)> m_Storage;
+      bool m_Constructed = false;
+   };
+
+   constexpr std::size_t batch = 16;
+
+   struct fill_fraction
+   {
+      unsigned m_Permille;
+      const char* m_Name;
+   };
+
+   constexpr fill_fraction fill_fractions[] = {
+      { 1, "fill_0.1pct" },
+      { 10, "fill_1pct" },
+      { 100, "fill_10pct" },
+      { 500, "fill_50pct" },
+      { 1000, "fill_100pct" }
+   };
+
+   template <typename T, std::size_t N, typename Make>
+   void run_capacity(bench::context& ctx, const char* typeName, Make make, bool wholeBuffer)
+   {
+      using vector_type = ntl::bounded_vector<T, N>;
+      using target = copy_target<vector_type>;
+
+      std::unique_ptr<vector_type> src(new vector_type());
+      const vector_type& from = *src;
+
+      // Does not depend on the fill, so once per capacity is enough
+      if (wholeBuffer)
+      {
+         ctx.run_batched<target>(bench::result{ "copy", "whole_buffer", typeName, "memcpy", N, 0.0, 0 }, batch, 1,
+            [](target&) {},
+            [&from](target& t)
+            {
+               t.memcpy_from(from);
+               bench::do_not_optimize(*t.get());
+            });
+      }
+
+      for (const fill_fraction& fill : fill_fractions)
+      {
+         std::size_t count = N * fill.m_Permille / 1000;
+         src->clear();
+         for (std::size_t i = 0; i < (count != 0 ? count : 1); ++i)
+         {
+            src->push_back(make(i));
+         }
+
+         ctx.run_batched<target>(bench::result{ "copy", fill.m_Name, typeName, "ntl::bounded_vector", N, 0.0, 0 }, batch, 1,
+            [](target& t) { t.reset(); },
+            [&from](target& t)
+            {
+               t.copy_from(from);
+               bench::do_not_optimize(*t.get());
+            });
+      }
+   }
+
+   std::uint32_t make_word(std::size_t i)
+   {
+      return static_cast<std::uint32_t>(i);
+   }
+
+   std::string make_string(std::size_t i)
+   {
+      return std::string(8, static_cast<char>('a' + i % 26));
+   }
+}
+
+NTL_BENCH_SUITE(copy)
+{
+   run_capacity<std::uint32_t, 16384>(ctx, "uint32", make_word, true);
+   run_capacity<std::uint32_t, 64>(ctx, "uint32", make_word, true);
+
+   // 128 bytes: small enough that the whole buffer is still copied as one
+   // fixed-size block and the vector stays trivially copyable
+   run_capacity<std::uint32_t, 32>(ctx, "uint32", make_word, true);
+   run_capacity<std::string, 1024>(ctx, "string", make_string, false);
+}
@@ -0,0 +1,162 @@
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// An expiration sweep over a full 4096-entry bounded_vector that removes
+// 10% or 30% of the entries: the erase-in-a-loop idiom, which shifts the
+// tail once per removed element, against an erase_unordered loop and the
+// single-pass erase_if.
+namespace
+{
+   constexpr std::size_t max_elems = 4096;
+
+   struct record64
+   {
+      std::uint32_t m_Id;
+      std::uint32_t m_Expiry;
+      char m_Padding[56];
+   };
+
+   static_assert(sizeof(record64) == 64, "record64 must be 64 bytes");
+
+   template <typename T>
+   struct element;
+
+   template <>
+   struct element<int>
+   {
+      static const char* name()
+      {
+         return "int";
+      }
+
+      static int make(unsigned expiry)
+      {
+         return static_cast<int>(expiry);
+      }
+
+      static unsigned expiry(int v)
+      {
+         return static_cast<unsigned>(v);
+      }
+   };
+
+   template <>
+   struct element<record64>
+   {
+      static const char* name()
+      {
+         return "record64";
+      }
+
+      static record64 make(unsigned expiry)
+      {
+         record64 r{};
+         r.m_Expiry = expiry;
+         return r;
+      }
+
+      static unsigned expiry(const record64& r)
+      {
+         return r.m_Expiry;
+      }
+   };
+
+   // The expiry is kept in the leading character, past which the string
+   // is long enough to defeat the small string optimization
+   template <>
+   struct element<std::string>
+   {
+      static const char* name()
+      {
+         return "string";
+      }
+
+      static std::string make(unsigned expiry)
+      {
+         std::string s(32, 'x');
+         s[0] = static_cast<char>(expiry);
+         return s;
+      }
+
+      static unsigned expiry(const std::string& s)
+      {
+         return static_cast<unsigned char>(s[0]);
+      }
+   };
+
+   std::string op_name(const char* op, unsigned percent)
+   {
+      std::string name(op);
+      name += '/';
+      name += std::to_string(percent);
+      name += "pct";
+      return name;
+   }
+
+   template <typename T>
+   void run_fraction(bench::context& ctx, const ntl::bounded_vector<T, max_elems>& source, unsigned percent)
+   {
+      using container = ntl::bounded_vector<T, max_elems>;
+
+      auto expired = [percent](const T& v) { return element<T>::expiry(v) < percent; };
+
+      ctx.run_batched<container>(bench::result{ "erase", op_name("erase_loop", percent), element<T>::name(), "ntl::bounded_vector", max_elems, 0.0, 0 }, 1, max_elems,
+         [&source](container& c) { c = source; },
+         [&expired](container& c)
+         {
+            for (auto it = c.begin(); it != c.end();)
+            {
+               it = expired(*it) ? c.erase(it) : it + 1;
+            }
+
+            bench::do_not_optimize(c);
+         });
+
+      ctx.run_batched<container>(bench::result{ "erase", op_name("erase_unordered_loop", percent), element<T>::name(), "ntl::bounded_vector", max_elems, 0.0, 0 }, 1, max_elems,
+         [&source](container& c) { c = source; },
+         [&expired](container& c)
+         {
+            for (auto it = c.begin(); it != c.end();)
+            {
+               it = expired(*it) ? c.erase_unordered(it) : it + 1;
+            }
+
+            bench::do_not_optimize(c);
+         });
+
+      ctx.run_batched<container>(bench::result{ "erase", op_name("erase_if", percent), element<T>::name(), "ntl::bounded_vector", max_elems, 0.0, 0 }, 1, max_elems,
+         [&source](container& c) { c = source; },
+         [&expired](container& c)
+         {
+            ntl::erase_if(c, expired);
+            bench::do_not_optimize(c);
+         });
+   }
+
+   template <typename T>
+   void run_type(bench::context& ctx)
+   {
+      // Expiries are uniform over 0..99, so "below percent" removes that share
+      std::mt19937 rng(1);
+      ntl::bounded_vector<T, max_elems> source;
+      for (std::size_t i = 0; i < max_elems; ++i)
+      {
+         source.push_back(element<T>::make(rng() % 100));
+      }
+
+      run_fraction<T>(ctx, source, 10);
+      run_fraction<T>(ctx, source, 30);
+   }
+}
+
+NTL_BENCH_SUITE(erase)
+{
+   run_type<int>(ctx);
+   run_type<record64>(ctx);
+   run_type<std::string>(ctx);
+}
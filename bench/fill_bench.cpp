@@ -0,0 +1,82 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// Filling a receive buffer from a read()-like source: staging through a
+// temporary and inserting, resize() (zero-fills) or resize_for_overwrite()
+// followed by the read, and append_uninitialized() + commit_append()
+namespace
+{
+   constexpr std::size_t buffer_bytes = 4096;
+
+   using buffer_type = ntl::bounded_vector<std::uint8_t, buffer_bytes>;
+
+   std::uint8_t s_Source[buffer_bytes];
+
+   // Stands in for read()/recv(): copies up to len bytes and returns how
+   // many arrived. Kept out of line like the real system call.
+#if defined(_MSC_VER)
+   __declspec(noinline)
+#else
+   __attribute__((noinline))
+#endif
+   std::size_t receive(void* dst, std::size_t len)
+   {
+      std::memcpy(dst, s_Source, len);
+      return len;
+   }
+
+   void run_size(bench::context& ctx, std::size_t msgBytes)
+   {
+      const std::string suffix = std::to_string(msgBytes) + "B";
+
+      ctx.run_batched<buffer_type>(bench::result{ "fill", "temp_then_insert/" + suffix, "uint8", "ntl::bounded_vector", buffer_bytes, 0.0, 0 }, 16, msgBytes,
+         [](buffer_type& b) { b.clear(); },
+         [msgBytes](buffer_type& b)
+         {
+            std::uint8_t tmp[buffer_bytes];
+            std::size_t got = receive(tmp, msgBytes);
+            b.insert(b.end(), tmp, tmp + got);
+            bench::do_not_optimize(b);
+         });
+
+      ctx.run_batched<buffer_type>(bench::result{ "fill", "resize_then_read/" + suffix, "uint8", "ntl::bounded_vector", buffer_bytes, 0.0, 0 }, 16, msgBytes,
+         [](buffer_type& b) { b.clear(); },
+         [msgBytes](buffer_type& b)
+         {
+            b.resize(msgBytes);
+            b.resize(receive(b.data(), msgBytes));
+            bench::do_not_optimize(b);
+         });
+
+      ctx.run_batched<buffer_type>(bench::result{ "fill", "resize_for_overwrite_then_read/" + suffix, "uint8", "ntl::bounded_vector", buffer_bytes, 0.0, 0 }, 16, msgBytes,
+         [](buffer_type& b) { b.clear(); },
+         [msgBytes](buffer_type& b)
+         {
+            b.resize_for_overwrite(msgBytes);
+            b.resize(receive(b.data(), msgBytes));
+            bench::do_not_optimize(b);
+         });
+
+      ctx.run_batched<buffer_type>(bench::result{ "fill", "append_uninitialized/" + suffix, "uint8", "ntl::bounded_vector", buffer_bytes, 0.0, 0 }, 16, msgBytes,
+         [](buffer_type& b) { b.clear(); },
+         [msgBytes](buffer_type& b)
+         {
+            ntl::span<std::uint8_t> slots = b.append_uninitialized(msgBytes);
+            b.commit_append(receive(slots.data(), slots.size_bytes()));
+            bench::do_not_optimize(b);
+         });
+   }
+}
+
+NTL_BENCH_SUITE(fill)
+{
+   for (std::size_t msgBytes : { std::size_t(64), std::size_t(1500), buffer_bytes })
+   {
+      run_size(ctx, msgBytes);
+   }
+}
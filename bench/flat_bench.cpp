@@ -0,0 +1,97 @@
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_flat_map.h"
+
+// Lookup latency of bounded_flat_map, with the plain binary search and the
+// Eytzinger layout, against std::map and std::unordered_map. Half of the
+// lookups hit. Each key depends on the previous result, so the lookups
+// cannot overlap and the time is latency rather than throughput. Building
+// from unsorted input, which sorts once, is timed as well.
+namespace
+{
+   constexpr std::size_t query_count = 4096;
+
+   volatile int s_Zero = 0;
+
+   template <typename Map>
+   void run_lookup(bench::context& ctx, const char* name, std::size_t maxElems, const Map& m, const std::vector<int>& queries)
+   {
+      ctx.run(bench::result{ "flat", "find", "int", name, maxElems, 0.0, 0 }, queries.size(),
+         [&m, &queries]()
+         {
+            // Masking with a zero the compiler cannot see chains each key to the previous result
+            const int zero = s_Zero;
+            int sum = 0;
+            for (int q : queries)
+            {
+               auto it = m.find(q ^ (sum & zero));
+               sum += it != m.end() ? 1 + 2 * it->second : 1;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+
+   template <std::size_t N>
+   void run_size(bench::context& ctx)
+   {
+      using binary_map = ntl::bounded_flat_map<int, int, N>;
+      using eytzinger_map = ntl::bounded_flat_map<int, int, N, std::less<int>, ntl::flat_search::eytzinger>;
+
+      std::mt19937 rng(static_cast<std::uint32_t>(N));
+      std::vector<std::pair<int, int>> input;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         input.emplace_back(static_cast<int>(rng() >> 1), static_cast<int>(i));
+      }
+
+      std::vector<int> queries;
+      for (std::size_t i = 0; i < query_count; ++i)
+      {
+         queries.push_back(rng() % 2 != 0 ? input[rng() % N].first : static_cast<int>(rng() >> 1));
+      }
+
+      std::unique_ptr<binary_map> binary(new binary_map(input.begin(), input.end()));
+      std::unique_ptr<eytzinger_map> eytzinger(new eytzinger_map(input.begin(), input.end()));
+      std::map<int, int> tree(input.begin(), input.end());
+      std::unordered_map<int, int> hashed(input.begin(), input.end());
+
+      run_lookup(ctx, "ntl::bounded_flat_map", N, *binary, queries);
+      run_lookup(ctx, "ntl::bounded_flat_map/eytzinger", N, *eytzinger, queries);
+      run_lookup(ctx, "std::map", N, tree, queries);
+      run_lookup(ctx, "std::unordered_map", N, hashed, queries);
+
+      ctx.run_batched<binary_map>(bench::result{ "flat", "build_unsorted", "int", "ntl::bounded_flat_map", N, 0.0, 0 }, 1, N,
+         [](binary_map& m) { m.clear(); },
+         [&input](binary_map& m)
+         {
+            m.insert(input.begin(), input.end());
+            bench::do_not_optimize(m);
+         });
+
+      ctx.run(bench::result{ "flat", "build_unsorted", "int", "std::map", N, 0.0, 0 }, N,
+         [&input]()
+         {
+            std::map<int, int> m(input.begin(), input.end());
+            bench::do_not_optimize(m);
+         });
+   }
+}
+
+NTL_BENCH_SUITE(flat)
+{
+   run_size<16>(ctx);
+   run_size<64>(ctx);
+   run_size<256>(ctx);
+   run_size<1024>(ctx);
+   run_size<4096>(ctx);
+}
@@ -0,0 +1,101 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_flat_map.h"
+#include "bounded_hash_map.h"
+
+// bounded_hash_map against bounded_flat_map and std::unordered_map on
+// 64-bit session ids. Lookups are dependent, with 75% hits; churn erases
+// one key and inserts a fresh one while the map stays full, which is
+// where tombstones would build up.
+namespace
+{
+   constexpr std::size_t query_count = 4096;
+
+   volatile std::uint64_t s_Zero = 0;
+
+   template <typename Map>
+   void run_lookup(bench::context& ctx, const char* name, std::size_t maxElems, const Map& m, const std::vector<std::uint64_t>& queries)
+   {
+      ctx.run(bench::result{ "hash", "find", "uint64", name, maxElems, 0.0, 0 }, queries.size(),
+         [&m, &queries]()
+         {
+            // Masking with a zero the compiler cannot see chains each key to the previous result
+            const std::uint64_t zero = s_Zero;
+            std::uint64_t sum = 0;
+            for (std::uint64_t q : queries)
+            {
+               auto it = m.find(q ^ (sum & zero));
+               sum += it != m.end() ? 1 + 2 * static_cast<std::uint64_t>(it->second) : 1;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+
+   // Each call replaces every key once, oldest first, with a key never seen before
+   template <typename Map>
+   void run_churn(bench::context& ctx, const char* name, std::size_t maxElems, Map& m, std::vector<std::uint64_t> keys, std::uint64_t seed)
+   {
+      std::mt19937_64 rng(seed);
+      ctx.run(bench::result{ "hash", "erase_insert", "uint64", name, maxElems, 0.0, 0 }, keys.size(),
+         [&m, &keys, &rng]()
+         {
+            for (std::uint64_t& key : keys)
+            {
+               m.erase(key);
+               key = rng();
+               m.try_emplace(key, 1);
+            }
+
+            bench::do_not_optimize(m);
+         });
+   }
+
+   template <std::size_t N>
+   void run_size(bench::context& ctx)
+   {
+      using hash_map = ntl::bounded_hash_map<std::uint64_t, int, N>;
+      using flat_map = ntl::bounded_flat_map<std::uint64_t, int, N>;
+
+      std::mt19937_64 rng(N);
+      std::vector<std::pair<std::uint64_t, int>> input;
+      std::vector<std::uint64_t> keys;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         input.emplace_back(rng(), static_cast<int>(i));
+         keys.push_back(input.back().first);
+      }
+
+      std::vector<std::uint64_t> queries;
+      for (std::size_t i = 0; i < query_count; ++i)
+      {
+         queries.push_back(rng() % 4 != 0 ? keys[rng() % N] : rng());
+      }
+
+      std::unique_ptr<hash_map> hashed(new hash_map(input.begin(), input.end()));
+      std::unique_ptr<flat_map> flat(new flat_map(input.begin(), input.end()));
+      std::unordered_map<std::uint64_t, int> unordered(input.begin(), input.end());
+
+      run_lookup(ctx, "ntl::bounded_hash_map", N, *hashed, queries);
+      run_lookup(ctx, "ntl::bounded_flat_map", N, *flat, queries);
+      run_lookup(ctx, "std::unordered_map", N, unordered, queries);
+
+      run_churn(ctx, "ntl::bounded_hash_map", N, *hashed, keys, rng());
+      run_churn(ctx, "std::unordered_map", N, unordered, keys, rng());
+   }
+}
+
+NTL_BENCH_SUITE(hash)
+{
+   run_size<64>(ctx);
+   run_size<256>(ctx);
+   run_size<1024>(ctx);
+   run_size<4096>(ctx);
+}
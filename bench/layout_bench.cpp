@@ -0,0 +1,132 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// Effects of the layout policy: per-thread containers packed next to each
+// other in an array (false sharing) against cache-line padded ones, and
+// float reductions over natural against 32/64-byte aligned buffers.
+namespace
+{
+   template <typename Layout>
+   using per_thread_vector = ntl::bounded_vector<std::uint32_t, 4, std::allocator<std::uint32_t>,
+      ntl::overflow::throw_error, ntl::stats::disabled, Layout>;
+
+   constexpr std::size_t false_sharing_ops = 2000000;
+
+   // Every thread pushes and pops on its own vector; only the placement of
+   // the vectors in memory differs between layouts
+   template <typename Layout>
+   void run_false_sharing(bench::context& ctx, const char* layoutName, unsigned numThreads)
+   {
+      using vector_type = per_thread_vector<Layout>;
+
+      bench::result r{ "layout", "false_sharing_push_pop/" + std::to_string(numThreads) + "t", "uint32", layoutName, 4, 0.0, 0 };
+      if (!ctx.selected(r))
+      {
+         return;
+      }
+
+      std::unique_ptr<vector_type[]> vectors(new vector_type[numThreads]);
+      double best = 0.0;
+      for (unsigned rep = 0; rep < ctx.get_options().m_Repetitions; ++rep)
+      {
+         std::atomic<unsigned> ready(0);
+         std::atomic<bool> go(false);
+         std::vector<std::thread> threads;
+         for (unsigned t = 0; t < numThreads; ++t)
+         {
+            threads.emplace_back([&vectors, &ready, &go, t]()
+            {
+               vector_type& v = vectors[t];
+               ready.fetch_add(1);
+               while (!go.load(std::memory_order_acquire))
+               {
+               }
+
+               for (std::size_t i = 0; i < false_sharing_ops; ++i)
+               {
+                  v.push_back(static_cast<std::uint32_t>(i));
+                  bench::do_not_optimize(v);
+                  v.pop_back();
+               }
+            });
+         }
+
+         while (ready.load() != numThreads)
+         {
+         }
+
+         auto start = std::chrono::steady_clock::now();
+         go.store(true, std::memory_order_release);
+         for (std::thread& th : threads)
+         {
+            th.join();
+         }
+
+         double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / false_sharing_ops;
+         best = rep == 0 ? ns : (ns < best ? ns : best);
+      }
+
+      r.m_NsPerElem = best;
+      r.m_Iterations = static_cast<std::uint64_t>(false_sharing_ops) * numThreads * ctx.get_options().m_Repetitions;
+      ctx.add(r);
+   }
+
+   constexpr std::size_t sum_elems = 4096;
+
+   template <typename Layout>
+   using float_vector = ntl::bounded_vector<float, sum_elems, std::allocator<float>,
+      ntl::overflow::throw_error, ntl::stats::disabled, Layout>;
+
+   template <typename Layout>
+   void run_sum(bench::context& ctx, const char* layoutName)
+   {
+      using vector_type = float_vector<Layout>;
+
+      ctx.run_batched<vector_type>(bench::result{ "layout", "sum_float", "float", layoutName, sum_elems, 0.0, 0 }, 1, sum_elems,
+         [](vector_type& v)
+         {
+            if (v.empty())
+            {
+               for (std::size_t i = 0; i < sum_elems; ++i)
+               {
+                  v.push_back(static_cast<float>(i & 0xFF));
+               }
+            }
+         },
+         [](vector_type& v)
+         {
+            const float* data = v.data();
+            float sum[8] = {};
+            for (std::size_t i = 0; i < sum_elems; i += 8)
+            {
+               for (std::size_t lane = 0; lane < 8; ++lane)
+               {
+                  sum[lane] += data[i + lane];
+               }
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+}
+
+NTL_BENCH_SUITE(layout)
+{
+   run_sum<ntl::layout::natural>(ctx, "natural");
+   run_sum<ntl::layout::aligned<32>>(ctx, "aligned<32>");
+   run_sum<ntl::layout::aligned<64>>(ctx, "aligned<64>");
+
+   for (unsigned numThreads : { 1u, 2u, 4u, 8u })
+   {
+      run_false_sharing<ntl::layout::natural>(ctx, "natural", numThreads);
+      run_false_sharing<ntl::layout::cache_line_padded>(ctx, "cache_line_padded", numThreads);
+   }
+}
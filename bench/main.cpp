@@ -0,0 +1,171 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "bench.h"
+
+namespace bench
+{
+   std::vector<suite>& registry()
+   {
+      static std::vector<suite> s_Suites;
+      return s_Suites;
+   }
+
+   std::string context::name_of(const result& r)
+   {
+      return r.m_Suite + "/" + r.m_Op + "/" + r.m_Type + "/" + std::to_string(r.m_MaxElems) + "/" + r.m_Container;
+   }
+
+   bool context::selected(const result& r) const
+   {
+      return m_Options.m_Filter.empty() || name_of(r).find(m_Options.m_Filter) != std::string::npos;
+   }
+
+   void context::add(const result& r)
+   {
+      m_Results.push_back(r);
+      if (!m_Options.m_Json)
+      {
+         std::printf("%-60s %12.3f ns/elem\n", name_of(r).c_str(), r.m_NsPerElem);
+         std::fflush(stdout);
+      }
+   }
+}
+
+namespace
+{
+   void print_usage(const char* argv0)
+   {
+      std::printf(
+         "usage: %s [options]\n"
+         "  --json             write results as JSON to stdout\n"
+         "  --filter=TEXT      only run cases whose name contains TEXT\n"
+         "                     (names are suite/op/type/max_elems/container)\n"
+         "  --min-time-ms=MS   minimum measured time per repetition (default 10)\n"
+         "  --repetitions=N    repetitions per case, fastest is reported (default 3)\n"
+         "  --list             list the registered suites\n",
+         argv0);
+   }
+
+   std::string json_escape(const std::string& s)
+   {
+      std::string out;
+      for (char c : s)
+      {
+         if (c == '"' || c == '\\')
+         {
+            out += '\\';
+         }
+
+         out += c;
+      }
+
+      return out;
+   }
+
+   void write_json(const bench::context& ctx)
+   {
+#if defined(__clang__)
+      const char* compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+      const char* compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+      const char* compiler = "msvc";
+#else
+      const char* compiler = "unknown";
+#endif
+
+#if defined(NDEBUG)
+      const char* buildType = "release";
+#else
+      const char* buildType = "debug";
+#endif
+
+      std::printf("{\n");
+      std::printf("  \"context\": {\n");
+      std::printf("    \"compiler\": \"%s\",\n", json_escape(compiler).c_str());
+      std::printf("    \"build_type\": \"%s\",\n", buildType);
+      std::printf("    \"cplusplus\": %ld,\n", static_cast<long>(__cplusplus));
+      std::printf("    \"min_time_ms\": %g,\n", ctx.get_options().m_MinTimeMs);
+      std::printf("    \"repetitions\": %u\n", ctx.get_options().m_Repetitions);
+      std::printf("  },\n");
+      std::printf("  \"benchmarks\": [");
+      const auto& results = ctx.results();
+      for (std::size_t i = 0; i < results.size(); ++i)
+      {
+         const bench::result& r = results[i];
+         std::printf("%s\n    {\"name\": \"%s\", \"suite\": \"%s\", \"op\": \"%s\", \"type\": \"%s\", "
+            "\"max_elems\": %zu, \"container\": \"%s\", \"ns_per_elem\": %.4f, \"iterations\": %llu}",
+            i == 0 ? "" : ",",
+            json_escape(bench::context::name_of(r)).c_str(),
+            json_escape(r.m_Suite).c_str(),
+            json_escape(r.m_Op).c_str(),
+            json_escape(r.m_Type).c_str(),
+            r.m_MaxElems,
+            json_escape(r.m_Container).c_str(),
+            r.m_NsPerElem,
+            static_cast<unsigned long long>(r.m_Iterations));
+      }
+
+      std::printf("\n  ]\n}\n");
+   }
+}
+
+int main(int argc, char** argv)
+{
+   bench::options opts;
+   for (int i = 1; i < argc; ++i)
+   {
+      const char* arg = argv[i];
+      if (std::strcmp(arg, "--json") == 0)
+      {
+         opts.m_Json = true;
+      }
+      else if (std::strncmp(arg, "--filter=", 9) == 0)
+      {
+         opts.m_Filter = arg + 9;
+      }
+      else if (std::strncmp(arg, "--min-time-ms=", 14) == 0)
+      {
+         opts.m_MinTimeMs = std::atof(arg + 14);
+      }
+      else if (std::strncmp(arg, "--repetitions=", 14) == 0)
+      {
+         opts.m_Repetitions = static_cast<unsigned>(std::atoi(arg + 14));
+      }
+      else if (std::strcmp(arg, "--list") == 0)
+      {
+         for (const bench::suite& s : bench::registry())
+         {
+            std::printf("%s\n", s.m_Name);
+         }
+
+         return 0;
+      }
+      else
+      {
+         print_usage(argv[0]);
+         return std::strcmp(arg, "--help") == 0 ? 0 : 1;
+      }
+   }
+
+   if (opts.m_Repetitions == 0)
+   {
+      opts.m_Repetitions = 1;
+   }
+
+   bench::context ctx(opts);
+   for (const bench::suite& s : bench::registry())
+   {
+      s.m_Func(ctx);
+   }
+
+   if (opts.m_Json)
+   {
+      write_json(ctx);
+   }
+
+   return 0;
+}
@@ -0,0 +1,92 @@
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_vector.h"
+#include "mapped_bounded_vector.h"
+
+// Startup cost of a large table: rebuilding a bounded_vector from its
+// source data against attaching to a mapped_bounded_vector snapshot,
+// with and without checking the snapshot's checksum
+namespace
+{
+   struct record
+   {
+      std::uint32_t m_Id;
+      std::uint32_t m_Parent;
+      float m_Weight;
+      std::uint32_t m_Flags;
+   };
+
+   constexpr std::size_t table_elems = 65536;
+
+   using table_type = ntl::bounded_vector<record, table_elems>;
+   using mapped_table_type = ntl::mapped_bounded_vector<record, table_elems>;
+
+   const char* const snapshot_path = "/tmp/ntl_bench_mapped_table.bin";
+
+   record make_record(std::uint32_t i)
+   {
+      return record{ i, i / 2, static_cast<float>(i) * 0.25f, i * 2654435761u };
+   }
+}
+
+NTL_BENCH_SUITE(mapped)
+{
+   const std::string type = "record16";
+
+   // What a restart pays today
+   std::unique_ptr<table_type> table(new table_type);
+   ctx.run(bench::result{ "mapped", "rebuild_push_back", type, "ntl::bounded_vector", table_elems, 0.0, 0 }, table_elems,
+      [&table]()
+      {
+         table->clear();
+         for (std::uint32_t i = 0; i < table_elems; ++i)
+         {
+            table->push_back(make_record(i));
+         }
+
+         bench::do_not_optimize(*table);
+      });
+
+   bench::result attach{ "mapped", "attach", type, "ntl::mapped_bounded_vector", table_elems, 0.0, 0 };
+   bench::result attachVerify{ "mapped", "attach_verify", type, "ntl::mapped_bounded_vector", table_elems, 0.0, 0 };
+   if (!ctx.selected(attach) && !ctx.selected(attachVerify))
+   {
+      return;
+   }
+
+   {
+      std::vector<record> source;
+      for (std::uint32_t i = 0; i < table_elems; ++i)
+      {
+         source.push_back(make_record(i));
+      }
+
+      mapped_table_type snapshot(snapshot_path, ntl::map_mode::create);
+      snapshot.append_range(source);
+      snapshot.sync();
+   }
+
+   // Page faults for the elements are taken lazily on first touch, so
+   // attach reads only the header and the last element
+   ctx.run(attach, table_elems,
+      []()
+      {
+         mapped_table_type snapshot(snapshot_path, ntl::map_mode::open_existing);
+         bench::do_not_optimize(snapshot.back());
+      });
+
+   ctx.run(attachVerify, table_elems,
+      []()
+      {
+         mapped_table_type snapshot(snapshot_path, ntl::map_mode::open_existing);
+         bool ok = snapshot.verify();
+         bench::do_not_optimize(ok);
+      });
+
+   std::remove(snapshot_path);
+}
@@ -0,0 +1,125 @@
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_vector.h"
+#include "mpmc_bounded_queue.h"
+
+// Threads passing work items through one shared queue, from 1 to 16
+// threads: mpmc_bounded_queue against a bounded_vector behind a std::mutex.
+// Every thread pushes an item and then pops one, so each thread is both a
+// producer and a consumer and the queue never runs dry. Reported per
+// push/pop pair; every case moves the same total.
+namespace
+{
+   constexpr std::size_t queue_capacity = 1024;
+   constexpr std::size_t total_items = 1 << 20;
+
+   using queue_type = ntl::mpmc_bounded_queue<std::uint64_t, queue_capacity>;
+
+   struct locked_vector
+   {
+      std::mutex m_Lock;
+      ntl::bounded_vector<std::uint64_t, queue_capacity> m_Elems;
+   };
+
+   // Runs work(thread, count) on numThreads threads released together
+   template <typename Work>
+   void run_threads(bench::context& ctx, bench::result r, unsigned numThreads, Work work)
+   {
+      if (!ctx.selected(r))
+      {
+         return;
+      }
+
+      std::size_t perThread = total_items / numThreads;
+      double best = 0.0;
+      for (unsigned rep = 0; rep < ctx.get_options().m_Repetitions; ++rep)
+      {
+         std::atomic<unsigned> ready(0);
+         std::atomic<bool> go(false);
+         std::vector<std::thread> threads;
+         for (unsigned t = 0; t < numThreads; ++t)
+         {
+            threads.emplace_back([&ready, &go, &work, t, perThread]()
+            {
+               ready.fetch_add(1);
+               while (!go.load(std::memory_order_acquire))
+               {
+               }
+
+               work(t, perThread);
+            });
+         }
+
+         while (ready.load() != numThreads)
+         {
+         }
+
+         auto start = std::chrono::steady_clock::now();
+         go.store(true, std::memory_order_release);
+         for (std::thread& th : threads)
+         {
+            th.join();
+         }
+
+         double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (perThread * numThreads);
+         best = rep == 0 ? ns : (ns < best ? ns : best);
+      }
+
+      r.m_NsPerElem = best;
+      r.m_Iterations = static_cast<std::uint64_t>(perThread) * numThreads * ctx.get_options().m_Repetitions;
+      ctx.add(r);
+   }
+}
+
+NTL_BENCH_SUITE(mpmc)
+{
+   std::unique_ptr<queue_type> queue(new queue_type);
+   std::unique_ptr<locked_vector> locked(new locked_vector);
+
+   for (unsigned numThreads : { 1u, 2u, 4u, 8u, 16u })
+   {
+      const std::string op = "push_pop/" + std::to_string(numThreads) + "t";
+
+      run_threads(ctx, bench::result{ "mpmc", op, "uint64", "ntl::mpmc_bounded_queue", queue_capacity, 0.0, 0 }, numThreads,
+         [&queue](unsigned t, std::size_t count)
+         {
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               std::uint64_t item = 0;
+               queue->push(std::uint64_t(t) << 32 | i);
+               queue->pop(item);
+               sum += item;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      run_threads(ctx, bench::result{ "mpmc", op, "uint64", "std::mutex+ntl::bounded_vector", queue_capacity, 0.0, 0 }, numThreads,
+         [&locked](unsigned t, std::size_t count)
+         {
+            std::uint64_t sum = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               {
+                  std::lock_guard<std::mutex> guard(locked->m_Lock);
+                  locked->m_Elems.push_back(std::uint64_t(t) << 32 | i);
+               }
+
+               std::lock_guard<std::mutex> guard(locked->m_Lock);
+               sum += locked->m_Elems.back();
+               locked->m_Elems.pop_back();
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+}
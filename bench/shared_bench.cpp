@@ -0,0 +1,192 @@
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <string>
+
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench.h"
+#include "bounded_vector.h"
+#include "shared_bounded_vector.h"
+
+// Several processes appending to one log in shared memory:
+// shared_bounded_vector against a bounded_vector behind a process-shared
+// pthread mutex. Producers are fork()ed children released together
+// through a pipe; the time runs from the release until the last exits.
+namespace
+{
+   struct log_record
+   {
+      std::uint32_t m_Producer;
+      std::uint32_t m_Seq;
+      std::uint64_t m_Payload;
+   };
+
+   constexpr std::size_t log_elems = 1 << 20;
+
+   using shared_log_type = ntl::shared_bounded_vector<log_record, log_elems>;
+
+   const char* const shared_log_name = "/ntl_bench_shared_log";
+
+   struct locked_log
+   {
+      pthread_mutex_t m_Lock;
+      ntl::bounded_vector<log_record, log_elems> m_Elems;
+   };
+
+   // Forks numProcs children that each run produce(index) after the
+   // release; returns the wall time in ns, or a negative value if a child failed
+   template <typename Produce>
+   double run_producers(unsigned numProcs, Produce produce)
+   {
+      int go[2];
+      if (::pipe(go) != 0)
+      {
+         return -1.0;
+      }
+
+      for (unsigned p = 0; p < numProcs; ++p)
+      {
+         if (::fork() == 0)
+         {
+            ::close(go[1]);
+            char c;
+            bool released = ::read(go[0], &c, 1) == 0;
+            ::_exit(released && produce(p) ? 0 : 1);
+         }
+      }
+
+      ::close(go[0]);
+      auto start = std::chrono::steady_clock::now();
+      ::close(go[1]);
+
+      bool ok = true;
+      for (unsigned p = 0; p < numProcs; ++p)
+      {
+         int status = 0;
+         ::wait(&status);
+         ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+      }
+
+      double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+      return ok ? ns : -1.0;
+   }
+
+   template <typename Reset, typename Produce>
+   void run_case(bench::context& ctx, bench::result r, unsigned numProcs, Reset reset, Produce produce)
+   {
+      if (!ctx.selected(r))
+      {
+         return;
+      }
+
+      double best = 0.0;
+      for (unsigned rep = 0; rep < ctx.get_options().m_Repetitions; ++rep)
+      {
+         reset();
+         double ns = run_producers(numProcs, produce) / log_elems;
+         if (ns < 0.0)
+         {
+            return;
+         }
+
+         best = rep == 0 ? ns : (ns < best ? ns : best);
+      }
+
+      r.m_NsPerElem = best;
+      r.m_Iterations = static_cast<std::uint64_t>(log_elems) * ctx.get_options().m_Repetitions;
+      ctx.add(r);
+   }
+
+   void run_shared(bench::context& ctx, shared_log_type& shared, unsigned numProcs)
+   {
+      bench::result r{ "shared", "append/" + std::to_string(numProcs) + "p", "record16", "ntl::shared_bounded_vector", log_elems, 0.0, 0 };
+      run_case(ctx, r, numProcs,
+         [&shared]()
+         {
+            shared.clear();
+         },
+         [numProcs](unsigned p)
+         {
+            // Children attach by name, as unrelated processes would
+            shared_log_type log(shared_log_name, ntl::map_mode::open_existing);
+            std::size_t perProc = log_elems / numProcs;
+            for (std::uint32_t i = 0; i < perProc; ++i)
+            {
+               if (!log.try_push_back(log_record{ p, i, std::uint64_t(p) << 32 | i }))
+               {
+                  return false;
+               }
+            }
+
+            return log.published_prefix(0) > 0;
+         });
+   }
+
+   void run_locked(bench::context& ctx, locked_log& shared, unsigned numProcs)
+   {
+      bench::result r{ "shared", "append/" + std::to_string(numProcs) + "p", "record16", "pthread_mutex+ntl::bounded_vector", log_elems, 0.0, 0 };
+      run_case(ctx, r, numProcs,
+         [&shared]()
+         {
+            shared.m_Elems.clear();
+         },
+         [&shared, numProcs](unsigned p)
+         {
+            std::size_t perProc = log_elems / numProcs;
+            for (std::uint32_t i = 0; i < perProc; ++i)
+            {
+               ::pthread_mutex_lock(&shared.m_Lock);
+               bool pushed = shared.m_Elems.try_push_back(log_record{ p, i, std::uint64_t(p) << 32 | i }) != nullptr;
+               ::pthread_mutex_unlock(&shared.m_Lock);
+               if (!pushed)
+               {
+                  return false;
+               }
+            }
+
+            return true;
+         });
+   }
+}
+
+NTL_BENCH_SUITE(shared)
+{
+   // Inherited by the children; bounded_vector holds no pointers, so it
+   // works unchanged in a shared mapping
+   void* map = ::mmap(nullptr, sizeof(locked_log), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+   if (map == MAP_FAILED)
+   {
+      return;
+   }
+
+   locked_log* locked = ::new (map) locked_log;
+   pthread_mutexattr_t attr;
+   ::pthread_mutexattr_init(&attr);
+   ::pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+   ::pthread_mutex_init(&locked->m_Lock, &attr);
+   ::pthread_mutexattr_destroy(&attr);
+
+   // Both logs are filled once up front so that no case pays for first
+   // touching its pages
+   shared_log_type log(shared_log_name, ntl::map_mode::create);
+   for (std::uint32_t i = 0; i < log_elems; ++i)
+   {
+      log.push_back(log_record{ 0, i, i });
+      locked->m_Elems.push_back(log_record{ 0, i, i });
+   }
+
+   for (unsigned numProcs : { 1u, 2u, 4u, 8u })
+   {
+      run_shared(ctx, log, numProcs);
+      run_locked(ctx, *locked, numProcs);
+   }
+
+   ::pthread_mutex_destroy(&locked->m_Lock);
+   locked->~locked_log();
+   ::munmap(map, sizeof(locked_log));
+   shared_log_type::unlink(shared_log_name);
+}
@@ -0,0 +1,110 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// Middle insert and front erase on a half-full bounded_vector, against the
+// adjacent-swap chain insert/erase used before the memmove shift path. The
+// swap chain is reproduced here so the comparison stays runnable.
+namespace
+{
+   constexpr std::size_t shift_elems = 4096;
+
+   using vector_type = ntl::bounded_vector<std::uint32_t, shift_elems>;
+
+   void swap_chain_insert(vector_type& v, std::size_t idx, std::uint32_t value)
+   {
+      v.push_back(value);
+      for (std::size_t i = v.size() - 1; i > idx; --i)
+      {
+         std::iter_swap(v.begin() + i, v.begin() + i - 1);
+      }
+   }
+
+   void swap_chain_erase(vector_type& v, std::size_t idx)
+   {
+      for (std::size_t i = idx + 1; i < v.size(); ++i)
+      {
+         std::iter_swap(v.begin() + i - 1, v.begin() + i);
+      }
+
+      v.pop_back();
+   }
+
+   void fill_half(vector_type& v)
+   {
+      v.clear();
+      for (std::uint32_t i = 0; i < shift_elems / 2; ++i)
+      {
+         v.push_back(i);
+      }
+   }
+
+   void fill_full(vector_type& v)
+   {
+      v.clear();
+      for (std::uint32_t i = 0; i < shift_elems; ++i)
+      {
+         v.push_back(i);
+      }
+   }
+
+   bench::result make_result(const char* op, const char* method)
+   {
+      return bench::result{ "shift", op, "uint32", method, shift_elems, 0.0, 0 };
+   }
+}
+
+NTL_BENCH_SUITE(shift)
+{
+   // Half full, then filled by inserting in the middle
+   ctx.run_batched<vector_type>(make_result("insert_middle", "ntl::bounded_vector"), 1, shift_elems / 2,
+      fill_half,
+      [](vector_type& v)
+      {
+         while (v.size() < shift_elems)
+         {
+            v.insert(v.begin() + v.size() / 2, static_cast<std::uint32_t>(v.size()));
+         }
+
+         bench::do_not_optimize(v);
+      });
+
+   ctx.run_batched<vector_type>(make_result("insert_middle", "swap_chain"), 1, shift_elems / 2,
+      fill_half,
+      [](vector_type& v)
+      {
+         while (v.size() < shift_elems)
+         {
+            swap_chain_insert(v, v.size() / 2, static_cast<std::uint32_t>(v.size()));
+         }
+
+         bench::do_not_optimize(v);
+      });
+
+   // Full, then emptied from the front
+   ctx.run_batched<vector_type>(make_result("erase_front", "ntl::bounded_vector"), 1, shift_elems,
+      fill_full,
+      [](vector_type& v)
+      {
+         while (!v.empty())
+         {
+            v.erase(v.begin());
+         }
+
+         bench::do_not_optimize(v);
+      });
+
+   ctx.run_batched<vector_type>(make_result("erase_front", "swap_chain"), 1, shift_elems,
+      fill_full,
+      [](vector_type& v)
+      {
+         while (!v.empty())
+         {
+            swap_chain_erase(v, 0);
+         }
+
+         bench::do_not_optimize(v);
+      });
+}
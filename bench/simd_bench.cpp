@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// The vectorized ==, count and find members of bounded_vector against a
+// scalar element loop, std::count and std::find over the same elements.
+// libstdc++ and libc++ turn std::equal on integers into memcmp, so it is
+// listed as well.
+// Both vectors hold equal elements and the needle is absent, so every
+// case scans the whole range.
+namespace
+{
+   // Each timed call repeats the scan until it has covered about 4K
+   // elements, so short ranges are not dominated by the clock reads
+   constexpr std::size_t repeat_count(std::size_t n)
+   {
+      return n >= 4096 ? 1 : 4096 / n;
+   }
+
+   template <std::size_t N>
+   void run_size(bench::context& ctx)
+   {
+      using vector_type = ntl::bounded_vector<std::uint16_t, N>;
+
+      std::unique_ptr<vector_type> lhs(new vector_type());
+      std::unique_ptr<vector_type> rhs(new vector_type());
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         lhs->push_back(static_cast<std::uint16_t>(i * 7));
+         rhs->push_back(static_cast<std::uint16_t>(i * 7));
+      }
+
+      const vector_type& a = *lhs;
+      const vector_type& b = *rhs;
+      const std::uint16_t needle = 1;
+      constexpr std::size_t repeats = repeat_count(N);
+
+      ctx.run(bench::result{ "simd", "equal", "uint16", "ntl::bounded_vector", N, 0.0, 0 }, N * repeats,
+         [&a, &b]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               bool equal = a == b;
+               bench::do_not_optimize(equal);
+            }
+         });
+
+      ctx.run(bench::result{ "simd", "equal", "uint16", "element_loop", N, 0.0, 0 }, N * repeats,
+         [&a, &b]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               bool equal = a.size() == b.size();
+               for (std::size_t i = 0; equal && i < a.size(); ++i)
+               {
+                  equal = a[i] == b[i];
+               }
+
+               bench::do_not_optimize(equal);
+            }
+         });
+
+      ctx.run(bench::result{ "simd", "equal", "uint16", "std::equal", N, 0.0, 0 }, N * repeats,
+         [&a, &b]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               bool equal = a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin());
+               bench::do_not_optimize(equal);
+            }
+         });
+
+      ctx.run(bench::result{ "simd", "count", "uint16", "ntl::bounded_vector", N, 0.0, 0 }, N * repeats,
+         [&a, needle]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               std::size_t count = a.count(needle);
+               bench::do_not_optimize(count);
+            }
+         });
+
+      ctx.run(bench::result{ "simd", "count", "uint16", "std::count", N, 0.0, 0 }, N * repeats,
+         [&a, needle]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               std::ptrdiff_t count = std::count(a.begin(), a.end(), needle);
+               bench::do_not_optimize(count);
+            }
+         });
+
+      ctx.run(bench::result{ "simd", "find_miss", "uint16", "ntl::bounded_vector", N, 0.0, 0 }, N * repeats,
+         [&a, needle]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               auto it = a.find(needle);
+               bench::do_not_optimize(it);
+            }
+         });
+
+      ctx.run(bench::result{ "simd", "find_miss", "uint16", "std::find", N, 0.0, 0 }, N * repeats,
+         [&a, needle]()
+         {
+            for (std::size_t r = 0; r < repeats; ++r)
+            {
+               auto it = std::find(a.begin(), a.end(), needle);
+               bench::do_not_optimize(it);
+            }
+         });
+   }
+}
+
+NTL_BENCH_SUITE(simd)
+{
+   run_size<16>(ctx);
+   run_size<256>(ctx);
+   run_size<4096>(ctx);
+}
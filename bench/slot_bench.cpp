@@ -0,0 +1,219 @@
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_slot_map.h"
+#include "bounded_vector.h"
+
+// An entity pool half full of 64-byte entities: bounded_slot_map against
+// the hand-rolled alternative it replaces, a bounded_vector searched by id
+// with a shifting erase, and std::unordered_map keyed by id. Churn erases
+// a random live entity and inserts a new one.
+namespace
+{
+   constexpr std::size_t max_entities = 4096;
+   constexpr std::size_t live_entities = max_entities / 2;
+   constexpr std::size_t pick_count = 1024;
+
+   struct entity
+   {
+      std::uint32_t m_Id;
+      float m_Position[3];
+      float m_Velocity[3];
+      char m_Padding[64 - 28];
+   };
+
+   static_assert(sizeof(entity) == 64, "entity must be 64 bytes");
+
+   entity make_entity(std::uint32_t id)
+   {
+      return entity{ id, {}, {}, {} };
+   }
+
+   bench::result make_result(const char* op, const char* container)
+   {
+      return bench::result{ "slot", op, "entity64", container, max_entities, 0.0, 0 };
+   }
+
+   void run_slot_map(bench::context& ctx, const std::vector<std::size_t>& picks)
+   {
+      using pool_type = ntl::bounded_slot_map<entity, max_entities>;
+
+      std::unique_ptr<pool_type> pool(new pool_type());
+      std::vector<pool_type::handle> handles;
+      for (std::uint32_t i = 0; i < live_entities; ++i)
+      {
+         handles.push_back(pool->insert(make_entity(i)));
+      }
+
+      pool_type& m = *pool;
+      std::uint32_t nextId = live_entities;
+      ctx.run(make_result("erase_insert", "ntl::bounded_slot_map"), picks.size(),
+         [&m, &handles, &picks, &nextId]()
+         {
+            for (std::size_t pick : picks)
+            {
+               pool_type::handle& h = handles[pick];
+               m.erase(h);
+               h = m.insert(make_entity(nextId++));
+            }
+
+            bench::do_not_optimize(m);
+         });
+
+      ctx.run(make_result("lookup", "ntl::bounded_slot_map"), picks.size(),
+         [&m, &handles, &picks]()
+         {
+            std::uint32_t sum = 0;
+            for (std::size_t pick : picks)
+            {
+               sum += m[handles[pick]].m_Id;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      ctx.run(make_result("iterate", "ntl::bounded_slot_map"), m.size(),
+         [&m]()
+         {
+            std::uint32_t sum = 0;
+            for (const entity& e : m)
+            {
+               sum += e.m_Id;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+
+   void run_vector_search(bench::context& ctx, const std::vector<std::size_t>& picks)
+   {
+      using pool_type = ntl::bounded_vector<entity, max_entities>;
+
+      std::unique_ptr<pool_type> pool(new pool_type());
+      std::vector<std::uint32_t> ids;
+      for (std::uint32_t i = 0; i < live_entities; ++i)
+      {
+         pool->push_back(make_entity(i));
+         ids.push_back(i);
+      }
+
+      pool_type& v = *pool;
+      auto find = [&v](std::uint32_t id)
+      {
+         pool_type::iterator it = v.begin();
+         while (it != v.end() && it->m_Id != id)
+         {
+            ++it;
+         }
+
+         return it;
+      };
+
+      std::uint32_t nextId = live_entities;
+      ctx.run(make_result("erase_insert", "ntl::bounded_vector+search"), picks.size(),
+         [&v, &ids, &picks, &nextId, &find]()
+         {
+            for (std::size_t pick : picks)
+            {
+               v.erase(find(ids[pick]));
+               ids[pick] = nextId++;
+               v.push_back(make_entity(ids[pick]));
+            }
+
+            bench::do_not_optimize(v);
+         });
+
+      ctx.run(make_result("lookup", "ntl::bounded_vector+search"), picks.size(),
+         [&ids, &picks, &find]()
+         {
+            std::uint32_t sum = 0;
+            for (std::size_t pick : picks)
+            {
+               sum += find(ids[pick])->m_Id;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      ctx.run(make_result("iterate", "ntl::bounded_vector+search"), v.size(),
+         [&v]()
+         {
+            std::uint32_t sum = 0;
+            for (const entity& e : v)
+            {
+               sum += e.m_Id;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+
+   void run_unordered_map(bench::context& ctx, const std::vector<std::size_t>& picks)
+   {
+      std::unordered_map<std::uint32_t, entity> m;
+      std::vector<std::uint32_t> ids;
+      for (std::uint32_t i = 0; i < live_entities; ++i)
+      {
+         m.emplace(i, make_entity(i));
+         ids.push_back(i);
+      }
+
+      std::uint32_t nextId = live_entities;
+      ctx.run(make_result("erase_insert", "std::unordered_map"), picks.size(),
+         [&m, &ids, &picks, &nextId]()
+         {
+            for (std::size_t pick : picks)
+            {
+               m.erase(ids[pick]);
+               ids[pick] = nextId++;
+               m.emplace(ids[pick], make_entity(ids[pick]));
+            }
+
+            bench::do_not_optimize(m);
+         });
+
+      ctx.run(make_result("lookup", "std::unordered_map"), picks.size(),
+         [&m, &ids, &picks]()
+         {
+            std::uint32_t sum = 0;
+            for (std::size_t pick : picks)
+            {
+               sum += m.find(ids[pick])->second.m_Id;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      ctx.run(make_result("iterate", "std::unordered_map"), m.size(),
+         [&m]()
+         {
+            std::uint32_t sum = 0;
+            for (const auto& e : m)
+            {
+               sum += e.second.m_Id;
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+}
+
+NTL_BENCH_SUITE(slot)
+{
+   // Positions in each pool's list of live handles or ids
+   std::mt19937 rng(5);
+   std::vector<std::size_t> picks;
+   for (std::size_t i = 0; i < pick_count; ++i)
+   {
+      picks.push_back(rng() % live_entities);
+   }
+
+   run_slot_map(ctx, picks);
+   run_vector_search(ctx, picks);
+   run_unordered_map(ctx, picks);
+}
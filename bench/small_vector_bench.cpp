@@ -0,0 +1,46 @@
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "small_vector.h"
+
+// Building a short-lived vector from scratch, the case small_vector is
+// for: up to N elements never touch the allocator, past N it spills to the
+// heap once and grows from there. Every build starts from a fresh
+// container.
+namespace
+{
+   constexpr std::size_t inline_elems = 8;
+
+   // Builds per timed call, so short builds are not dominated by the clock reads
+   constexpr std::size_t builds = 256;
+
+   template <typename Vector>
+   void run_vector(bench::context& ctx, const char* name, std::size_t count)
+   {
+      ctx.run(bench::result{ "small_vector", "build/" + std::to_string(count), "int", name, inline_elems, 0.0, 0 }, builds * count,
+         [count]()
+         {
+            for (std::size_t b = 0; b < builds; ++b)
+            {
+               Vector v;
+               for (std::size_t i = 0; i < count; ++i)
+               {
+                  v.push_back(static_cast<int>(i + b));
+               }
+
+               bench::do_not_optimize(v[count - 1]);
+            }
+         });
+   }
+}
+
+NTL_BENCH_SUITE(small_vector)
+{
+   for (std::size_t count : { std::size_t(4), inline_elems, std::size_t(32) })
+   {
+      run_vector<ntl::small_vector<int, inline_elems>>(ctx, "ntl::small_vector", count);
+      run_vector<std::vector<int>>(ctx, "std::vector", count);
+   }
+}
@@ -0,0 +1,67 @@
+#include <cstddef>
+#include <memory>
+
+#include "bench.h"
+#include "bounded_soa_vector.h"
+#include "bounded_vector.h"
+
+// A pass that updates 2 of 8 float fields per particle: over an array of
+// structs every 32-byte particle is loaded to touch 8 bytes of it, over
+// bounded_soa_vector only the two columns involved are streamed.
+namespace
+{
+   struct particle
+   {
+      float m_X, m_Y, m_Z;
+      float m_VelX, m_VelY, m_VelZ;
+      float m_Mass, m_Charge;
+   };
+
+   template <std::size_t N>
+   void run_size(bench::context& ctx)
+   {
+      using aos_type = ntl::bounded_vector<particle, N>;
+      using soa_type = ntl::bounded_soa_vector<N, float, float, float, float, float, float, float, float>;
+
+      std::unique_ptr<aos_type> aosStorage(new aos_type());
+      std::unique_ptr<soa_type> soaStorage(new soa_type());
+      aos_type& aos = *aosStorage;
+      soa_type& soa = *soaStorage;
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         aos.push_back(particle{ static_cast<float>(i), 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f });
+         soa.emplace_back(static_cast<float>(i), 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
+      }
+
+      ctx.run(bench::result{ "soa", "update_2_of_8", "float", "ntl::bounded_vector<struct>", N, 0.0, 0 }, N,
+         [&aos]()
+         {
+            for (particle& p : aos)
+            {
+               p.m_X += p.m_VelX * 0.5f;
+            }
+
+            bench::do_not_optimize(aos);
+         });
+
+      ctx.run(bench::result{ "soa", "update_2_of_8", "float", "ntl::bounded_soa_vector", N, 0.0, 0 }, N,
+         [&soa]()
+         {
+            float* x = soa.template data<0>();
+            const float* velX = soa.template data<3>();
+            for (std::size_t i = 0, n = soa.size(); i < n; ++i)
+            {
+               x[i] += velX[i] * 0.5f;
+            }
+
+            bench::do_not_optimize(soa);
+         });
+   }
+}
+
+NTL_BENCH_SUITE(soa)
+{
+   run_size<4096>(ctx);
+   run_size<65536>(ctx);
+   run_size<std::size_t(1) << 20>(ctx);
+}
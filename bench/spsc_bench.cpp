@@ -0,0 +1,284 @@
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "bench.h"
+#include "bounded_vector.h"
+#include "spsc_ring.h"
+
+// One producer thread handing items to one consumer thread: spsc_ring
+// against a bounded_vector behind a std::mutex, which the consumer drains
+// in one go. Throughput cases stream stream_items items and report ns per
+// item; latency cases bounce one item back and forth through a pair of
+// queues and report ns per round trip. A blocked side yields.
+namespace
+{
+   constexpr std::size_t ring_capacity = 1024;
+   constexpr std::size_t batch_size = 64;
+   constexpr std::uint64_t stream_items = 1 << 21;
+   constexpr std::uint64_t round_trips = 1 << 15;
+
+   using ring_type = ntl::spsc_ring<std::uint64_t, ring_capacity>;
+
+   struct locked_vector
+   {
+      std::mutex m_Lock;
+      ntl::bounded_vector<std::uint64_t, ring_capacity> m_Elems;
+   };
+
+   // Runs producer() on a second thread and consumer() on this one; the
+   // fastest repetition is reported per unit of work
+   template <typename Producer, typename Consumer>
+   void run_pair(bench::context& ctx, bench::result r, std::uint64_t units, Producer producer, Consumer consumer)
+   {
+      if (!ctx.selected(r))
+      {
+         return;
+      }
+
+      double best = 0.0;
+      for (unsigned rep = 0; rep < ctx.get_options().m_Repetitions; ++rep)
+      {
+         auto start = std::chrono::steady_clock::now();
+         std::thread other(producer);
+         consumer();
+         other.join();
+
+         double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / units;
+         best = rep == 0 ? ns : (ns < best ? ns : best);
+      }
+
+      r.m_NsPerElem = best;
+      r.m_Iterations = units * ctx.get_options().m_Repetitions;
+      ctx.add(r);
+   }
+
+   void run_throughput(bench::context& ctx)
+   {
+      std::unique_ptr<ring_type> ring(new ring_type);
+      std::unique_ptr<locked_vector> locked(new locked_vector);
+
+      run_pair(ctx, bench::result{ "spsc", "stream/try_push_pop", "uint64", "ntl::spsc_ring", ring_capacity, 0.0, 0 }, stream_items,
+         [&ring]()
+         {
+            for (std::uint64_t i = 0; i < stream_items;)
+            {
+               if (ring->try_push(i))
+               {
+                  ++i;
+               }
+               else
+               {
+                  std::this_thread::yield();
+               }
+            }
+         },
+         [&ring]()
+         {
+            std::uint64_t sum = 0;
+            for (std::uint64_t got = 0; got < stream_items;)
+            {
+               std::uint64_t item;
+               if (ring->try_pop(item))
+               {
+                  sum += item;
+                  ++got;
+               }
+               else
+               {
+                  std::this_thread::yield();
+               }
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      run_pair(ctx, bench::result{ "spsc", "stream/push_pop_n_64", "uint64", "ntl::spsc_ring", ring_capacity, 0.0, 0 }, stream_items,
+         [&ring]()
+         {
+            std::uint64_t batch[batch_size];
+            for (std::uint64_t i = 0; i < stream_items; i += batch_size)
+            {
+               for (std::size_t k = 0; k < batch_size; ++k)
+               {
+                  batch[k] = i + k;
+               }
+
+               for (std::size_t done = 0; done < batch_size;)
+               {
+                  std::size_t pushed = ring->push_n(batch + done, batch_size - done);
+                  done += pushed;
+                  if (pushed == 0)
+                  {
+                     std::this_thread::yield();
+                  }
+               }
+            }
+         },
+         [&ring]()
+         {
+            std::uint64_t batch[batch_size];
+            std::uint64_t sum = 0;
+            for (std::uint64_t got = 0; got < stream_items;)
+            {
+               std::size_t popped = ring->pop_n(batch, batch_size);
+               for (std::size_t k = 0; k < popped; ++k)
+               {
+                  sum += batch[k];
+               }
+
+               got += popped;
+               if (popped == 0)
+               {
+                  std::this_thread::yield();
+               }
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      run_pair(ctx, bench::result{ "spsc", "stream/lock_drain", "uint64", "std::mutex+ntl::bounded_vector", ring_capacity, 0.0, 0 }, stream_items,
+         [&locked]()
+         {
+            for (std::uint64_t i = 0; i < stream_items;)
+            {
+               bool full;
+               {
+                  std::lock_guard<std::mutex> guard(locked->m_Lock);
+                  while (i < stream_items && locked->m_Elems.size() < locked->m_Elems.capacity())
+                  {
+                     locked->m_Elems.push_back(i++);
+                  }
+
+                  full = locked->m_Elems.size() == locked->m_Elems.capacity();
+               }
+
+               if (full)
+               {
+                  std::this_thread::yield();
+               }
+            }
+         },
+         [&locked]()
+         {
+            std::uint64_t sum = 0;
+            for (std::uint64_t got = 0; got < stream_items;)
+            {
+               std::size_t drained;
+               {
+                  std::lock_guard<std::mutex> guard(locked->m_Lock);
+                  for (std::uint64_t item : locked->m_Elems)
+                  {
+                     sum += item;
+                  }
+
+                  drained = locked->m_Elems.size();
+                  locked->m_Elems.clear();
+               }
+
+               got += drained;
+               if (drained == 0)
+               {
+                  std::this_thread::yield();
+               }
+            }
+
+            bench::do_not_optimize(sum);
+         });
+   }
+
+   void run_latency(bench::context& ctx)
+   {
+      using small_ring = ntl::spsc_ring<std::uint64_t, 64>;
+
+      std::unique_ptr<small_ring> ping(new small_ring);
+      std::unique_ptr<small_ring> pong(new small_ring);
+      run_pair(ctx, bench::result{ "spsc", "round_trip", "uint64", "ntl::spsc_ring", 64, 0.0, 0 }, round_trips,
+         [&ping, &pong]()
+         {
+            for (std::uint64_t i = 0; i < round_trips; ++i)
+            {
+               std::uint64_t item;
+               while (!ping->try_pop(item))
+               {
+                  std::this_thread::yield();
+               }
+
+               while (!pong->try_push(item))
+               {
+                  std::this_thread::yield();
+               }
+            }
+         },
+         [&ping, &pong]()
+         {
+            for (std::uint64_t i = 0; i < round_trips; ++i)
+            {
+               std::uint64_t item;
+               while (!ping->try_push(i))
+               {
+                  std::this_thread::yield();
+               }
+
+               while (!pong->try_pop(item))
+               {
+                  std::this_thread::yield();
+               }
+            }
+         });
+
+      std::unique_ptr<locked_vector> there(new locked_vector);
+      std::unique_ptr<locked_vector> back(new locked_vector);
+      auto take = [](locked_vector& from, std::uint64_t& item)
+      {
+         for (;;)
+         {
+            {
+               std::lock_guard<std::mutex> guard(from.m_Lock);
+               if (!from.m_Elems.empty())
+               {
+                  item = from.m_Elems.back();
+                  from.m_Elems.pop_back();
+                  return;
+               }
+            }
+
+            std::this_thread::yield();
+         }
+      };
+
+      auto give = [](locked_vector& to, std::uint64_t item)
+      {
+         std::lock_guard<std::mutex> guard(to.m_Lock);
+         to.m_Elems.push_back(item);
+      };
+
+      run_pair(ctx, bench::result{ "spsc", "round_trip", "uint64", "std::mutex+ntl::bounded_vector", ring_capacity, 0.0, 0 }, round_trips,
+         [&there, &back, &take, &give]()
+         {
+            for (std::uint64_t i = 0; i < round_trips; ++i)
+            {
+               std::uint64_t item;
+               take(*there, item);
+               give(*back, item);
+            }
+         },
+         [&there, &back, &take, &give]()
+         {
+            for (std::uint64_t i = 0; i < round_trips; ++i)
+            {
+               std::uint64_t item;
+               give(*there, i);
+               take(*back, item);
+            }
+         });
+   }
+}
+
+NTL_BENCH_SUITE(spsc)
+{
+   run_throughput(ctx);
+   run_latency(ctx);
+}
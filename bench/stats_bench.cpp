@@ -0,0 +1,59 @@
+#include <cstddef>
+
+#include "bench.h"
+#include "bounded_vector.h"
+#include "container_stats.h"
+
+// Cost of stats::tracked on the hot paths it instruments, against the
+// default stats::disabled
+namespace
+{
+   constexpr std::size_t max_elems = 1024;
+
+   template <typename StatsPolicy>
+   using vector_type = ntl::bounded_vector<int, max_elems, std::allocator<int>, ntl::overflow::throw_error, StatsPolicy>;
+
+   template <typename StatsPolicy>
+   void run_policy(bench::context& ctx, const char* name)
+   {
+      using container = vector_type<StatsPolicy>;
+
+      ctx.run_batched<container>(bench::result{ "stats", "push_back", "int", name, max_elems, 0.0, 0 }, 4, max_elems,
+         [](container& c) { c.clear(); },
+         [](container& c)
+         {
+            for (std::size_t i = 0; i < max_elems; ++i)
+            {
+               c.push_back(static_cast<int>(i));
+            }
+
+            bench::do_not_optimize(c);
+         });
+
+      ctx.run_batched<container>(bench::result{ "stats", "insert_erase_middle", "int", name, max_elems, 0.0, 0 }, 4, 64,
+         [](container& c)
+         {
+            c.clear();
+            for (std::size_t i = 0; i < max_elems / 2; ++i)
+            {
+               c.push_back(static_cast<int>(i));
+            }
+         },
+         [](container& c)
+         {
+            for (int i = 0; i < 64; ++i)
+            {
+               c.insert(c.begin() + c.size() / 2, i);
+               c.erase(c.begin() + c.size() / 3);
+            }
+
+            bench::do_not_optimize(c);
+         });
+   }
+}
+
+NTL_BENCH_SUITE(stats)
+{
+   run_policy<ntl::stats::disabled>(ctx, "disabled");
+   run_policy<ntl::stats::tracked>(ctx, "tracked");
+}
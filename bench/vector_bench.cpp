@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "bench.h"
+#include "bounded_vector.h"
+
+// bounded_vector against std::vector with reserve() and std::array, for
+// the operations an embedded caller leans on. std::array only takes part
+// in the operations a fixed-size array supports.
+namespace
+{
+   struct pod64
+   {
+      pod64() = default;
+
+      explicit pod64(std::uint32_t seed)
+      {
+         for (std::uint32_t& w : m_Words)
+         {
+            w = seed++;
+         }
+      }
+
+      bool operator == (const pod64& rhs) const noexcept
+      {
+         return std::memcmp(m_Words, rhs.m_Words, sizeof(m_Words)) == 0;
+      }
+
+      bool operator < (const pod64& rhs) const noexcept
+      {
+         return std::lexicographical_compare(std::begin(m_Words), std::end(m_Words), std::begin(rhs.m_Words), std::end(rhs.m_Words));
+      }
+
+      std::uint32_t m_Words[16];
+   };
+
+   static_assert(sizeof(pod64) == 64, "pod64 must be 64 bytes");
+
+   template <typename T>
+   struct element;
+
+   template <>
+   struct element<int>
+   {
+      static const char* name()
+      {
+         return "int";
+      }
+
+      static int make(std::size_t i)
+      {
+         return static_cast<int>(i * 2654435761u);
+      }
+
+      template <typename Container>
+      static void emplace(Container& c, std::size_t i)
+      {
+         c.emplace_back(static_cast<int>(i));
+      }
+
+      static std::size_t touch(int v)
+      {
+         return static_cast<std::size_t>(v);
+      }
+   };
+
+   template <>
+   struct element<pod64>
+   {
+      static const char* name()
+      {
+         return "pod64";
+      }
+
+      static pod64 make(std::size_t i)
+      {
+         return pod64(static_cast<std::uint32_t>(i));
+      }
+
+      template <typename Container>
+      static void emplace(Container& c, std::size_t i)
+      {
+         c.emplace_back(static_cast<std::uint32_t>(i));
+      }
+
+      static std::size_t touch(const pod64& v)
+      {
+         return v.m_Words[0];
+      }
+   };
+
+   // Long enough to defeat the small string optimization, so copies allocate
+   template <>
+   struct element<std::string>
+   {
+      static const char* name()
+      {
+         return "string";
+      }
+
+      static std::string make(std::size_t i)
+      {
+         return std::string(32, static_cast<char>('a' + i % 26)) + std::to_string(i);
+      }
+
+      template <typename Container>
+      static void emplace(Container& c, std::size_t i)
+      {
+         c.emplace_back(32, static_cast<char>('a' + i % 26));
+      }
+
+      static std::size_t touch(const std::string& v)
+      {
+         return v.size();
+      }
+   };
+
+   template <typename T, std::size_t N>
+   struct ntl_bounded
+   {
+      using type = ntl::bounded_vector<T, N>;
+      static constexpr bool s_Growable = true;
+
+      static const char* name()
+      {
+         return "ntl::bounded_vector";
+      }
+
+      static void prepare(type&)
+      {
+      }
+   };
+
+   template <typename T, std::size_t N>
+   struct std_vector
+   {
+      using type = std::vector<T>;
+      static constexpr bool s_Growable = true;
+
+      static const char* name()
+      {
+         return "std::vector";
+      }
+
+      // Moving from a vector takes its buffer, so reserve again every time
+      static void prepare(type& c)
+      {
+         c.reserve(N);
+      }
+   };
+
+   template <typename T, std::size_t N>
+   struct std_array
+   {
+      using type = std::array<T, N>;
+      static constexpr bool s_Growable = false;
+
+      static const char* name()
+      {
+         return "std::array";
+      }
+   };
+
+   template <typename Desc, typename T, std::size_t N>
+   void fill(typename Desc::type& c, const std::vector<T>& values, std::size_t count, std::true_type)
+   {
+      c.clear();
+      Desc::prepare(c);
+      for (std::size_t i = 0; i < count; ++i)
+      {
+         c.push_back(values[i]);
+      }
+   }
+
+   template <typename Desc, typename T, std::size_t N>
+   void fill(typename Desc::type& c, const std::vector<T>& values, std::size_t, std::false_type)
+   {
+      std::copy(values.begin(), values.begin() + N, c.begin());
+   }
+
+   template <typename Desc, typename T, std::size_t N>
+   void fill(typename Desc::type& c, const std::vector<T>& values, std::size_t count = N)
+   {
+      fill<Desc, T, N>(c, values, count, std::integral_constant<bool, Desc::s_Growable>());
+   }
+
+   template <typename Desc, typename T, std::size_t N>
+   bench::result make_result(const char* op)
+   {
+      return bench::result{ "vector", op, element<T>::name(), Desc::name(), N, 0.0, 0 };
+   }
+
+   // Roughly 4K elements per batch, so small containers are not dominated
+   // by the clock reads
+   constexpr std::size_t batch_size(std::size_t n)
+   {
+      return n >= 4096 ? 1 : 4096 / n;
+   }
+
+   enum class position
+   {
+      front,
+      middle,
+      back
+   };
+
+   template <typename Container>
+   typename Container::iterator at_position(Container& c, position pos)
+   {
+      switch (pos)
+      {
+      case position::front:
+         return c.begin();
+      case position::middle:
+         return c.begin() + c.size() / 2;
+      default:
+         return c.end();
+      }
+   }
+
+   const char* insert_name(position pos)
+   {
+      return pos == position::front ? "insert_front" : pos == position::middle ? "insert_middle" : "insert_back";
+   }
+
+   const char* erase_name(position pos)
+   {
+      return pos == position::front ? "erase_front" : pos == position::middle ? "erase_middle" : "erase_back";
+   }
+
+   template <typename Desc, typename T, std::size_t N>
+   void run_growable(bench::context&, const std::vector<T>&, std::false_type)
+   {
+   }
+
+   template <typename Desc, typename T, std::size_t N>
+   void run_growable(bench::context& ctx, const std::vector<T>& values, std::true_type)
+   {
+      using container = typename Desc::type;
+      constexpr std::size_t batch = batch_size(N);
+
+      ctx.run_batched<container>(make_result<Desc, T, N>("push_back"), batch, N,
+         [](container& c) { c.clear(); Desc::prepare(c); },
+         [&values](container& c)
+         {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+               c.push_back(values[i]);
+            }
+
+            bench::do_not_optimize(c);
+         });
+
+      ctx.run_batched<container>(make_result<Desc, T, N>("emplace_back"), batch, N,
+         [](container& c) { c.clear(); Desc::prepare(c); },
+         [](container& c)
+         {
+            for (std::size_t i = 0; i < N; ++i)
+            {
+               element<T>::emplace(c, i);
+            }
+
+            bench::do_not_optimize(c);
+         });
+
+      for (position pos : { position::front, position::middle, position::back })
+      {
+         ctx.run_batched<container>(make_result<Desc, T, N>(insert_name(pos)), batch, N - N / 2,
+            [&values](container& c) { fill<Desc, T, N>(c, values, N / 2); },
+            [&values, pos](container& c)
+            {
+               for (std::size_t i = N / 2; i < N; ++i)
+               {
+                  c.insert(at_position(c, pos), values[i]);
+               }
+
+               bench::do_not_optimize(c);
+            });
+
+         ctx.run_batched<container>(make_result<Desc, T, N>(erase_name(pos)), batch, N,
+            [&values](container& c) { fill<Desc, T, N>(c, values); },
+            [pos](container& c)
+            {
+               while (!c.empty())
+               {
+                  c.erase(pos == position::back ? c.end() - 1 : at_position(c, pos));
+               }
+
+               bench::do_not_optimize(c);
+            });
+      }
+
+      ctx.run_batched<container>(make_result<Desc, T, N>("clear"), batch, N,
+         [&values](container& c) { fill<Desc, T, N>(c, values); },
+         [](container& c)
+         {
+            c.clear();
+            bench::do_not_optimize(c);
+         });
+   }
+
+   template <typename Desc, typename T, std::size_t N>
+   void run_container(bench::context& ctx, const std::vector<T>& values)
+   {
+      using container = typename Desc::type;
+      constexpr std::size_t batch = batch_size(N);
+
+      run_growable<Desc, T, N>(ctx, values, std::integral_constant<bool, Desc::s_Growable>());
+
+      ctx.run_batched<container>(make_result<Desc, T, N>("copy"), batch, N,
+         [&values](container& c) { fill<Desc, T, N>(c, values); },
+         [](container& c)
+         {
+            container copy(c);
+            bench::do_not_optimize(copy);
+         });
+
+      ctx.run_batched<container>(make_result<Desc, T, N>("move"), batch, N,
+         [&values](container& c) { fill<Desc, T, N>(c, values); },
+         [](container& c)
+         {
+            container moved(std::move(c));
+            bench::do_not_optimize(moved);
+         });
+
+      ctx.run_batched<container>(make_result<Desc, T, N>("iterate"), batch, N,
+         [&values](container& c) { fill<Desc, T, N>(c, values); },
+         [](container& c)
+         {
+            std::size_t sum = 0;
+            for (const T& v : c)
+            {
+               sum += element<T>::touch(v);
+            }
+
+            bench::do_not_optimize(sum);
+         });
+
+      // Equal contents, so every element is compared
+      container reference;
+      fill<Desc, T, N>(reference, values);
+      ctx.run_batched<container>(make_result<Desc, T, N>("compare"), batch, N,
+         [&values](container& c) { fill<Desc, T, N>(c, values); },
+         [&reference](container& c)
+         {
+            bool equal = c == reference;
+            bench::do_not_optimize(equal);
+         });
+   }
+
+   template <typename T, std::size_t N>
+   void run_size(bench::context& ctx)
+   {
+      std::vector<T> values;
+      values.reserve(N);
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         values.push_back(element<T>::make(i));
+      }
+
+      run_container<ntl_bounded<T, N>, T, N>(ctx, values);
+      run_container<std_vector<T, N>, T, N>(ctx, values);
+      run_container<std_array<T, N>, T, N>(ctx, values);
+   }
+
+   template <typename T>
+   void run_type(bench::context& ctx)
+   {
+      run_size<T, 8>(ctx);
+      run_size<T, 64>(ctx);
+      run_size<T, 512>(ctx);
+      run_size<T, 4096>(ctx);
+   }
+
+   // clear() on its own at a size where a destructor loop would show: for
+   // trivially destructible elements it only resets the size. The batch
+   // holds one container, so it lives on the heap.
+   template <typename Desc, typename T, std::size_t N>
+   void run_large_clear(bench::context& ctx, const std::vector<T>& values)
+   {
+      using container = typename Desc::type;
+      ctx.run_batched<container>(make_result<Desc, T, N>("clear"), 1, N,
+         [&values](container& c) { fill<Desc, T, N>(c, values); },
+         [](container& c)
+         {
+            c.clear();
+            bench::do_not_optimize(c);
+         });
+   }
+
+   template <typename T>
+   void run_large_clear(bench::context& ctx)
+   {
+      constexpr std::size_t N = 65536;
+      std::vector<T> values;
+      values.reserve(N);
+      for (std::size_t i = 0; i < N; ++i)
+      {
+         values.push_back(element<T>::make(i));
+      }
+
+      run_large_clear<ntl_bounded<T, N>, T, N>(ctx, values);
+      run_large_clear<std_vector<T, N>, T, N>(ctx, values);
+   }
+}
+
+NTL_BENCH_SUITE(vector)
+{
+   run_type<int>(ctx);
+   run_type<pod64>(ctx);
+   run_type<std::string>(ctx);
+   run_large_clear<int>(ctx);
+   run_large_clear<std::string>(ctx);
+}
@@ -0,0 +1,590 @@
+#pragma once
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_flat_set.h"
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      // Random access iterator over the parallel key and value arrays of a
+      // bounded_flat_map. Dereferencing yields a pair of references, so
+      // range-for with structured bindings works as with std::map.
+      template <typename Key, typename Mapped>
+      class flat_map_iterator
+      {
+      public:
+         using iterator_category = std::random_access_iterator_tag;
+         using value_type = std::pair<Key, std::remove_const_t<Mapped>>;
+         using difference_type = std::ptrdiff_t;
+         using reference = std::pair<const Key&, Mapped&>;
+         using pointer = arrow_proxy<reference>;
+
+         flat_map_iterator() noexcept :
+            m_Key(nullptr),
+            m_Value(nullptr)
+         {
+         }
+
+         flat_map_iterator(const Key* key, Mapped* value) noexcept :
+            m_Key(key),
+            m_Value(value)
+         {
+         }
+
+         // iterator converts to const_iterator
+         template <typename Other, typename = std::enable_if_t<std::is_same<const Other, Mapped>::value>>
+         flat_map_iterator(const flat_map_iterator<Key, Other>& rhs) noexcept :
+            m_Key(rhs.key_ptr()),
+            m_Value(rhs.value_ptr())
+         {
+         }
+
+         reference operator * () const noexcept
+         {
+            return reference(*m_Key, *m_Value);
+         }
+
+         pointer operator -> () const noexcept
+         {
+            return pointer(**this);
+         }
+
+         reference operator [](difference_type n) const noexcept
+         {
+            return reference(m_Key[n], m_Value[n]);
+         }
+
+         const Key& key() const noexcept
+         {
+            return *m_Key;
+         }
+
+         Mapped& value() const noexcept
+         {
+            return *m_Value;
+         }
+
+         const Key* key_ptr() const noexcept
+         {
+            return m_Key;
+         }
+
+         Mapped* value_ptr() const noexcept
+         {
+            return m_Value;
+         }
+
+         flat_map_iterator& operator ++ () noexcept
+         {
+            ++m_Key;
+            ++m_Value;
+            return *this;
+         }
+
+         flat_map_iterator operator ++ (int) noexcept
+         {
+            flat_map_iterator tmp(*this);
+            ++*this;
+            return tmp;
+         }
+
+         flat_map_iterator& operator -- () noexcept
+         {
+            --m_Key;
+            --m_Value;
+            return *this;
+         }
+
+         flat_map_iterator operator -- (int) noexcept
+         {
+            flat_map_iterator tmp(*this);
+            --*this;
+            return tmp;
+         }
+
+         flat_map_iterator& operator += (difference_type n) noexcept
+         {
+            m_Key += n;
+            m_Value += n;
+            return *this;
+         }
+
+         flat_map_iterator& operator -= (difference_type n) noexcept
+         {
+            return *this += -n;
+         }
+
+         friend flat_map_iterator operator + (flat_map_iterator it, difference_type n) noexcept
+         {
+            return it += n;
+         }
+
+         friend flat_map_iterator operator + (difference_type n, flat_map_iterator it) noexcept
+         {
+            return it += n;
+         }
+
+         friend flat_map_iterator operator - (flat_map_iterator it, difference_type n) noexcept
+         {
+            return it -= n;
+         }
+
+         friend difference_type operator - (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return lhs.m_Key - rhs.m_Key;
+         }
+
+         friend bool operator == (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return lhs.m_Key == rhs.m_Key;
+         }
+
+         friend bool operator != (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return lhs.m_Key != rhs.m_Key;
+         }
+
+         friend bool operator < (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return lhs.m_Key < rhs.m_Key;
+         }
+
+         friend bool operator > (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return rhs < lhs;
+         }
+
+         friend bool operator <= (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return !(rhs < lhs);
+         }
+
+         friend bool operator >= (const flat_map_iterator& lhs, const flat_map_iterator& rhs) noexcept
+         {
+            return !(lhs < rhs);
+         }
+
+      private:
+         const Key* m_Key;
+         Mapped* m_Value;
+      };
+   }
+
+   // Sorted map of at most MaxElems unique keys. Keys and mapped values live
+   // in separate inline arrays, so a lookup only walks key cache lines and
+   // touches a single value at the end. Lookups are O(log N); inserts and
+   // erases are O(N) element shifts. Build from unsorted input with the range
+   // constructor or insert(first, last), which sort once instead of shifting
+   // per element.
+   template <typename Key, typename T, std::size_t MaxElems, typename Compare = std::less<Key>,
+      typename SearchPolicy = flat_search::binary>
+   class bounded_flat_map
+   {
+      using store_type = detail::flat_key_store<Key, MaxElems, Compare, SearchPolicy>;
+
+   public:
+      using key_type = Key;
+      using mapped_type = T;
+      using value_type = std::pair<Key, T>;
+      using key_compare = Compare;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using iterator = detail::flat_map_iterator<Key, T>;
+      using const_iterator = detail::flat_map_iterator<Key, const T>;
+      using reverse_iterator = std::reverse_iterator<iterator>;
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+      using reference = typename iterator::reference;
+      using const_reference = typename const_iterator::reference;
+      using key_container_type = bounded_vector<Key, MaxElems>;
+      using mapped_container_type = bounded_vector<T, MaxElems>;
+
+      bounded_flat_map() = default;
+
+      explicit bounded_flat_map(const Compare& comp) :
+         m_Store(comp)
+      {
+      }
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      bounded_flat_map(InputIt first, InputIt last, const Compare& comp = Compare()) :
+         m_Store(comp)
+      {
+         insert(first, last);
+      }
+
+      bounded_flat_map(std::initializer_list<value_type> init, const Compare& comp = Compare()) :
+         m_Store(comp)
+      {
+         insert(init.begin(), init.end());
+      }
+
+      iterator begin() noexcept
+      {
+         return iterator_at(0);
+      }
+
+      const_iterator begin() const noexcept
+      {
+         return iterator_at(0);
+      }
+
+      const_iterator cbegin() const noexcept
+      {
+         return begin();
+      }
+
+      iterator end() noexcept
+      {
+         return iterator_at(size());
+      }
+
+      const_iterator end() const noexcept
+      {
+         return iterator_at(size());
+      }
+
+      const_iterator cend() const noexcept
+      {
+         return end();
+      }
+
+      reverse_iterator rbegin() noexcept
+      {
+         return reverse_iterator(end());
+      }
+
+      const_reverse_iterator rbegin() const noexcept
+      {
+         return const_reverse_iterator(end());
+      }
+
+      const_reverse_iterator crbegin() const noexcept
+      {
+         return rbegin();
+      }
+
+      reverse_iterator rend() noexcept
+      {
+         return reverse_iterator(begin());
+      }
+
+      const_reverse_iterator rend() const noexcept
+      {
+         return const_reverse_iterator(begin());
+      }
+
+      const_reverse_iterator crend() const noexcept
+      {
+         return rend();
+      }
+
+      // The sorted keys and their mapped values, index for index
+      const key_container_type& keys() const noexcept
+      {
+         return m_Store.keys();
+      }
+
+      const mapped_container_type& values() const noexcept
+      {
+         return m_Values;
+      }
+
+      size_type size() const noexcept
+      {
+         return m_Store.size();
+      }
+
+      bool empty() const noexcept
+      {
+         return size() == 0;
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type max_size() const noexcept
+      {
+         return MaxElems;
+      }
+
+      key_compare key_comp() const
+      {
+         return m_Store.key_comp();
+      }
+
+      T& at(const Key& key)
+      {
+         return m_Values[checked_find(key)];
+      }
+
+      const T& at(const Key& key) const
+      {
+         return m_Values[checked_find(key)];
+      }
+
+      T& operator [](const Key& key)
+      {
+         return try_emplace(key).first.value();
+      }
+
+      T& operator [](Key&& key)
+      {
+         return try_emplace(std::move(key)).first.value();
+      }
+
+      void clear() noexcept
+      {
+         m_Store.clear();
+         m_Values.clear();
+      }
+
+      std::pair<iterator, bool> insert(const value_type& value)
+      {
+         return try_emplace(value.first, value.second);
+      }
+
+      std::pair<iterator, bool> insert(value_type&& value)
+      {
+         return try_emplace(std::move(value.first), std::move(value.second));
+      }
+
+      template <typename ... Args>
+      std::pair<iterator, bool> emplace(Args&&... args)
+      {
+         value_type value(std::forward<Args>(args)...);
+         return try_emplace(std::move(value.first), std::move(value.second));
+      }
+
+      // Constructs the mapped value from args only if key is absent
+      template <typename ... Args>
+      std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+      {
+         return emplace_unique(key, std::forward<Args>(args)...);
+      }
+
+      template <typename ... Args>
+      std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+      {
+         return emplace_unique(std::move(key), std::forward<Args>(args)...);
+      }
+
+      template <typename M>
+      std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj)
+      {
+         std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(obj));
+         if (!result.second)
+         {
+            result.first.value() = std::forward<M>(obj);
+         }
+
+         return result;
+      }
+
+      // Bulk insert: appends the range, then sorts and deduplicates once.
+      // Keys already in the map win over equal keys in the range, and within
+      // the range the first occurrence wins.
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      void insert(InputIt first, InputIt last)
+      {
+         // Whether nothing has been appended since the last sort
+         bool sorted = true;
+         for (; first != last; ++first)
+         {
+            const auto& elem = *first;
+            if (size() == MaxElems)
+            {
+               // Duplicates may still free up room, and a key that is
+               // already present needs none. The map stays sorted if the
+               // key does not fit.
+               if (!sorted)
+               {
+                  sort_unique();
+                  sorted = true;
+               }
+
+               if (contains(elem.first))
+               {
+                  continue;
+               }
+
+               m_Store.check_room("No space available to insert");
+            }
+
+            m_Store.append_unsorted(elem.first);
+            m_Values.push_back(elem.second);
+            sorted = false;
+         }
+
+         if (!sorted)
+         {
+            sort_unique();
+         }
+      }
+
+      void insert(std::initializer_list<value_type> init)
+      {
+         insert(init.begin(), init.end());
+      }
+
+      iterator erase(const_iterator pos)
+      {
+         return erase(pos, pos + 1);
+      }
+
+      iterator erase(const_iterator first, const_iterator last)
+      {
+         size_type idx = first - cbegin();
+         size_type lastIdx = last - cbegin();
+         m_Values.erase(m_Values.cbegin() + idx, m_Values.cbegin() + lastIdx);
+         m_Store.erase_at(idx, lastIdx);
+         return iterator_at(idx);
+      }
+
+      size_type erase(const Key& key)
+      {
+         size_type idx = m_Store.find(key);
+         if (idx == size())
+         {
+            return 0;
+         }
+
+         erase(cbegin() + idx);
+         return 1;
+      }
+
+      iterator find(const Key& key)
+      {
+         return iterator_at(m_Store.find(key));
+      }
+
+      const_iterator find(const Key& key) const
+      {
+         return iterator_at(m_Store.find(key));
+      }
+
+      size_type count(const Key& key) const
+      {
+         return contains(key) ? 1 : 0;
+      }
+
+      bool contains(const Key& key) const
+      {
+         return m_Store.find(key) != size();
+      }
+
+      iterator lower_bound(const Key& key)
+      {
+         return iterator_at(m_Store.lower_bound(key));
+      }
+
+      const_iterator lower_bound(const Key& key) const
+      {
+         return iterator_at(m_Store.lower_bound(key));
+      }
+
+      iterator upper_bound(const Key& key)
+      {
+         return iterator_at(m_Store.upper_bound(key));
+      }
+
+      const_iterator upper_bound(const Key& key) const
+      {
+         return iterator_at(m_Store.upper_bound(key));
+      }
+
+      std::pair<iterator, iterator> equal_range(const Key& key)
+      {
+         return std::make_pair(lower_bound(key), upper_bound(key));
+      }
+
+      std::pair<const_iterator, const_iterator> equal_range(const Key& key) const
+      {
+         return std::make_pair(lower_bound(key), upper_bound(key));
+      }
+
+      bool operator == (const bounded_flat_map& rhs) const
+      {
+         return keys() == rhs.keys() && m_Values == rhs.m_Values;
+      }
+
+      bool operator != (const bounded_flat_map& rhs) const
+      {
+         return !(*this == rhs);
+      }
+
+   private:
+      iterator iterator_at(size_type idx) noexcept
+      {
+         return iterator(m_Store.keys().data() + idx, m_Values.data() + idx);
+      }
+
+      const_iterator iterator_at(size_type idx) const noexcept
+      {
+         return const_iterator(m_Store.keys().data() + idx, m_Values.data() + idx);
+      }
+
+      size_type checked_find(const Key& key) const
+      {
+         size_type idx = m_Store.find(key);
+         if (idx == size())
+         {
+            detail::throw_or_abort<std::out_of_range>("bounded_flat_map::at key not found");
+         }
+
+         return idx;
+      }
+
+      template <typename K, typename ... Args>
+      std::pair<iterator, bool> emplace_unique(K&& key, Args&&... args)
+      {
+         size_type idx = m_Store.lower_bound(key);
+         if (m_Store.matches(idx, key))
+         {
+            return std::make_pair(iterator_at(idx), false);
+         }
+
+         m_Store.check_room("No space available to insert");
+         m_Values.emplace(m_Values.cbegin() + idx, std::forward<Args>(args)...);
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            m_Store.insert_at(idx, std::forward<K>(key));
+         }
+         catch (...)
+         {
+            m_Values.erase(m_Values.cbegin() + idx);
+            throw;
+         }
+#else
+         m_Store.insert_at(idx, std::forward<K>(key));
+#endif
+
+         return std::make_pair(iterator_at(idx), true);
+      }
+
+      void sort_unique()
+      {
+         size_type kept = m_Store.sort_unique([this](size_type a, size_type b)
+         {
+            using std::swap;
+            swap(m_Values[a], m_Values[b]);
+         });
+
+         m_Values.erase(m_Values.cbegin() + kept, m_Values.cend());
+      }
+
+      store_type m_Store;
+      mapped_container_type m_Values;
+   };
+}
@@ -0,0 +1,593 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_vector.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NTL_PREFETCH(addr) __builtin_prefetch(addr)
+#else
+#define NTL_PREFETCH(addr) ((void)(addr))
+#endif
+
+namespace ntl
+{
+   // Key search strategy for the bounded flat containers
+   namespace flat_search
+   {
+      // Branchless binary search over the sorted keys. No extra storage and
+      // no extra work on insert or erase.
+      struct binary
+      {
+      };
+
+      // Read-mostly mode: also keeps a copy of the keys in Eytzinger (BFS)
+      // order, so a lookup walks down an implicit tree whose next levels can
+      // be prefetched. Every insert or erase rebuilds the copy in O(N). Only
+      // worth it once the keys no longer fit in L2; below that binary is as
+      // fast.
+      struct eytzinger
+      {
+      };
+   }
+
+   namespace detail
+   {
+      // lower_bound over [first, first + count) whose loop compiles to a
+      // conditional move instead of an unpredictable branch
+      template <typename Key, typename Compare>
+      std::size_t branchless_lower_bound(const Key* first, std::size_t count, const Key& key, const Compare& comp)
+      {
+         if (count == 0)
+         {
+            return 0;
+         }
+
+         const Key* base = first;
+         while (count > 1)
+         {
+            std::size_t half = count / 2;
+            base = comp(base[half], key) ? base + half : base;
+            count -= half;
+         }
+
+         return (base - first) + (comp(*base, key) ? 1 : 0);
+      }
+
+      template <typename Key, std::size_t MaxElems, typename Compare, typename SearchPolicy>
+      class flat_search_index;
+
+      template <typename Key, std::size_t MaxElems, typename Compare>
+      class flat_search_index<Key, MaxElems, Compare, flat_search::binary>
+      {
+      public:
+         void rebuild(const Key*, std::size_t) noexcept
+         {
+         }
+
+         std::size_t lower_bound(const Key* keys, std::size_t count, const Key& key, const Compare& comp) const
+         {
+            return branchless_lower_bound(keys, count, key, comp);
+         }
+      };
+
+      template <typename Key, std::size_t MaxElems, typename Compare>
+      class flat_search_index<Key, MaxElems, Compare, flat_search::eytzinger>
+      {
+      public:
+         // Node k of the implicit tree (children 2k and 2k + 1) is m_Tree[k];
+         // m_Tree[0] is padding so that the 1-based arithmetic needs no
+         // adjustment and the nodes four levels down stay contiguous.
+         void rebuild(const Key* keys, std::size_t count)
+         {
+            m_Tree.clear();
+            for (std::size_t i = 0; i <= count && count > 0; ++i)
+            {
+               m_Tree.unchecked_push_back(node{ keys[0], 0 });
+            }
+
+            std::size_t next = 0;
+            fill(keys, 1, next);
+         }
+
+         std::size_t lower_bound(const Key*, std::size_t count, const Key& key, const Compare& comp) const
+         {
+            const node* tree = m_Tree.data();
+            std::size_t k = 1;
+            while (k <= count)
+            {
+               NTL_PREFETCH(tree + s_PrefetchNodes * k);
+               k = 2 * k + (comp(tree[k].m_Key, key) ? 1 : 0);
+            }
+
+            // Undo the trailing right turns plus the last left turn; the node
+            // reached is the first key not less than key, or none at all.
+            k >>= simd::count_trailing_zeros(static_cast<unsigned>(~k)) + 1;
+            return k == 0 ? count : tree[k].m_Slot;
+         }
+
+      private:
+         // The sorted position travels with the key so that the hit costs no
+         // extra cache miss
+         struct node
+         {
+            Key m_Key;
+            smallest_size_t<MaxElems> m_Slot;
+         };
+
+         // Descendants this many levels down share one cache line
+         static constexpr std::size_t s_PrefetchNodes = sizeof(node) <= cache_line_size / 16 ? 16
+            : sizeof(node) <= cache_line_size / 8 ? 8
+            : sizeof(node) <= cache_line_size / 4 ? 4 : 2;
+
+         // In-order walk of the implicit tree hands out the sorted keys
+         void fill(const Key* keys, std::size_t k, std::size_t& next)
+         {
+            if (k < m_Tree.size())
+            {
+               fill(keys, 2 * k, next);
+               m_Tree[k].m_Key = keys[next];
+               m_Tree[k].m_Slot = static_cast<smallest_size_t<MaxElems>>(next);
+               ++next;
+               fill(keys, 2 * k + 1, next);
+            }
+         }
+
+         bounded_vector<node, MaxElems + 1> m_Tree;
+      };
+
+      // Sorted unique keys in one contiguous array plus the search index.
+      // The map and set share this; the map keeps its mapped values in a
+      // parallel array so that searches only touch key cache lines.
+      template <typename Key, std::size_t MaxElems, typename Compare, typename SearchPolicy>
+      class flat_key_store
+      {
+      public:
+         explicit flat_key_store(const Compare& comp = Compare()) :
+            m_Comp(comp)
+         {
+         }
+
+         const Compare& key_comp() const noexcept
+         {
+            return m_Comp;
+         }
+
+         const bounded_vector<Key, MaxElems>& keys() const noexcept
+         {
+            return m_Keys;
+         }
+
+         std::size_t size() const noexcept
+         {
+            return m_Keys.size();
+         }
+
+         std::size_t lower_bound(const Key& key) const
+         {
+            return m_Index.lower_bound(m_Keys.data(), m_Keys.size(), key, m_Comp);
+         }
+
+         std::size_t upper_bound(const Key& key) const
+         {
+            std::size_t idx = lower_bound(key);
+            return matches(idx, key) ? idx + 1 : idx;
+         }
+
+         // Position of key, or size() when absent
+         std::size_t find(const Key& key) const
+         {
+            std::size_t idx = lower_bound(key);
+            return matches(idx, key) ? idx : size();
+         }
+
+         bool matches(std::size_t idx, const Key& key) const
+         {
+            return idx < m_Keys.size() && !m_Comp(key, m_Keys[idx]);
+         }
+
+         void check_room(const char* msg) const
+         {
+            if (m_Keys.size() == MaxElems)
+            {
+               throw_or_abort<std::runtime_error>(msg);
+            }
+         }
+
+         template <typename K>
+         void insert_at(std::size_t idx, K&& key)
+         {
+            m_Keys.insert(m_Keys.cbegin() + idx, std::forward<K>(key));
+            m_Index.rebuild(m_Keys.data(), m_Keys.size());
+         }
+
+         void erase_at(std::size_t first, std::size_t last)
+         {
+            m_Keys.erase(m_Keys.cbegin() + first, m_Keys.cbegin() + last);
+            m_Index.rebuild(m_Keys.data(), m_Keys.size());
+         }
+
+         void clear() noexcept
+         {
+            m_Keys.clear();
+            m_Index.rebuild(m_Keys.data(), 0);
+         }
+
+         template <typename K>
+         void append_unsorted(K&& key)
+         {
+            m_Keys.push_back(std::forward<K>(key));
+         }
+
+         // Sorts keys [0, size()) once and drops duplicates, keeping the
+         // earliest of each, and returns how many keys remain. Works in
+         // place: std::sort orders the key positions, with the position
+         // breaking ties, and a cycle walk then swaps every key to its
+         // place. swapValues(a, b) runs alongside each key swap so that a
+         // parallel array follows.
+         template <typename SwapValues>
+         std::size_t sort_unique(SwapValues swapValues)
+         {
+            using slot_type = smallest_size_t<MaxElems>;
+
+            std::size_t count = m_Keys.size();
+            bounded_vector<slot_type, MaxElems> order;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               order.unchecked_push_back(static_cast<slot_type>(i));
+            }
+
+            auto before = [this](slot_type a, slot_type b)
+            {
+               return m_Comp(m_Keys[a], m_Keys[b]) || (!m_Comp(m_Keys[b], m_Keys[a]) && a < b);
+            };
+
+            // std::sort finishes with an insertion sort over runs this short
+            // anyway; going straight to it also keeps GCC from flagging that
+            // pass as running past a small order array
+            if (MaxElems <= s_InsertionSortElems)
+            {
+               for (std::size_t i = 1; i < count; ++i)
+               {
+                  slot_type slot = order[i];
+                  std::size_t j = i;
+                  for (; j > 0 && before(slot, order[j - 1]); --j)
+                  {
+                     order[j] = order[j - 1];
+                  }
+
+                  order[j] = slot;
+               }
+            }
+            else
+            {
+               std::sort(order.begin(), order.end(), before);
+            }
+
+            // The first of each run of equal keys moves to the front. The
+            // dropped positions are swapped behind the kept ones rather than
+            // overwritten, so order stays a permutation.
+            std::size_t kept = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               if (kept == 0 || m_Comp(m_Keys[order[kept - 1]], m_Keys[order[i]]))
+               {
+                  std::swap(order[kept], order[i]);
+                  ++kept;
+               }
+            }
+
+            // Position j takes the key at order[j]; finished positions are
+            // marked by pointing at themselves
+            for (std::size_t i = 0; i < count; ++i)
+            {
+               std::size_t j = i;
+               while (order[j] != i)
+               {
+                  std::size_t next = order[j];
+                  using std::swap;
+                  swap(m_Keys[j], m_Keys[next]);
+                  swapValues(j, next);
+                  order[j] = static_cast<slot_type>(j);
+                  j = next;
+               }
+
+               order[j] = static_cast<slot_type>(j);
+            }
+
+            m_Keys.erase(m_Keys.cbegin() + kept, m_Keys.cend());
+            m_Index.rebuild(m_Keys.data(), m_Keys.size());
+            return kept;
+         }
+
+      private:
+         static constexpr std::size_t s_InsertionSortElems = 16;
+
+         bounded_vector<Key, MaxElems> m_Keys;
+         flat_search_index<Key, MaxElems, Compare, SearchPolicy> m_Index;
+         Compare m_Comp;
+      };
+   }
+
+   // Sorted set of at most MaxElems unique keys held in one contiguous inline
+   // array. Lookups are O(log N) with no pointer chasing; inserts and erases
+   // are O(N) element shifts. Build from unsorted input with the range
+   // constructor or insert(first, last), which sort once instead of
+   // shifting per element.
+   template <typename Key, std::size_t MaxElems, typename Compare = std::less<Key>,
+      typename SearchPolicy = flat_search::binary>
+   class bounded_flat_set
+   {
+      using store_type = detail::flat_key_store<Key, MaxElems, Compare, SearchPolicy>;
+
+   public:
+      using key_type = Key;
+      using value_type = Key;
+      using key_compare = Compare;
+      using value_compare = Compare;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = const value_type&;
+      using const_reference = const value_type&;
+      using pointer = const value_type*;
+      using const_pointer = const value_type*;
+
+      // Elements are immutable in place, since changing one could break the order
+      using iterator = const_pointer;
+      using const_iterator = const_pointer;
+      using reverse_iterator = std::reverse_iterator<iterator>;
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+      bounded_flat_set() = default;
+
+      explicit bounded_flat_set(const Compare& comp) :
+         m_Store(comp)
+      {
+      }
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      bounded_flat_set(InputIt first, InputIt last, const Compare& comp = Compare()) :
+         m_Store(comp)
+      {
+         insert(first, last);
+      }
+
+      bounded_flat_set(std::initializer_list<Key> init, const Compare& comp = Compare()) :
+         m_Store(comp)
+      {
+         insert(init.begin(), init.end());
+      }
+
+      iterator begin() const noexcept
+      {
+         return m_Store.keys().begin();
+      }
+
+      iterator cbegin() const noexcept
+      {
+         return begin();
+      }
+
+      iterator end() const noexcept
+      {
+         return m_Store.keys().end();
+      }
+
+      iterator cend() const noexcept
+      {
+         return end();
+      }
+
+      reverse_iterator rbegin() const noexcept
+      {
+         return reverse_iterator(end());
+      }
+
+      reverse_iterator crbegin() const noexcept
+      {
+         return rbegin();
+      }
+
+      reverse_iterator rend() const noexcept
+      {
+         return reverse_iterator(begin());
+      }
+
+      reverse_iterator crend() const noexcept
+      {
+         return rend();
+      }
+
+      const_pointer data() const noexcept
+      {
+         return m_Store.keys().data();
+      }
+
+      size_type size() const noexcept
+      {
+         return m_Store.size();
+      }
+
+      bool empty() const noexcept
+      {
+         return size() == 0;
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type max_size() const noexcept
+      {
+         return MaxElems;
+      }
+
+      key_compare key_comp() const
+      {
+         return m_Store.key_comp();
+      }
+
+      value_compare value_comp() const
+      {
+         return m_Store.key_comp();
+      }
+
+      void clear() noexcept
+      {
+         m_Store.clear();
+      }
+
+      std::pair<iterator, bool> insert(const Key& key)
+      {
+         return emplace_key(key);
+      }
+
+      std::pair<iterator, bool> insert(Key&& key)
+      {
+         return emplace_key(std::move(key));
+      }
+
+      template <typename ... Args>
+      std::pair<iterator, bool> emplace(Args&&... args)
+      {
+         return emplace_key(Key(std::forward<Args>(args)...));
+      }
+
+      // Bulk insert: appends the range, then sorts and deduplicates once.
+      // Keys already in the set win over equal keys in the range.
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      void insert(InputIt first, InputIt last)
+      {
+         // Whether nothing has been appended since the last sort
+         bool sorted = true;
+         for (; first != last; ++first)
+         {
+            const auto& key = *first;
+            if (size() == MaxElems)
+            {
+               // Duplicates may still free up room, and a key that is
+               // already present needs none. The set stays sorted if the
+               // key does not fit.
+               if (!sorted)
+               {
+                  sort_unique();
+                  sorted = true;
+               }
+
+               if (contains(key))
+               {
+                  continue;
+               }
+
+               m_Store.check_room("No space available to insert");
+            }
+
+            m_Store.append_unsorted(key);
+            sorted = false;
+         }
+
+         if (!sorted)
+         {
+            sort_unique();
+         }
+      }
+
+      void insert(std::initializer_list<Key> init)
+      {
+         insert(init.begin(), init.end());
+      }
+
+      iterator erase(const_iterator pos)
+      {
+         return erase(pos, pos + 1);
+      }
+
+      iterator erase(const_iterator first, const_iterator last)
+      {
+         size_type idx = first - begin();
+         m_Store.erase_at(idx, last - begin());
+         return begin() + idx;
+      }
+
+      size_type erase(const Key& key)
+      {
+         size_type idx = m_Store.find(key);
+         if (idx == size())
+         {
+            return 0;
+         }
+
+         m_Store.erase_at(idx, idx + 1);
+         return 1;
+      }
+
+      iterator find(const Key& key) const
+      {
+         return begin() + m_Store.find(key);
+      }
+
+      size_type count(const Key& key) const
+      {
+         return contains(key) ? 1 : 0;
+      }
+
+      bool contains(const Key& key) const
+      {
+         return m_Store.find(key) != size();
+      }
+
+      iterator lower_bound(const Key& key) const
+      {
+         return begin() + m_Store.lower_bound(key);
+      }
+
+      iterator upper_bound(const Key& key) const
+      {
+         return begin() + m_Store.upper_bound(key);
+      }
+
+      std::pair<iterator, iterator> equal_range(const Key& key) const
+      {
+         return std::make_pair(lower_bound(key), upper_bound(key));
+      }
+
+      bool operator == (const bounded_flat_set& rhs) const
+      {
+         return m_Store.keys() == rhs.m_Store.keys();
+      }
+
+      bool operator != (const bounded_flat_set& rhs) const
+      {
+         return !(*this == rhs);
+      }
+
+   private:
+      template <typename K>
+      std::pair<iterator, bool> emplace_key(K&& key)
+      {
+         size_type idx = m_Store.lower_bound(key);
+         if (m_Store.matches(idx, key))
+         {
+            return std::make_pair(begin() + idx, false);
+         }
+
+         m_Store.check_room("No space available to insert");
+         m_Store.insert_at(idx, std::forward<K>(key));
+         return std::make_pair(begin() + idx, true);
+      }
+
+      void sort_unique()
+      {
+         m_Store.sort_unique([](size_type, size_type) {});
+      }
+
+      store_type m_Store;
+   };
+}
@@ -0,0 +1,795 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_flat_map.h"
+#include "bounded_vector.h"
+#include "simd_compare.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      // Control byte of an empty slot. A full slot holds the low 7 bits of
+      // its key's hash, so only empty slots have the sign bit set.
+      constexpr std::int8_t hash_ctrl_empty = -128;
+
+      constexpr std::size_t hash_group_width = 16;
+
+      // Scramble the user hash so that identity hashes (std::hash<int>)
+      // still spread over both the slot index and the 7-bit tag
+      inline std::size_t mix_hash(std::size_t hash) noexcept
+      {
+         std::uint64_t h = hash;
+         h ^= h >> 32;
+         h *= 0x9E3779B97F4A7C15ull;
+         h ^= h >> 32;
+         return static_cast<std::size_t>(h);
+      }
+
+      // Smallest power of two not less than n
+      constexpr std::size_t ceil_pow2(std::size_t n)
+      {
+         std::size_t p = 1;
+         while (p < n)
+         {
+            p <<= 1;
+         }
+
+         return p;
+      }
+
+      // Sixteen consecutive control bytes, matched in one SSE2 compare where
+      // available. Bit i of a result mask stands for the slot at offset i.
+      class hash_group
+      {
+      public:
+         explicit hash_group(const std::int8_t* ctrl) noexcept
+#if NTL_SIMD_X86
+            : m_Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl)))
+#else
+            : m_Ctrl(ctrl)
+#endif
+         {
+         }
+
+         unsigned match(std::int8_t tag) const noexcept
+         {
+#if NTL_SIMD_X86
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(tag), m_Ctrl)));
+#else
+            unsigned mask = 0;
+            for (std::size_t i = 0; i < hash_group_width; ++i)
+            {
+               mask |= static_cast<unsigned>(m_Ctrl[i] == tag) << i;
+            }
+
+            return mask;
+#endif
+         }
+
+         unsigned match_empty() const noexcept
+         {
+#if NTL_SIMD_X86
+            return static_cast<unsigned>(_mm_movemask_epi8(m_Ctrl));
+#else
+            return match(hash_ctrl_empty);
+#endif
+         }
+
+      private:
+#if NTL_SIMD_X86
+         __m128i m_Ctrl;
+#else
+         const std::int8_t* m_Ctrl;
+#endif
+      };
+
+      // Forward iterator over the occupied slots of a bounded_hash_map
+      template <typename Key, typename Mapped>
+      class hash_map_iterator
+      {
+      public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type = std::pair<Key, std::remove_const_t<Mapped>>;
+         using difference_type = std::ptrdiff_t;
+         using reference = std::pair<const Key&, Mapped&>;
+         using pointer = arrow_proxy<reference>;
+
+         hash_map_iterator() noexcept :
+            m_Ctrl(nullptr),
+            m_Key(nullptr),
+            m_Value(nullptr),
+            m_Remaining(0)
+         {
+         }
+
+         // Positions on the first occupied slot of the remaining ones
+         hash_map_iterator(const std::int8_t* ctrl, const Key* key, Mapped* value, std::size_t remaining) noexcept :
+            m_Ctrl(ctrl),
+            m_Key(key),
+            m_Value(value),
+            m_Remaining(remaining)
+         {
+            skip_empty();
+         }
+
+         // iterator converts to const_iterator
+         template <typename Other, typename = std::enable_if_t<std::is_same<const Other, Mapped>::value>>
+         hash_map_iterator(const hash_map_iterator<Key, Other>& rhs) noexcept :
+            m_Ctrl(rhs.ctrl_ptr()),
+            m_Key(rhs.key_ptr()),
+            m_Value(rhs.value_ptr()),
+            m_Remaining(rhs.remaining())
+         {
+         }
+
+         reference operator * () const noexcept
+         {
+            return reference(*m_Key, *m_Value);
+         }
+
+         pointer operator -> () const noexcept
+         {
+            return pointer(**this);
+         }
+
+         const Key& key() const noexcept
+         {
+            return *m_Key;
+         }
+
+         Mapped& value() const noexcept
+         {
+            return *m_Value;
+         }
+
+         const std::int8_t* ctrl_ptr() const noexcept
+         {
+            return m_Ctrl;
+         }
+
+         const Key* key_ptr() const noexcept
+         {
+            return m_Key;
+         }
+
+         Mapped* value_ptr() const noexcept
+         {
+            return m_Value;
+         }
+
+         std::size_t remaining() const noexcept
+         {
+            return m_Remaining;
+         }
+
+         hash_map_iterator& operator ++ () noexcept
+         {
+            advance();
+            skip_empty();
+            return *this;
+         }
+
+         hash_map_iterator operator ++ (int) noexcept
+         {
+            hash_map_iterator tmp(*this);
+            ++*this;
+            return tmp;
+         }
+
+         friend bool operator == (const hash_map_iterator& lhs, const hash_map_iterator& rhs) noexcept
+         {
+            return lhs.m_Key == rhs.m_Key;
+         }
+
+         friend bool operator != (const hash_map_iterator& lhs, const hash_map_iterator& rhs) noexcept
+         {
+            return lhs.m_Key != rhs.m_Key;
+         }
+
+      private:
+         void advance() noexcept
+         {
+            ++m_Ctrl;
+            ++m_Key;
+            ++m_Value;
+            --m_Remaining;
+         }
+
+         void skip_empty() noexcept
+         {
+            while (m_Remaining != 0 && *m_Ctrl == hash_ctrl_empty)
+            {
+               advance();
+            }
+         }
+
+         const std::int8_t* m_Ctrl;
+         const Key* m_Key;
+         Mapped* m_Value;
+         std::size_t m_Remaining;
+      };
+   }
+
+   // Fixed-capacity hash map that never allocates. Open addressing with
+   // linear probing over a power-of-two slot array sized at compile time so
+   // that MaxElems entries stay under MaxLoadPercent load. Each slot has a
+   // control byte (7 hash bits, or empty) and probing matches sixteen of them
+   // per SSE2 compare, so keys are only compared on a likely hit. Erase
+   // shifts the following run of the cluster back instead of leaving
+   // tombstones, so lookups never slow down after churn. Keys and mapped
+   // values are stored in separate arrays.
+   template <typename Key, typename T, std::size_t MaxElems, typename Hash = std::hash<Key>,
+      typename KeyEqual = std::equal_to<Key>, std::size_t MaxLoadPercent = 80>
+   class bounded_hash_map
+   {
+      static_assert(MaxElems > 0, "bounded_hash_map needs room for at least one element");
+      static_assert(MaxLoadPercent > 0 && MaxLoadPercent < 100, "bounded_hash_map load factor must leave empty slots");
+
+      // Moving moves the entries but copies the hasher and the comparator
+      using nothrow_move = std::integral_constant<bool, std::is_nothrow_move_constructible<Key>::value
+         && std::is_nothrow_move_constructible<T>::value
+         && std::is_nothrow_copy_constructible<Hash>::value && std::is_nothrow_copy_assignable<Hash>::value
+         && std::is_nothrow_copy_constructible<KeyEqual>::value && std::is_nothrow_copy_assignable<KeyEqual>::value>;
+
+   public:
+      using key_type = Key;
+      using mapped_type = T;
+      using value_type = std::pair<Key, T>;
+      using hasher = Hash;
+      using key_equal = KeyEqual;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using iterator = detail::hash_map_iterator<Key, T>;
+      using const_iterator = detail::hash_map_iterator<Key, const T>;
+      using reference = typename iterator::reference;
+      using const_reference = typename const_iterator::reference;
+
+      // Number of slots: enough for MaxElems at MaxLoadPercent, and at
+      // least one probe group
+      static constexpr size_type slot_count = std::max(detail::hash_group_width,
+         detail::ceil_pow2((MaxElems * 100 + MaxLoadPercent - 1) / MaxLoadPercent));
+
+      bounded_hash_map() :
+         m_Size(0)
+      {
+         std::memset(m_Ctrl, detail::hash_ctrl_empty, sizeof(m_Ctrl));
+      }
+
+      explicit bounded_hash_map(const Hash& hash, const KeyEqual& equal = KeyEqual()) :
+         bounded_hash_map()
+      {
+         m_Hash = hash;
+         m_Equal = equal;
+      }
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      bounded_hash_map(InputIt first, InputIt last) :
+         bounded_hash_map()
+      {
+         insert(first, last);
+      }
+
+      bounded_hash_map(std::initializer_list<value_type> init) :
+         bounded_hash_map()
+      {
+         insert(init.begin(), init.end());
+      }
+
+      bounded_hash_map(const bounded_hash_map& rhs) :
+         m_Hash(rhs.m_Hash),
+         m_Equal(rhs.m_Equal),
+         m_Size(0)
+      {
+         std::memset(m_Ctrl, detail::hash_ctrl_empty, sizeof(m_Ctrl));
+         copy_slots_from(rhs);
+      }
+
+      bounded_hash_map(bounded_hash_map&& rhs) noexcept(nothrow_move::value) :
+         m_Hash(rhs.m_Hash),
+         m_Equal(rhs.m_Equal),
+         m_Size(0)
+      {
+         std::memset(m_Ctrl, detail::hash_ctrl_empty, sizeof(m_Ctrl));
+         move_slots_from(rhs);
+      }
+
+      bounded_hash_map& operator = (const bounded_hash_map& rhs)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            m_Hash = rhs.m_Hash;
+            m_Equal = rhs.m_Equal;
+            copy_slots_from(rhs);
+         }
+
+         return *this;
+      }
+
+      bounded_hash_map& operator = (bounded_hash_map&& rhs) noexcept(nothrow_move::value)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            m_Hash = rhs.m_Hash;
+            m_Equal = rhs.m_Equal;
+            move_slots_from(rhs);
+         }
+
+         return *this;
+      }
+
+      ~bounded_hash_map()
+      {
+         clear();
+      }
+
+      iterator begin() noexcept
+      {
+         return iterator(m_Ctrl, key_at(0), value_at(0), slot_count);
+      }
+
+      const_iterator begin() const noexcept
+      {
+         return const_iterator(m_Ctrl, key_at(0), value_at(0), slot_count);
+      }
+
+      const_iterator cbegin() const noexcept
+      {
+         return begin();
+      }
+
+      iterator end() noexcept
+      {
+         return iterator_at(slot_count);
+      }
+
+      const_iterator end() const noexcept
+      {
+         return iterator_at(slot_count);
+      }
+
+      const_iterator cend() const noexcept
+      {
+         return end();
+      }
+
+      size_type size() const noexcept
+      {
+         return m_Size;
+      }
+
+      bool empty() const noexcept
+      {
+         return m_Size == 0;
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type max_size() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type bucket_count() const noexcept
+      {
+         return slot_count;
+      }
+
+      float load_factor() const noexcept
+      {
+         return static_cast<float>(m_Size) / slot_count;
+      }
+
+      constexpr float max_load_factor() const noexcept
+      {
+         return static_cast<float>(MaxElems) / slot_count;
+      }
+
+      hasher hash_function() const
+      {
+         return m_Hash;
+      }
+
+      key_equal key_eq() const
+      {
+         return m_Equal;
+      }
+
+      void clear() noexcept
+      {
+         if (!std::is_trivially_destructible<Key>::value || !std::is_trivially_destructible<T>::value)
+         {
+            for (size_type i = 0; i < slot_count; ++i)
+            {
+               if (m_Ctrl[i] != detail::hash_ctrl_empty)
+               {
+                  destroy_slot(i);
+               }
+            }
+         }
+
+         std::memset(m_Ctrl, detail::hash_ctrl_empty, sizeof(m_Ctrl));
+         m_Size = 0;
+      }
+
+      T& at(const Key& key)
+      {
+         return *value_at(checked_find(key));
+      }
+
+      const T& at(const Key& key) const
+      {
+         return *value_at(checked_find(key));
+      }
+
+      T& operator [](const Key& key)
+      {
+         return try_emplace(key).first.value();
+      }
+
+      T& operator [](Key&& key)
+      {
+         return try_emplace(std::move(key)).first.value();
+      }
+
+      std::pair<iterator, bool> insert(const value_type& value)
+      {
+         return try_emplace(value.first, value.second);
+      }
+
+      std::pair<iterator, bool> insert(value_type&& value)
+      {
+         return try_emplace(std::move(value.first), std::move(value.second));
+      }
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      void insert(InputIt first, InputIt last)
+      {
+         for (; first != last; ++first)
+         {
+            insert(*first);
+         }
+      }
+
+      void insert(std::initializer_list<value_type> init)
+      {
+         insert(init.begin(), init.end());
+      }
+
+      template <typename ... Args>
+      std::pair<iterator, bool> emplace(Args&&... args)
+      {
+         value_type value(std::forward<Args>(args)...);
+         return try_emplace(std::move(value.first), std::move(value.second));
+      }
+
+      // Constructs the mapped value from args only if key is absent
+      template <typename ... Args>
+      std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args)
+      {
+         return emplace_unique(key, std::forward<Args>(args)...);
+      }
+
+      template <typename ... Args>
+      std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args)
+      {
+         return emplace_unique(std::move(key), std::forward<Args>(args)...);
+      }
+
+      template <typename M>
+      std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj)
+      {
+         std::pair<iterator, bool> result = try_emplace(key, std::forward<M>(obj));
+         if (!result.second)
+         {
+            result.first.value() = std::forward<M>(obj);
+         }
+
+         return result;
+      }
+
+      iterator find(const Key& key)
+      {
+         return iterator_at(find_slot(key));
+      }
+
+      const_iterator find(const Key& key) const
+      {
+         return iterator_at(find_slot(key));
+      }
+
+      size_type count(const Key& key) const
+      {
+         return contains(key) ? 1 : 0;
+      }
+
+      bool contains(const Key& key) const
+      {
+         return find_slot(key) != slot_count;
+      }
+
+      // Backward shift may move a later element into pos, or an earlier
+      // one when the cluster wraps, so unlike std::unordered_map this does
+      // not return an iterator to continue from.
+      void erase(const_iterator pos)
+      {
+         erase_slot(pos.key_ptr() - key_at(0));
+      }
+
+      size_type erase(const Key& key)
+      {
+         size_type slot = find_slot(key);
+         if (slot == slot_count)
+         {
+            return 0;
+         }
+
+         erase_slot(slot);
+         return 1;
+      }
+
+      bool operator == (const bounded_hash_map& rhs) const
+      {
+         if (size() != rhs.size())
+         {
+            return false;
+         }
+
+         for (const_iterator it = begin(); it != end(); ++it)
+         {
+            const_iterator other = rhs.find(it.key());
+            if (other == rhs.end() || !(other.value() == it.value()))
+            {
+               return false;
+            }
+         }
+
+         return true;
+      }
+
+      bool operator != (const bounded_hash_map& rhs) const
+      {
+         return !(*this == rhs);
+      }
+
+   private:
+      static constexpr size_type s_Mask = slot_count - 1;
+
+      Key* key_at(size_type slot) noexcept
+      {
+         return reinterpret_cast<Key*>(&m_Keys[slot]);
+      }
+
+      const Key* key_at(size_type slot) const noexcept
+      {
+         return reinterpret_cast<const Key*>(&m_Keys[slot]);
+      }
+
+      T* value_at(size_type slot) noexcept
+      {
+         return reinterpret_cast<T*>(&m_Values[slot]);
+      }
+
+      const T* value_at(size_type slot) const noexcept
+      {
+         return reinterpret_cast<const T*>(&m_Values[slot]);
+      }
+
+      iterator iterator_at(size_type slot) noexcept
+      {
+         return iterator(m_Ctrl + slot, key_at(slot), value_at(slot), slot_count - slot);
+      }
+
+      const_iterator iterator_at(size_type slot) const noexcept
+      {
+         return const_iterator(m_Ctrl + slot, key_at(slot), value_at(slot), slot_count - slot);
+      }
+
+      size_type home_slot(std::size_t hash) const noexcept
+      {
+         return (hash >> 7) & s_Mask;
+      }
+
+      static std::int8_t tag_of(std::size_t hash) noexcept
+      {
+         return static_cast<std::int8_t>(hash & 0x7F);
+      }
+
+      std::size_t hash_of(const Key& key) const
+      {
+         return detail::mix_hash(m_Hash(key));
+      }
+
+      // Slots [0, group width) are mirrored past the end so that a group
+      // starting near the end reads the wrapped-around bytes contiguously.
+      void set_ctrl(size_type slot, std::int8_t ctrl) noexcept
+      {
+         m_Ctrl[slot] = ctrl;
+         if (slot < detail::hash_group_width - 1)
+         {
+            m_Ctrl[slot_count + slot] = ctrl;
+         }
+      }
+
+      // Linear probing leaves no empty slot between a key's home and the key,
+      // so the probe ends at the first empty control byte. Returns the slot
+      // holding key, or slot_count with the first empty slot in emptySlot.
+      size_type probe(const Key& key, std::size_t hash, size_type& emptySlot) const
+      {
+         std::int8_t tag = tag_of(hash);
+         size_type pos = home_slot(hash);
+         for (;;)
+         {
+            detail::hash_group group(m_Ctrl + pos);
+            unsigned matches = group.match(tag);
+            unsigned empties = group.match_empty();
+            if (empties != 0)
+            {
+               // Candidates past the first empty slot belong to other clusters
+               matches &= (empties & (0u - empties)) - 1;
+            }
+
+            while (matches != 0)
+            {
+               size_type slot = (pos + detail::simd::count_trailing_zeros(matches)) & s_Mask;
+               if (m_Equal(*key_at(slot), key))
+               {
+                  return slot;
+               }
+
+               matches &= matches - 1;
+            }
+
+            if (empties != 0)
+            {
+               emptySlot = (pos + detail::simd::count_trailing_zeros(empties)) & s_Mask;
+               return slot_count;
+            }
+
+            pos = (pos + detail::hash_group_width) & s_Mask;
+         }
+      }
+
+      size_type find_slot(const Key& key) const
+      {
+         size_type emptySlot;
+         return probe(key, hash_of(key), emptySlot);
+      }
+
+      size_type checked_find(const Key& key) const
+      {
+         size_type slot = find_slot(key);
+         if (slot == slot_count)
+         {
+            detail::throw_or_abort<std::out_of_range>("bounded_hash_map::at key not found");
+         }
+
+         return slot;
+      }
+
+      template <typename K, typename ... Args>
+      std::pair<iterator, bool> emplace_unique(K&& key, Args&&... args)
+      {
+         std::size_t hash = hash_of(key);
+         size_type emptySlot = 0;
+         size_type slot = probe(key, hash, emptySlot);
+         if (slot != slot_count)
+         {
+            return std::make_pair(iterator_at(slot), false);
+         }
+
+         if (m_Size == MaxElems)
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to insert");
+         }
+
+         ::new (static_cast<void*>(value_at(emptySlot))) T(std::forward<Args>(args)...);
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            ::new (static_cast<void*>(key_at(emptySlot))) Key(std::forward<K>(key));
+         }
+         catch (...)
+         {
+            value_at(emptySlot)->~T();
+            throw;
+         }
+#else
+         ::new (static_cast<void*>(key_at(emptySlot))) Key(std::forward<K>(key));
+#endif
+
+         set_ctrl(emptySlot, tag_of(hash));
+         ++m_Size;
+         return std::make_pair(iterator_at(emptySlot), true);
+      }
+
+      void destroy_slot(size_type slot) noexcept
+      {
+         key_at(slot)->~Key();
+         value_at(slot)->~T();
+      }
+
+      void relocate_slot(size_type from, size_type to)
+      {
+         std::allocator<Key> keyAlloc;
+         std::allocator<T> valueAlloc;
+         detail::relocate(keyAlloc, key_at(from), key_at(from) + 1, key_at(to));
+         detail::relocate(valueAlloc, value_at(from), value_at(from) + 1, value_at(to));
+      }
+
+      // Backward shift deletion: walk the rest of the cluster and pull each
+      // entry into the hole when the hole lies between the entry's home slot
+      // and its current slot, so every key stays reachable from its home.
+      void erase_slot(size_type hole)
+      {
+         destroy_slot(hole);
+         --m_Size;
+
+         for (size_type next = (hole + 1) & s_Mask; m_Ctrl[next] != detail::hash_ctrl_empty; next = (next + 1) & s_Mask)
+         {
+            size_type home = home_slot(hash_of(*key_at(next)));
+            if (((next - home) & s_Mask) >= ((next - hole) & s_Mask))
+            {
+               relocate_slot(next, hole);
+               set_ctrl(hole, m_Ctrl[next]);
+               hole = next;
+            }
+         }
+
+         set_ctrl(hole, detail::hash_ctrl_empty);
+      }
+
+      // Same slot layout as rhs, so no rehashing is needed
+      void copy_slots_from(const bounded_hash_map& rhs)
+      {
+         for (size_type i = 0; i < slot_count; ++i)
+         {
+            if (rhs.m_Ctrl[i] != detail::hash_ctrl_empty)
+            {
+               ::new (static_cast<void*>(key_at(i))) Key(*rhs.key_at(i));
+               ::new (static_cast<void*>(value_at(i))) T(*rhs.value_at(i));
+               set_ctrl(i, rhs.m_Ctrl[i]);
+               ++m_Size;
+            }
+         }
+      }
+
+      void move_slots_from(bounded_hash_map& rhs)
+      {
+         for (size_type i = 0; i < slot_count; ++i)
+         {
+            if (rhs.m_Ctrl[i] != detail::hash_ctrl_empty)
+            {
+               ::new (static_cast<void*>(key_at(i))) Key(std::move(*rhs.key_at(i)));
+               ::new (static_cast<void*>(value_at(i))) T(std::move(*rhs.value_at(i)));
+               set_ctrl(i, rhs.m_Ctrl[i]);
+               ++m_Size;
+            }
+         }
+      }
+
+      Hash m_Hash;
+      KeyEqual m_Equal;
+      size_type m_Size;
+      alignas(detail::hash_group_width) std::int8_t m_Ctrl[slot_count + detail::hash_group_width - 1];
+      std::aligned_storage_t<sizeof(Key), alignof(Key)> m_Keys[slot_count];
+      std::aligned_storage_t<sizeof(T), alignof(T)> m_Values[slot_count];
+   };
+
+   template <typename Key, typename T, std::size_t MaxElems, typename Hash, typename KeyEqual, std::size_t MaxLoadPercent>
+   constexpr std::size_t bounded_hash_map<Key, T, MaxElems, Hash, KeyEqual, MaxLoadPercent>::slot_count;
+}
@@ -0,0 +1,371 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      // Number of bits needed to hold values up to n
+      constexpr unsigned bit_width(std::size_t n)
+      {
+         unsigned bits = 0;
+         while (n != 0)
+         {
+            ++bits;
+            n >>= 1;
+         }
+
+         return bits;
+      }
+   }
+
+   // Object pool of at most MaxElems values addressed by 32-bit generational
+   // handles. Insert and erase are O(1): free slots form an intrusive list
+   // threaded through the slot table, and erase moves the last value into
+   // the hole so the values stay dense for iteration. A handle packs a slot
+   // index with the slot's generation, which is bumped on every erase, so a
+   // handle to an erased value no longer resolves, even after the slot has
+   // been reused, until the generation wraps.
+   // Erase reorders the values, so iterators and pointers are not stable
+   // across it; handles are.
+   template <typename T, std::size_t MaxElems>
+   class bounded_slot_map
+   {
+      static_assert(MaxElems > 0, "bounded_slot_map needs room for at least one element");
+
+      using index_type = detail::smallest_size_t<MaxElems>;
+
+      static constexpr unsigned s_IndexBits = detail::bit_width(MaxElems - 1) == 0 ? 1 : detail::bit_width(MaxElems - 1);
+      static_assert(s_IndexBits <= 24, "bounded_slot_map handles need at least 8 generation bits");
+
+      static constexpr std::uint32_t s_IndexMask = (std::uint32_t(1) << s_IndexBits) - 1;
+      static constexpr std::uint32_t s_GenerationMask = UINT32_MAX >> s_IndexBits;
+      static constexpr index_type s_NoSlot = static_cast<index_type>(MaxElems);
+
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type&;
+      using const_reference = const value_type&;
+      using pointer = value_type*;
+      using const_pointer = const value_type*;
+      using iterator = typename bounded_vector<T, MaxElems>::iterator;
+      using const_iterator = typename bounded_vector<T, MaxElems>::const_iterator;
+
+      // Live slots have odd generations, so a default constructed handle
+      // never resolves
+      class handle
+      {
+      public:
+         handle() noexcept :
+            m_Raw(0)
+         {
+         }
+
+         explicit handle(std::uint32_t raw) noexcept :
+            m_Raw(raw)
+         {
+         }
+
+         std::uint32_t raw() const noexcept
+         {
+            return m_Raw;
+         }
+
+         explicit operator bool () const noexcept
+         {
+            return m_Raw != 0;
+         }
+
+         bool operator == (const handle& rhs) const noexcept
+         {
+            return m_Raw == rhs.m_Raw;
+         }
+
+         bool operator != (const handle& rhs) const noexcept
+         {
+            return m_Raw != rhs.m_Raw;
+         }
+
+      private:
+         friend class bounded_slot_map;
+
+         handle(std::uint32_t index, std::uint32_t generation) noexcept :
+            m_Raw((generation << s_IndexBits) | index)
+         {
+         }
+
+         std::uint32_t index() const noexcept
+         {
+            return m_Raw & s_IndexMask;
+         }
+
+         std::uint32_t generation() const noexcept
+         {
+            return m_Raw >> s_IndexBits;
+         }
+
+         std::uint32_t m_Raw;
+      };
+
+      bounded_slot_map() noexcept :
+         m_FreeHead(s_NoSlot),
+         m_NumUsedSlots(0),
+         m_Slots()
+      {
+      }
+
+      iterator begin() noexcept
+      {
+         return m_Values.begin();
+      }
+
+      const_iterator begin() const noexcept
+      {
+         return m_Values.begin();
+      }
+
+      const_iterator cbegin() const noexcept
+      {
+         return m_Values.cbegin();
+      }
+
+      iterator end() noexcept
+      {
+         return m_Values.end();
+      }
+
+      const_iterator end() const noexcept
+      {
+         return m_Values.end();
+      }
+
+      const_iterator cend() const noexcept
+      {
+         return m_Values.cend();
+      }
+
+      pointer data() noexcept
+      {
+         return m_Values.data();
+      }
+
+      const_pointer data() const noexcept
+      {
+         return m_Values.data();
+      }
+
+      size_type size() const noexcept
+      {
+         return m_Values.size();
+      }
+
+      bool empty() const noexcept
+      {
+         return m_Values.empty();
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type max_size() const noexcept
+      {
+         return MaxElems;
+      }
+
+      handle insert(const T& value)
+      {
+         return emplace(value);
+      }
+
+      handle insert(T&& value)
+      {
+         return emplace(std::move(value));
+      }
+
+      template <typename ... Args>
+      handle emplace(Args&&... args)
+      {
+         if (size() == MaxElems)
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to insert");
+         }
+
+         index_type slotIdx = acquire_slot();
+         slot& s = m_Slots[slotIdx];
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            m_Values.unchecked_emplace_back(std::forward<Args>(args)...);
+         }
+         catch (...)
+         {
+            release_slot(slotIdx);
+            throw;
+         }
+#else
+         m_Values.unchecked_emplace_back(std::forward<Args>(args)...);
+#endif
+
+         s.m_Index = static_cast<index_type>(m_DenseToSlot.size());
+         m_DenseToSlot.unchecked_push_back(slotIdx);
+         return handle(slotIdx, s.m_Generation);
+      }
+
+      // Returns false for stale or null handles
+      bool erase(handle h)
+      {
+         if (!contains(h))
+         {
+            return false;
+         }
+
+         index_type slotIdx = static_cast<index_type>(h.index());
+         std::size_t denseIdx = m_Slots[slotIdx].m_Index;
+         std::size_t lastIdx = m_Values.size() - 1;
+         if (denseIdx != lastIdx)
+         {
+            m_Values[denseIdx] = std::move(m_Values[lastIdx]);
+            m_DenseToSlot[denseIdx] = m_DenseToSlot[lastIdx];
+            m_Slots[m_DenseToSlot[denseIdx]].m_Index = static_cast<index_type>(denseIdx);
+         }
+
+         m_Values.pop_back();
+         m_DenseToSlot.pop_back();
+         release_slot(slotIdx);
+         return true;
+      }
+
+      // Invalidates every outstanding handle
+      void clear() noexcept
+      {
+         for (index_type slotIdx : m_DenseToSlot)
+         {
+            release_slot(slotIdx);
+         }
+
+         m_Values.clear();
+         m_DenseToSlot.clear();
+      }
+
+      bool contains(handle h) const noexcept
+      {
+         std::uint32_t idx = h.index();
+         return idx < m_NumUsedSlots
+            && m_Slots[idx].m_Generation == h.generation()
+            && (h.generation() & 1) != 0;
+      }
+
+      // nullptr for stale or null handles
+      pointer get(handle h) noexcept
+      {
+         return contains(h) ? &m_Values[m_Slots[h.index()].m_Index] : nullptr;
+      }
+
+      const_pointer get(handle h) const noexcept
+      {
+         return contains(h) ? &m_Values[m_Slots[h.index()].m_Index] : nullptr;
+      }
+
+      reference at(handle h)
+      {
+         if (!contains(h))
+         {
+            detail::throw_or_abort<std::out_of_range>("bounded_slot_map::at stale handle");
+         }
+
+         return m_Values[m_Slots[h.index()].m_Index];
+      }
+
+      const_reference at(handle h) const
+      {
+         if (!contains(h))
+         {
+            detail::throw_or_abort<std::out_of_range>("bounded_slot_map::at stale handle");
+         }
+
+         return m_Values[m_Slots[h.index()].m_Index];
+      }
+
+      // The caller guarantees h is live
+      reference operator [](handle h) noexcept
+      {
+         assert(contains(h));
+         return m_Values[m_Slots[h.index()].m_Index];
+      }
+
+      const_reference operator [](handle h) const noexcept
+      {
+         assert(contains(h));
+         return m_Values[m_Slots[h.index()].m_Index];
+      }
+
+      // Handle of the value at pos during iteration
+      handle handle_of(const_iterator pos) const noexcept
+      {
+         index_type slotIdx = m_DenseToSlot[pos - cbegin()];
+         return handle(slotIdx, m_Slots[slotIdx].m_Generation);
+      }
+
+   private:
+      // Live slots hold the dense position of their value in m_Index; free
+      // slots hold the next free slot, so the free list needs no storage of
+      // its own. The generation is odd while the slot is live and even while
+      // it is free, so validating a handle is a single compare. Slots past
+      // m_NumUsedSlots have never been handed out; taking those first means
+      // the free list never has to be built up front.
+      struct slot
+      {
+         std::uint32_t m_Generation;
+         index_type m_Index;
+      };
+
+      index_type acquire_slot() noexcept
+      {
+         index_type slotIdx;
+         if (m_FreeHead != s_NoSlot)
+         {
+            slotIdx = m_FreeHead;
+            m_FreeHead = m_Slots[slotIdx].m_Index;
+         }
+         else
+         {
+            slotIdx = static_cast<index_type>(m_NumUsedSlots++);
+         }
+
+         advance_generation(m_Slots[slotIdx]);
+         return slotIdx;
+      }
+
+      // Flips the slot between live and free. The all-ones generation is
+      // odd, so wrapping lands on 0, a free state.
+      static void advance_generation(slot& s) noexcept
+      {
+         s.m_Generation = (s.m_Generation + 1) & s_GenerationMask;
+      }
+
+      void release_slot(index_type slotIdx) noexcept
+      {
+         slot& s = m_Slots[slotIdx];
+         advance_generation(s);
+         s.m_Index = m_FreeHead;
+         m_FreeHead = slotIdx;
+      }
+
+      bounded_vector<T, MaxElems> m_Values;
+      bounded_vector<index_type, MaxElems> m_DenseToSlot;
+      index_type m_FreeHead;
+      std::size_t m_NumUsedSlots;
+      slot m_Slots[MaxElems];
+   };
+}
@@ -0,0 +1,717 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_vector.h"
+#include "simd_compare.h"
+
+namespace ntl
+{
+   // Contiguous view of one column of a bounded_soa_vector
+   template <typename T>
+   using column_span = span<T>;
+
+   namespace detail
+   {
+      // One field's array, aligned to a cache line so that vector loads
+      // from the start of every column are aligned up to 512 bits
+      template <typename T, std::size_t MaxElems>
+      struct soa_column
+      {
+         T* data() noexcept
+         {
+            return reinterpret_cast<T*>(&m_Elems[0]);
+         }
+
+         const T* data() const noexcept
+         {
+            return reinterpret_cast<const T*>(&m_Elems[0]);
+         }
+
+         alignas(std::max(cache_line_size, alignof(T))) std::aligned_storage_t<sizeof(T), alignof(T)> m_Elems[MaxElems];
+      };
+
+      // Moves the element at last down to first, shifting [first, last) up
+      // by one slot
+      template <typename T>
+      void rotate_last_to_front(T* first, T* last)
+      {
+         if (is_trivially_relocatable<T>::value)
+         {
+            std::aligned_storage_t<sizeof(T), alignof(T)> moved;
+            std::memcpy(static_cast<void*>(&moved), static_cast<const void*>(last), sizeof(T));
+            std::memmove(static_cast<void*>(first + 1), static_cast<const void*>(first), (last - first) * sizeof(T));
+            std::memcpy(static_cast<void*>(first), static_cast<const void*>(&moved), sizeof(T));
+         }
+         else
+         {
+            T moved(std::move(*last));
+            std::move_backward(first, last, last + 1);
+            *first = std::move(moved);
+         }
+      }
+
+      // Random access iterator over the rows of a bounded_soa_vector. A row
+      // is a tuple of references, one per column.
+      template <typename Owner, typename Reference, typename Value>
+      class soa_iterator
+      {
+      public:
+         using iterator_category = std::random_access_iterator_tag;
+         using value_type = Value;
+         using difference_type = std::ptrdiff_t;
+         using reference = Reference;
+         using pointer = arrow_proxy<reference>;
+
+         soa_iterator() noexcept :
+            m_Owner(nullptr),
+            m_Idx(0)
+         {
+         }
+
+         soa_iterator(Owner* owner, std::size_t idx) noexcept :
+            m_Owner(owner),
+            m_Idx(idx)
+         {
+         }
+
+         // iterator converts to const_iterator
+         template <typename OtherOwner, typename OtherReference,
+            typename = std::enable_if_t<std::is_same<const OtherOwner, Owner>::value>>
+         soa_iterator(const soa_iterator<OtherOwner, OtherReference, Value>& rhs) noexcept :
+            m_Owner(rhs.owner()),
+            m_Idx(rhs.index())
+         {
+         }
+
+         Owner* owner() const noexcept
+         {
+            return m_Owner;
+         }
+
+         std::size_t index() const noexcept
+         {
+            return m_Idx;
+         }
+
+         reference operator * () const noexcept
+         {
+            return (*m_Owner)[m_Idx];
+         }
+
+         pointer operator -> () const noexcept
+         {
+            return pointer(**this);
+         }
+
+         reference operator [](difference_type n) const noexcept
+         {
+            return (*m_Owner)[m_Idx + n];
+         }
+
+         soa_iterator& operator ++ () noexcept
+         {
+            ++m_Idx;
+            return *this;
+         }
+
+         soa_iterator operator ++ (int) noexcept
+         {
+            soa_iterator tmp(*this);
+            ++m_Idx;
+            return tmp;
+         }
+
+         soa_iterator& operator -- () noexcept
+         {
+            --m_Idx;
+            return *this;
+         }
+
+         soa_iterator operator -- (int) noexcept
+         {
+            soa_iterator tmp(*this);
+            --m_Idx;
+            return tmp;
+         }
+
+         soa_iterator& operator += (difference_type n) noexcept
+         {
+            m_Idx += n;
+            return *this;
+         }
+
+         soa_iterator& operator -= (difference_type n) noexcept
+         {
+            m_Idx -= n;
+            return *this;
+         }
+
+         friend soa_iterator operator + (soa_iterator it, difference_type n) noexcept
+         {
+            return it += n;
+         }
+
+         friend soa_iterator operator + (difference_type n, soa_iterator it) noexcept
+         {
+            return it += n;
+         }
+
+         friend soa_iterator operator - (soa_iterator it, difference_type n) noexcept
+         {
+            return it -= n;
+         }
+
+         friend difference_type operator - (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return static_cast<difference_type>(lhs.m_Idx) - static_cast<difference_type>(rhs.m_Idx);
+         }
+
+         friend bool operator == (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return lhs.m_Idx == rhs.m_Idx;
+         }
+
+         friend bool operator != (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return lhs.m_Idx != rhs.m_Idx;
+         }
+
+         friend bool operator < (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return lhs.m_Idx < rhs.m_Idx;
+         }
+
+         friend bool operator > (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return rhs < lhs;
+         }
+
+         friend bool operator <= (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return !(rhs < lhs);
+         }
+
+         friend bool operator >= (const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+         {
+            return !(lhs < rhs);
+         }
+
+      private:
+         Owner* m_Owner;
+         std::size_t m_Idx;
+      };
+   }
+
+   // Fixed-capacity vector of records stored as a structure of arrays: each
+   // field gets its own contiguous, cache-line aligned column, so a loop
+   // over two fields of a wide record only pulls those two columns through
+   // the cache and vectorizes over them. Rows are accessed through a tuple
+   // of references (std::get<I>(v[i]), or structured bindings), and whole
+   // columns through column<I>().
+   template <std::size_t MaxElems, typename ... Fields>
+   class bounded_soa_vector
+   {
+      static_assert(sizeof...(Fields) > 0, "bounded_soa_vector needs at least one field");
+
+      using index_sequence = std::index_sequence_for<Fields...>;
+
+   public:
+      using value_type = std::tuple<Fields...>;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = std::tuple<Fields&...>;
+      using const_reference = std::tuple<const Fields&...>;
+      using iterator = detail::soa_iterator<bounded_soa_vector, reference, value_type>;
+      using const_iterator = detail::soa_iterator<const bounded_soa_vector, const_reference, value_type>;
+      using reverse_iterator = std::reverse_iterator<iterator>;
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+      template <std::size_t I>
+      using column_type = std::tuple_element_t<I, value_type>;
+
+      bounded_soa_vector() noexcept :
+         m_Size(0)
+      {
+      }
+
+      bounded_soa_vector(std::initializer_list<value_type> init) :
+         m_Size(0)
+      {
+         for (const value_type& row : init)
+         {
+            push_back(row);
+         }
+      }
+
+      bounded_soa_vector(const bounded_soa_vector& rhs) :
+         m_Size(0)
+      {
+         copy_rows_from(rhs);
+      }
+
+      // value_type is a tuple of the fields, so this asks whether every field moves without throwing
+      bounded_soa_vector(bounded_soa_vector&& rhs) noexcept(std::is_nothrow_move_constructible<value_type>::value) :
+         m_Size(0)
+      {
+         move_rows_from(rhs);
+      }
+
+      bounded_soa_vector& operator = (const bounded_soa_vector& rhs)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            copy_rows_from(rhs);
+         }
+
+         return *this;
+      }
+
+      bounded_soa_vector& operator = (bounded_soa_vector&& rhs) noexcept(std::is_nothrow_move_constructible<value_type>::value)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            move_rows_from(rhs);
+         }
+
+         return *this;
+      }
+
+      ~bounded_soa_vector()
+      {
+         clear();
+      }
+
+      // The whole of column I, for loops that touch one field
+      template <std::size_t I>
+      column_span<column_type<I>> column() noexcept
+      {
+         return column_span<column_type<I>>(column_data<I>(), m_Size);
+      }
+
+      template <std::size_t I>
+      column_span<const column_type<I>> column() const noexcept
+      {
+         return column_span<const column_type<I>>(column_data<I>(), m_Size);
+      }
+
+      template <std::size_t I>
+      column_type<I>* data() noexcept
+      {
+         return column_data<I>();
+      }
+
+      template <std::size_t I>
+      const column_type<I>* data() const noexcept
+      {
+         return column_data<I>();
+      }
+
+      iterator begin() noexcept
+      {
+         return iterator(this, 0);
+      }
+
+      const_iterator begin() const noexcept
+      {
+         return cbegin();
+      }
+
+      const_iterator cbegin() const noexcept
+      {
+         return const_iterator(this, 0);
+      }
+
+      iterator end() noexcept
+      {
+         return iterator(this, m_Size);
+      }
+
+      const_iterator end() const noexcept
+      {
+         return cend();
+      }
+
+      const_iterator cend() const noexcept
+      {
+         return const_iterator(this, m_Size);
+      }
+
+      reverse_iterator rbegin() noexcept
+      {
+         return reverse_iterator(end());
+      }
+
+      const_reverse_iterator rbegin() const noexcept
+      {
+         return const_reverse_iterator(end());
+      }
+
+      reverse_iterator rend() noexcept
+      {
+         return reverse_iterator(begin());
+      }
+
+      const_reverse_iterator rend() const noexcept
+      {
+         return const_reverse_iterator(begin());
+      }
+
+      reference operator [](size_type pos) noexcept
+      {
+         return row_at(pos, index_sequence());
+      }
+
+      const_reference operator [](size_type pos) const noexcept
+      {
+         return row_at(pos, index_sequence());
+      }
+
+      reference at(size_type pos)
+      {
+         if (pos >= size())
+         {
+            detail::throw_or_abort<std::out_of_range>("bounded_soa_vector::at index out of range");
+         }
+
+         return (*this)[pos];
+      }
+
+      const_reference at(size_type pos) const
+      {
+         if (pos >= size())
+         {
+            detail::throw_or_abort<std::out_of_range>("bounded_soa_vector::at index out of range");
+         }
+
+         return (*this)[pos];
+      }
+
+      reference front() noexcept
+      {
+         return (*this)[0];
+      }
+
+      const_reference front() const noexcept
+      {
+         return (*this)[0];
+      }
+
+      reference back() noexcept
+      {
+         return (*this)[m_Size - 1];
+      }
+
+      const_reference back() const noexcept
+      {
+         return (*this)[m_Size - 1];
+      }
+
+      size_type size() const noexcept
+      {
+         return m_Size;
+      }
+
+      bool empty() const noexcept
+      {
+         return m_Size == 0;
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type max_size() const noexcept
+      {
+         return MaxElems;
+      }
+
+      void clear() noexcept
+      {
+         destroy_rows(0, m_Size);
+         m_Size = 0;
+      }
+
+      void push_back(const value_type& row)
+      {
+         push_back_tuple(row, index_sequence());
+      }
+
+      void push_back(value_type&& row)
+      {
+         push_back_tuple(std::move(row), index_sequence());
+      }
+
+      // One argument per field, each constructing that field's element
+      template <typename ... Args>
+      void emplace_back(Args&&... args)
+      {
+         static_assert(sizeof...(Args) == sizeof...(Fields), "emplace_back takes one argument per field");
+
+         if (m_Size == MaxElems)
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to emplace_back");
+         }
+
+         construct_row(m_Size, index_sequence(), std::forward<Args>(args)...);
+         ++m_Size;
+      }
+
+      void pop_back()
+      {
+         --m_Size;
+         destroy_rows(m_Size, m_Size + 1);
+      }
+
+      iterator insert(const_iterator pos, const value_type& row)
+      {
+         return insert(pos, value_type(row));
+      }
+
+      // The row is built at the end and then rotated into place column by
+      // column, so a throwing field constructor leaves the vector as it was.
+      // Only a throwing move of a field can leave the rows out of order.
+      iterator insert(const_iterator pos, value_type&& row)
+      {
+         if (m_Size == MaxElems)
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to insert");
+         }
+
+         size_type idx = pos.index();
+         construct_row_from_tuple(m_Size, std::move(row), index_sequence());
+         ++m_Size;
+         if (idx != m_Size - 1)
+         {
+            size_type last = m_Size - 1;
+            for_each_column([idx, last](auto* column)
+            {
+               detail::rotate_last_to_front(column + idx, column + last);
+            });
+         }
+
+         return iterator(this, idx);
+      }
+
+      iterator erase(const_iterator pos)
+      {
+         assert(pos != cend());
+
+         return erase(pos, pos + 1);
+      }
+
+      iterator erase(const_iterator first, const_iterator last)
+      {
+         size_type idx = first.index();
+         size_type count = last - first;
+         if (count > 0)
+         {
+            assert(idx + count <= size());
+            for_each_column([this, idx, count](auto* column)
+            {
+               using column_t = std::remove_pointer_t<decltype(column)>;
+               std::allocator<column_t> alloc;
+               detail::close_gap(alloc, column + idx, column + m_Size, count);
+            });
+
+            m_Size -= count;
+         }
+
+         return iterator(this, idx);
+      }
+
+      bool operator == (const bounded_soa_vector& rhs) const noexcept
+      {
+         bool equal = m_Size == rhs.m_Size;
+         for_each_column_pair(rhs, [this, &equal](const auto* lhsColumn, const auto* rhsColumn)
+         {
+            equal = equal && detail::mismatch_n(lhsColumn, rhsColumn, m_Size) == m_Size;
+         });
+
+         return equal;
+      }
+
+      bool operator != (const bounded_soa_vector& rhs) const noexcept
+      {
+         return !(*this == rhs);
+      }
+
+   private:
+      template <std::size_t I>
+      column_type<I>* column_data() noexcept
+      {
+         return std::get<I>(m_Columns).data();
+      }
+
+      template <std::size_t I>
+      const column_type<I>* column_data() const noexcept
+      {
+         return std::get<I>(m_Columns).data();
+      }
+
+      template <typename Func, std::size_t ... I>
+      void for_each_column(Func func, std::index_sequence<I...>)
+      {
+         (void)std::initializer_list<int>{ (func(column_data<I>()), 0)... };
+      }
+
+      template <typename Func>
+      void for_each_column(Func func)
+      {
+         for_each_column(func, index_sequence());
+      }
+
+      template <typename Func, std::size_t ... I>
+      void for_each_column_pair(const bounded_soa_vector& rhs, Func func, std::index_sequence<I...>) const
+      {
+         (void)std::initializer_list<int>{ (func(column_data<I>(), rhs.template column_data<I>()), 0)... };
+      }
+
+      template <typename Func>
+      void for_each_column_pair(const bounded_soa_vector& rhs, Func func) const
+      {
+         for_each_column_pair(rhs, func, index_sequence());
+      }
+
+      template <std::size_t ... I>
+      reference row_at(size_type pos, std::index_sequence<I...>) noexcept
+      {
+         return reference(column_data<I>()[pos]...);
+      }
+
+      template <std::size_t ... I>
+      const_reference row_at(size_type pos, std::index_sequence<I...>) const noexcept
+      {
+         return const_reference(column_data<I>()[pos]...);
+      }
+
+      template <typename Tuple, std::size_t ... I>
+      void push_back_tuple(Tuple&& row, std::index_sequence<I...>)
+      {
+         emplace_back(std::get<I>(std::forward<Tuple>(row))...);
+      }
+
+      template <typename Tuple, std::size_t ... I>
+      void construct_row_from_tuple(size_type idx, Tuple&& row, std::index_sequence<I...>)
+      {
+         construct_row(idx, index_sequence(), std::get<I>(std::forward<Tuple>(row))...);
+      }
+
+      // Constructs every column at idx; if one throws, the columns already
+      // built are destroyed again
+      template <std::size_t ... I, typename ... Args>
+      void construct_row(size_type idx, std::index_sequence<I...>, Args&&... args)
+      {
+         std::size_t built = 0;
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            (void)std::initializer_list<int>{ (construct_at<I>(idx, std::forward<Args>(args)), ++built, 0)... };
+         }
+         catch (...)
+         {
+            (void)std::initializer_list<int>{ (I < built ? (column_data<I>()[idx].~column_type<I>(), 0) : 0)... };
+            throw;
+         }
+#else
+         (void)std::initializer_list<int>{ (construct_at<I>(idx, std::forward<Args>(args)), ++built, 0)... };
+#endif
+      }
+
+      template <std::size_t I, typename Arg>
+      void construct_at(size_type idx, Arg&& arg)
+      {
+         ::new (static_cast<void*>(column_data<I>() + idx)) column_type<I>(std::forward<Arg>(arg));
+      }
+
+      void destroy_rows(size_type first, size_type last) noexcept
+      {
+         for_each_column([first, last](auto* column)
+         {
+            using column_t = std::remove_pointer_t<decltype(column)>;
+            std::allocator<column_t> alloc;
+            detail::destroy_range(alloc, column + first, column + last);
+         });
+      }
+
+      // Both fill an empty vector one whole column at a time
+      void copy_rows_from(const bounded_soa_vector& rhs)
+      {
+         build_columns_from(rhs, [](const auto* first, const auto* last, auto* dst)
+         {
+            std::uninitialized_copy(first, last, dst);
+         }, index_sequence());
+      }
+
+      void move_rows_from(bounded_soa_vector& rhs)
+      {
+         build_columns_from(rhs, [](auto* first, auto* last, auto* dst)
+         {
+            std::uninitialized_copy(std::make_move_iterator(first), std::make_move_iterator(last), dst);
+         }, index_sequence());
+      }
+
+      // Trivially copyable columns are a single memcpy; any other column is
+      // built by build(first, last, dst), which cleans up after itself if it
+      // throws. Columns already complete are then destroyed again.
+      template <typename Rhs, typename Build, std::size_t ... I>
+      void build_columns_from(Rhs& rhs, Build build, std::index_sequence<I...>)
+      {
+         size_type count = rhs.m_Size;
+         std::size_t built = 0;
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            (void)std::initializer_list<int>{ (build_column<I>(rhs, count, build), ++built, 0)... };
+         }
+         catch (...)
+         {
+            (void)std::initializer_list<int>{ (I < built ? (destroy_column<I>(count), 0) : 0)... };
+            throw;
+         }
+#else
+         (void)std::initializer_list<int>{ (build_column<I>(rhs, count, build), ++built, 0)... };
+#endif
+
+         m_Size = count;
+      }
+
+      template <std::size_t I, typename Rhs, typename Build>
+      void build_column(Rhs& rhs, size_type count, Build& build)
+      {
+         using column_t = column_type<I>;
+
+         auto* src = rhs.template column_data<I>();
+         if (std::is_trivially_copyable<column_t>::value)
+         {
+            std::memcpy(static_cast<void*>(column_data<I>()), static_cast<const void*>(src), count * sizeof(column_t));
+         }
+         else
+         {
+            build(src, src + count, column_data<I>());
+         }
+      }
+
+      template <std::size_t I>
+      void destroy_column(size_type count) noexcept
+      {
+         std::allocator<column_type<I>> alloc;
+         detail::destroy_range(alloc, column_data<I>(), column_data<I>() + count);
+      }
+
+      size_type m_Size;
+      std::tuple<detail::soa_column<Fields, MaxElems>...> m_Columns;
+   };
+}
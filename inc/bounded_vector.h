@@ -1,807 +1,885 @@
 #pragma once
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
 #include <iterator>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#if (defined(_MSVC_LANG) && _MSVC_LANG > 201703L) || __cplusplus > 201703L
+#include <compare>
+#endif
+
+#include "ntl_config.h"
+#include "overflow_policy.h"
+#include "simd_compare.h"
+#include "stats_policy.h"
 
 namespace ntl
 {
-   template <typename T, std::size_t MaxElems, typename Allocator = std::allocator<T>>
-   class bounded_vector
+   // Destructive interference size assumed for padding shared state apart.
+   // std::hardware_destructive_interference_size is not ABI-stable, so it is
+   // not used here.
+   constexpr std::size_t cache_line_size = 64;
+
+   // Compile-time choice of how a bounded container lays out its storage.
+   // aligned<BufferAlignment> starts the element buffer on a BufferAlignment
+   // boundary (32 for AVX, 64 for AVX-512 or a cache line) so vector loops
+   // over data() run on aligned addresses. PadToCacheLine aligns the buffer,
+   // and with it the whole object, to at least a cache line. The object
+   // size then rounds up to whole lines, so containers owned by different
+   // threads in an array never share one. Heap allocating over-aligned
+   // containers needs C++17 aligned new.
+   namespace layout
    {
-   public:
-      using value_type = T;
-      using allocator_type = Allocator;
-      using size_type = std::size_t;
-      using difference_type = std::ptrdiff_t;
-      using reference = value_type&;
-      using const_reference = const value_type&;
-      using pointer = typename std::allocator_traits<allocator_type>::pointer;
-      using const_pointer = typename std::allocator_traits<allocator_type>::const_pointer;
-
-      class iterator
+      template <std::size_t BufferAlignment, bool PadToCacheLine = false>
+      struct aligned
       {
-      public:
-         using iterator_category = std::random_access_iterator_tag;
-         using value_type = T;
-         using difference_type = typename bounded_vector::difference_type;
-         using pointer = typename bounded_vector::pointer;
-         using reference = typename bounded_vector::reference;
-
-         iterator() :
-            m_Ptr(nullptr)
-         {
-         }
+         static_assert((BufferAlignment & (BufferAlignment - 1)) == 0, "alignment must be a power of two");
 
-         iterator(pointer ptr) :
-            m_Ptr(ptr)
-         {
-         }
-
-         iterator(const iterator& rhs) = default;
-         iterator& operator = (const iterator& rhs) = default;
+         static constexpr std::size_t buffer_alignment = PadToCacheLine && BufferAlignment < cache_line_size
+            ? cache_line_size : BufferAlignment;
+      };
 
-         iterator(iterator&& rhs) = default;
-         iterator& operator = (iterator&& rhs) = default;
+      // alignof(T), the default
+      using natural = aligned<1>;
 
-         iterator& operator = (pointer ptr)
-         {
-            m_Ptr = ptr;
-            return *this;
-         }
+      using cache_line_padded = aligned<cache_line_size, true>;
+   }
 
-         reference operator *()
-         {
-            return *m_Ptr;
-         }
+   // Types for which moving an object to new storage and ending the lifetime of
+   // the original is equivalent to a memcpy of its bytes. Specialize this for
+   // types that are not trivially copyable but are safe to relocate bitwise.
+   template <typename T>
+   struct is_trivially_relocatable : std::is_trivially_copyable<T>
+   {
+   };
 
-         pointer operator ->()
-         {
-            return m_Ptr;
-         }
+   // Non-owning view of count contiguous elements
+   template <typename T>
+   class span
+   {
+   public:
+      using element_type = T;
+      using value_type = std::remove_cv_t<T>;
+      using size_type = std::size_t;
+      using pointer = T*;
+      using reference = T&;
+      using iterator = T*;
 
-         const_reference operator *() const
-         {
-            return *m_Ptr;
-         }
+      constexpr span(pointer first, size_type count) noexcept :
+         m_First(first),
+         m_Count(count)
+      {
+      }
 
-         const_pointer operator ->() const
-         {
-            return m_Ptr;
-         }
+      constexpr pointer data() const noexcept
+      {
+         return m_First;
+      }
 
-         template <typename Other>
-         bool operator == (const Other& rhs) const
-         {
-            return m_Ptr == rhs.m_Ptr;
-         }
+      constexpr size_type size() const noexcept
+      {
+         return m_Count;
+      }
 
-         template <typename Other>
-         bool operator != (const Other& rhs) const
-         {
-            return !(*this == rhs);
-         }
+      constexpr size_type size_bytes() const noexcept
+      {
+         return m_Count * sizeof(T);
+      }
 
-         template <typename Other>
-         bool operator > (const Other& rhs) const
-         {
-            return m_Ptr > rhs.m_Ptr;
-         }
+      constexpr bool empty() const noexcept
+      {
+         return m_Count == 0;
+      }
 
-         template <typename Other>
-         bool operator >= (const Other& rhs) const
-         {
-            return (*this > rhs) || (*this == rhs);
-         }
+      constexpr iterator begin() const noexcept
+      {
+         return m_First;
+      }
 
-         template <typename Other>
-         bool operator < (const Other& rhs) const
-         {
-            return !(*this >= rhs);
-         }
+      constexpr iterator end() const noexcept
+      {
+         return m_First + m_Count;
+      }
 
-         template <typename Other>
-         bool operator <= (const Other& rhs) const
-         {
-            return !(*this > rhs);
-         }
+      constexpr reference operator [](size_type n) const noexcept
+      {
+         return m_First[n];
+      }
 
-         iterator& operator ++()
-         {
-            ++m_Ptr;
-            return *this;
-         }
+   private:
+      pointer m_First;
+      size_type m_Count;
+   };
 
-         iterator operator++(int unused)
-         {
-            iterator i = *this;
-            ++m_Ptr;
-            return i;
-         }
+   namespace detail
+   {
+      template <typename It>
+      using enable_if_iterator_t = std::enable_if_t<
+         std::is_convertible<typename std::iterator_traits<It>::iterator_category, std::input_iterator_tag>::value>;
 
-         iterator& operator --()
+      // operator-> result for iterators whose reference type is a temporary
+      template <typename Reference>
+      class arrow_proxy
+      {
+      public:
+         explicit arrow_proxy(Reference ref) :
+            m_Ref(ref)
          {
-            --m_Ptr;
-            return *this;
          }
 
-         iterator operator--(int unused)
+         const Reference* operator -> () const noexcept
          {
-            iterator i = *this;
-            --m_Ptr;
-            return i;
+            return &m_Ref;
          }
 
-         iterator& operator += (difference_type n)
-         {
-            m_Ptr += n;
-            return *this;
-         }
+      private:
+         Reference m_Ref;
+      };
 
-         iterator operator + (difference_type n) const
+      // Narrowest unsigned type able to count to MaxElems
+      template <std::size_t MaxElems>
+      using smallest_size_t =
+         std::conditional_t<MaxElems <= UINT8_MAX, std::uint8_t,
+         std::conditional_t<MaxElems <= UINT16_MAX, std::uint16_t,
+         std::conditional_t<MaxElems <= UINT32_MAX, std::uint32_t, std::uint64_t>>>;
+
+#if defined(__cpp_lib_three_way_comparison)
+      // Element ordering for <=>. Like std::vector, element types that only
+      // provide operator< still order, with std::weak_ordering as the result.
+      struct synth_three_way
+      {
+         template <typename T>
+         constexpr auto operator()(const T& a, const T& b) const
+            requires requires { { a < b } -> std::convertible_to<bool>; }
          {
-            iterator newItr(m_Ptr + n);
-            return newItr;
+            if constexpr (std::three_way_comparable<T>)
+            {
+               return a <=> b;
+            }
+            else
+            {
+               return a < b ? std::weak_ordering::less
+                  : b < a ? std::weak_ordering::greater
+                  : std::weak_ordering::equivalent;
+            }
          }
+      };
 
-         iterator& operator -= (difference_type n)
-         {
-            m_Ptr -= n;
-            return *this;
-         }
+      template <typename T>
+      using synth_three_way_result_t = decltype(synth_three_way()(std::declval<const T&>(), std::declval<const T&>()));
+#endif
 
-         iterator operator - (difference_type n) const
+      // Only a custom allocator can observe destroy() of a trivially destructible T
+      template <typename Allocator, typename T>
+      NTL_CONSTEXPR20 void destroy_range(Allocator& alloc, T* first, T* last)
+      {
+         if (!std::is_trivially_destructible<T>::value
+            || !std::is_same<Allocator, std::allocator<T>>::value)
          {
-            iterator ret(m_Ptr - n);
-            return ret;
+            for (; first != last; ++first)
+            {
+               std::allocator_traits<Allocator>::destroy(alloc, first);
+            }
          }
+      }
 
-         difference_type operator - (const iterator& rhs) const
+      // Moves [first, last) to raw storage at dst and ends the lifetime of the
+      // originals. dst must not overlap the source.
+      template <typename Allocator, typename T>
+      NTL_CONSTEXPR20 void relocate(Allocator& alloc, T* first, T* last, T* dst)
+      {
+         if (is_trivially_relocatable<T>::value && !is_constant_evaluated())
          {
-            return m_Ptr - rhs.m_Ptr;
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(first), (last - first) * sizeof(T));
          }
-
-         reference operator [](size_type n)
+         else
          {
-            return *(m_Ptr + n);
-         }
+            for (T* src = first; src != last; ++src, ++dst)
+            {
+               std::allocator_traits<Allocator>::construct(alloc, dst, std::move(*src));
+            }
 
-         const_reference operator [](size_type n) const
-         {
-            return *(m_Ptr + n);
+            destroy_range(alloc, first, last);
          }
+      }
 
-      private:
-         friend class const_iterator;
-         pointer m_Ptr;
+      // Whether elements can be moved around inside a buffer without the
+      // risk of a throw
+      template <typename T>
+      struct is_nothrow_shiftable : std::integral_constant<bool, is_trivially_relocatable<T>::value
+         || (std::is_nothrow_move_constructible<T>::value && std::is_nothrow_move_assignable<T>::value)>
+      {
       };
 
-      class const_iterator
+      // Moves [first, last) up by count slots, leaving [first, first + count)
+      // as uninitialized storage that the caller must construct into. The
+      // storage up to last + count must be available. A move that throws
+      // halfway leaves the range neither shifted nor whole, so callers go
+      // through insert_gap, which only shifts what is_nothrow_shiftable.
+      template <typename Allocator, typename T>
+      NTL_CONSTEXPR20 void open_gap(Allocator& alloc, T* first, T* last, std::size_t count)
       {
-      public:
-         using iterator_category = std::random_access_iterator_tag;
-         using value_type = T;
-         using difference_type = typename bounded_vector::difference_type;
-         using pointer = typename bounded_vector::const_pointer;
-         using reference = typename bounded_vector::const_reference;
-
-         const_iterator() :
-            m_Ptr(nullptr)
-         {
-         }
-
-         const_iterator(pointer ptr) :
-            m_Ptr(ptr)
-         {
-         }
-
-         const_iterator(const const_iterator& rhs) = default;
-         const_iterator& operator = (const const_iterator& rhs) = default;
-
-         const_iterator(const_iterator&& rhs) = default;
-         const_iterator& operator = (const_iterator&& rhs) = default;
-
-         const_iterator(const iterator& rhs):
-            m_Ptr(rhs.m_Ptr)
+         if (is_trivially_relocatable<T>::value && !is_constant_evaluated())
          {
+            std::memmove(static_cast<void*>(first + count), static_cast<const void*>(first), (last - first) * sizeof(T));
          }
-
-         const_iterator& operator = (const iterator & rhs)
+         else
          {
-            m_Ptr = rhs.m_Ptr;
-            return *this;
-         }
+            // The tail that lands past the current end goes into raw storage,
+            // everything else is shifted by move assignment in one pass.
+            std::size_t tailLen = last - first;
+            std::size_t numConstructed = std::min(count, tailLen);
+            T* src = last - numConstructed;
+            T* dst = last + (count - numConstructed);
+            for (; src != last; ++src, ++dst)
+            {
+               std::allocator_traits<Allocator>::construct(alloc, dst, std::move(*src));
+            }
 
-         const_iterator(iterator&& rhs) :
-            m_Ptr(std::move(rhs.m_Ptr))
-         {
+            std::move_backward(first, last - numConstructed, last);
+            destroy_range(alloc, first, first + numConstructed);
          }
+      }
 
-         const_iterator& operator = (iterator&& rhs)
+      // Undoes open_gap(first, last - count, count) before anything was
+      // constructed into the gap: [first, first + count) is uninitialized
+      // storage and [first + count, last) moves down over it
+      template <typename Allocator, typename T>
+      NTL_CONSTEXPR20 void undo_open_gap(Allocator& alloc, T* first, T* last, std::size_t count)
+      {
+         if (is_trivially_relocatable<T>::value && !is_constant_evaluated())
          {
-            m_Ptr = std::move(rhs.m_Ptr);
-            return *this;
+            std::memmove(static_cast<void*>(first), static_cast<const void*>(first + count), (last - first - count) * sizeof(T));
          }
-
-         const_iterator& operator = (pointer ptr)
+         else
          {
-            m_Ptr = ptr;
-            return *this;
-         }
+            // Mirror of open_gap: the raw slots are constructed into, the rest
+            // is shifted by move assignment, and the vacated end destroyed
+            std::size_t tailLen = last - first - count;
+            std::size_t numConstructed = std::min(count, tailLen);
+            for (std::size_t i = 0; i < numConstructed; ++i)
+            {
+               std::allocator_traits<Allocator>::construct(alloc, first + i, std::move(first[count + i]));
+            }
 
-         reference operator *() const
-         {
-            return *m_Ptr;
+            std::move(first + count + numConstructed, last, first + numConstructed);
+            destroy_range(alloc, last - numConstructed, last);
          }
+      }
 
-         pointer operator ->() const
+      // Calls build(slot) for every slot of [first, last), all or none: if
+      // one throws, the elements already built are destroyed again
+      template <typename Allocator, typename T, typename Build>
+      NTL_CONSTEXPR20 void construct_each(Allocator& alloc, T* first, T* last, Build&& build)
+      {
+         T* elem = first;
+#if NTL_HAS_EXCEPTIONS
+         try
          {
-            return m_Ptr;
+            for (; elem != last; ++elem)
+            {
+               build(elem);
+            }
          }
-
-         template <typename Other>
-         bool operator == (const Other& rhs) const
+         catch (...)
          {
-            return m_Ptr == rhs.m_Ptr;
+            destroy_range(alloc, first, elem);
+            throw;
          }
-
-         template <typename Other>
-         bool operator != (const Other& rhs) const
+#else
+         (void)alloc;
+         for (; elem != last; ++elem)
          {
-            return !(*this == rhs);
+            build(elem);
          }
+#endif
+      }
 
-         template <typename Other>
-         bool operator > (const Other& rhs) const
+      // Constructs count elements at pos through build(slot), shifting
+      // [pos, last) up; the storage up to last + count must be available.
+      // grow() is called once the new elements are live. If a build throws,
+      // the elements built so far are destroyed and the tail moves back, so
+      // the range is as it was and grow() is never called.
+      //
+      // When moving T may throw, the elements are built past last instead
+      // and rotated into place after grow(). A throwing move during the
+      // rotation can then leave elements out of order, but every slot up to
+      // the new size holds an object.
+      template <typename Allocator, typename T, typename Build, typename Grow>
+      NTL_CONSTEXPR20 void insert_gap(Allocator& alloc, T* pos, T* last, std::size_t count, Build&& build, Grow&& grow)
+      {
+         if (!is_nothrow_shiftable<T>::value)
          {
-            return m_Ptr > rhs.m_Ptr;
+            construct_each(alloc, last, last + count, build);
+            grow();
+            std::rotate(pos, last, last + count);
+            return;
          }
 
-         template <typename Other>
-         bool operator >= (const Other& rhs) const
+         open_gap(alloc, pos, last, count);
+#if NTL_HAS_EXCEPTIONS
+         try
          {
-            return (*this > rhs) || (*this == rhs);
+            construct_each(alloc, pos, pos + count, build);
          }
-
-         template <typename Other>
-         bool operator < (const Other& rhs) const
+         catch (...)
          {
-            return !(*this >= rhs);
+            undo_open_gap(alloc, pos, last + count, count);
+            throw;
          }
+#else
+         construct_each(alloc, pos, pos + count, build);
+#endif
 
-         template <typename Other>
-         bool operator <= (const Other& rhs) const
-         {
-            return !(*this > rhs);
-         }
+         grow();
+      }
 
-         const_iterator& operator ++()
+      // Destroys [first, first + count) and moves [first + count, last) down to
+      // fill the hole.
+      template <typename Allocator, typename T>
+      NTL_CONSTEXPR20 void close_gap(Allocator& alloc, T* first, T* last, std::size_t count)
+      {
+         if (is_trivially_relocatable<T>::value && !is_constant_evaluated())
          {
-            ++m_Ptr;
-            return *this;
+            destroy_range(alloc, first, first + count);
+            std::memmove(static_cast<void*>(first), static_cast<const void*>(first + count), (last - first - count) * sizeof(T));
          }
-
-         const_iterator operator++(int unused)
+         else
          {
-            const_iterator i = *this;
-            ++m_Ptr;
-            return i;
+            T* newLast = std::move(first + count, last, first);
+            destroy_range(alloc, newLast, last);
          }
+      }
 
-         const_iterator& operator --()
-         {
-            --m_Ptr;
-            return *this;
-         }
+      // Stateful allocators live in an empty base so they cost nothing when empty.
+      template <typename Allocator>
+      class allocator_holder : private Allocator
+      {
+      protected:
+         allocator_holder() = default;
 
-         const_iterator operator--(int unused)
+         constexpr explicit allocator_holder(const Allocator& alloc) noexcept :
+            Allocator(alloc)
          {
-            const_iterator i = *this;
-            --m_Ptr;
-            return i;
          }
 
-         const_iterator& operator += (difference_type n)
+         constexpr Allocator& get_alloc() noexcept
          {
-            m_Ptr += n;
             return *this;
          }
 
-         const_iterator operator + (difference_type n) const
+         constexpr const Allocator& get_alloc() const noexcept
          {
-            const_iterator newItr(m_Ptr + n);
-            return newItr;
-         }
-
-         const_iterator& operator -= (difference_type n)
-         {
-            m_Ptr -= n;
             return *this;
          }
+      };
 
-         const_iterator operator - (difference_type n) const
-         {
-            const_iterator ret(m_Ptr - n);
-            return ret;
-         }
+      // std::allocator is not trivially copyable, so it is not stored at all.
+      // This keeps bounded_vector of trivially copyable T trivially copyable.
+      template <typename T>
+      class allocator_holder<std::allocator<T>>
+      {
+      protected:
+         allocator_holder() = default;
 
-         difference_type operator - (const const_iterator& rhs) const
+         constexpr explicit allocator_holder(const std::allocator<T>&) noexcept
          {
-            return m_Ptr - rhs.m_Ptr;
          }
 
-         const_reference operator [](size_type n) const
+         constexpr std::allocator<T>& get_alloc() const noexcept
          {
-            return *(m_Ptr + n);
+            return s_Alloc;
          }
 
       private:
-         friend class iterator;
-         pointer m_Ptr;
+         static std::allocator<T> s_Alloc;
       };
 
-      class reverse_iterator
+      template <typename T>
+      std::allocator<T> allocator_holder<std::allocator<T>>::s_Alloc;
+
+      // Overflow policies with state (counters, cursors) are stored per object
+      template <typename Allocator, typename OverflowPolicy, bool Empty = std::is_empty<OverflowPolicy>::value>
+      class overflow_holder : protected allocator_holder<Allocator>
       {
-      public:
-         using iterator_category = std::random_access_iterator_tag;
-         using value_type = T;
-         using difference_type = typename bounded_vector::difference_type;
-         using pointer = typename bounded_vector::pointer;
-         using reference = typename bounded_vector::reference;
+      protected:
+         overflow_holder() = default;
 
-         reverse_iterator() :
-            m_Ptr(nullptr)
+         constexpr overflow_holder(const Allocator& alloc, const OverflowPolicy& policy) noexcept :
+            allocator_holder<Allocator>(alloc),
+            m_Overflow(policy)
          {
          }
 
-         reverse_iterator(pointer ptr) :
-            m_Ptr(ptr)
+         constexpr OverflowPolicy& get_overflow() noexcept
          {
+            return m_Overflow;
          }
 
-         reverse_iterator(const reverse_iterator& rhs) = default;
-         reverse_iterator(reverse_iterator&& rhs) = default;
-
-         reference operator *()
+         constexpr const OverflowPolicy& get_overflow() const noexcept
          {
-            return *m_Ptr;
+            return m_Overflow;
          }
 
-         pointer operator ->()
-         {
-            return m_Ptr;
-         }
+      private:
+         OverflowPolicy m_Overflow;
+      };
 
-         const_reference operator *() const
-         {
-            return *m_Ptr;
-         }
+      template <typename Allocator, typename OverflowPolicy>
+      class overflow_holder<Allocator, OverflowPolicy, true> : protected allocator_holder<Allocator>
+      {
+      protected:
+         overflow_holder() = default;
 
-         const_pointer operator ->() const
+         constexpr overflow_holder(const Allocator& alloc, const OverflowPolicy&) noexcept :
+            allocator_holder<Allocator>(alloc)
          {
-            return m_Ptr;
          }
 
-         template <typename Other>
-         bool operator == (const Other& rhs) const
+         constexpr OverflowPolicy& get_overflow() const noexcept
          {
-            return m_Ptr == rhs.m_Ptr;
+            return s_Overflow;
          }
 
-         template <typename Other>
-         bool operator != (const Other& rhs) const
-         {
-            return !(*this == rhs);
-         }
+      private:
+         static OverflowPolicy s_Overflow;
+      };
 
-         template <typename Other>
-         bool operator > (const Other& rhs) const
-         {
-            return m_Ptr < rhs.m_Ptr;
-         }
+      template <typename Allocator, typename OverflowPolicy>
+      OverflowPolicy overflow_holder<Allocator, OverflowPolicy, true>::s_Overflow;
 
-         template <typename Other>
-         bool operator >= (const Other& rhs) const
+      // Disabled stats take no space and every hook is an empty inline call
+      template <typename StatsPolicy, std::size_t Capacity, std::size_t ElemSize, bool Enabled = StatsPolicy::enabled>
+      class stats_holder
+      {
+      protected:
+         constexpr stats_holder() noexcept :
+            m_Stats(Capacity, ElemSize)
          {
-            return (*this > rhs) || (*this == rhs);
          }
 
-         template <typename Other>
-         bool operator < (const Other& rhs) const
+         constexpr StatsPolicy& get_stats() noexcept
          {
-            return m_Ptr > rhs.m_Ptr;
+            return m_Stats;
          }
 
-         template <typename Other>
-         bool operator <= (const Other& rhs) const
+         constexpr const StatsPolicy& get_stats() const noexcept
          {
-            return (*this < rhs) || (*this == rhs);
+            return m_Stats;
          }
 
-         reverse_iterator& operator ++()
-         {
-            --m_Ptr;
-            return *this;
-         }
+      private:
+         StatsPolicy m_Stats;
+      };
 
-         reverse_iterator operator++(int unused)
+      template <typename StatsPolicy, std::size_t Capacity, std::size_t ElemSize>
+      class stats_holder<StatsPolicy, Capacity, ElemSize, false>
+      {
+      protected:
+         constexpr StatsPolicy get_stats() const noexcept
          {
-            reverse_iterator i = *this;
-            --m_Ptr;
-            return i;
+            return StatsPolicy(Capacity, ElemSize);
          }
+      };
 
-         reverse_iterator& operator --()
+#if NTL_CONSTEXPR_CONTAINERS
+      // Raw element storage. A union member starts no element lifetimes, and
+      // unlike aligned_storage its elements are reachable without
+      // reinterpret_cast, which constant evaluation rejects. A constexpr
+      // object may not hold indeterminate values, so during constant
+      // evaluation the unused slots of trivially destructible T are
+      // value-initialized; at runtime nothing is touched.
+      template <typename T, std::size_t MaxElems, bool TriviallyDestructible = std::is_trivially_destructible<T>::value>
+      union uninitialized_array
+      {
+         constexpr uninitialized_array() noexcept
          {
-            ++m_Ptr;
-            return *this;
+            if constexpr (std::is_default_constructible_v<T>)
+            {
+               if (std::is_constant_evaluated())
+               {
+                  for (std::size_t i = 0; i < MaxElems; ++i)
+                  {
+                     std::construct_at(m_Elems + i);
+                  }
+               }
+            }
          }
 
-         reverse_iterator operator--(int unused)
+         constexpr T* data() noexcept
          {
-            reverse_iterator i = *this;
-            ++m_Ptr;
-            return i;
+            return m_Elems;
          }
 
-         reverse_iterator& operator += (difference_type n)
+         constexpr const T* data() const noexcept
          {
-            m_Ptr -= n;
-            return *this;
+            return m_Elems;
          }
 
-         reverse_iterator operator + (difference_type n) const
+         T m_Elems[MaxElems];
+      };
+
+      template <typename T, std::size_t MaxElems>
+      union uninitialized_array<T, MaxElems, false>
+      {
+         constexpr uninitialized_array() noexcept
          {
-            reverse_iterator newItr(m_Ptr - n);
-            return newItr;
          }
 
-         reverse_iterator& operator -= (difference_type n)
+         constexpr ~uninitialized_array()
          {
-            m_Ptr += n;
-            return *this;
          }
 
-         reverse_iterator operator - (difference_type n) const
+         constexpr T* data() noexcept
          {
-            reverse_iterator ret(m_Ptr + n);
-            return ret;
+            return m_Elems;
          }
 
-         difference_type operator - (const reverse_iterator& rhs) const
+         constexpr const T* data() const noexcept
          {
-            return m_Ptr + rhs.m_Ptr;
+            return m_Elems;
          }
 
-         reference operator [](size_type n)
+         T m_Elems[MaxElems];
+      };
+#else
+      template <typename T, std::size_t MaxElems>
+      struct uninitialized_array
+      {
+         T* data() noexcept
          {
-            return *(m_Ptr - n);
+            return reinterpret_cast<T*>(&m_Elems[0]);
          }
 
-         const_reference operator [](size_type n) const
+         const T* data() const noexcept
          {
-            return *(m_Ptr - n);
+            return reinterpret_cast<const T*>(&m_Elems[0]);
          }
 
-
-      private:
-         friend class const_reverse_iterator;
-         pointer m_Ptr;
+         std::aligned_storage_t<sizeof(T), alignof(T)> m_Elems[MaxElems];
       };
+#endif
 
-      class const_reverse_iterator
+      template <typename T, std::size_t MaxElems, typename Allocator, typename OverflowPolicy, typename Layout>
+      class bounded_vector_storage : protected overflow_holder<Allocator, OverflowPolicy>
       {
-      public:
-         using iterator_category = std::random_access_iterator_tag;
-         using value_type = T;
-         using difference_type = typename bounded_vector::difference_type;
-         using pointer = typename bounded_vector::const_pointer;
-         using reference = typename bounded_vector::const_reference;
+      protected:
+         using size_storage_type = smallest_size_t<MaxElems>;
 
-         const_reverse_iterator() :
-            m_Ptr(nullptr)
+         constexpr bounded_vector_storage() noexcept :
+            m_Size(0)
          {
          }
 
-         const_reverse_iterator(pointer ptr) :
-            m_Ptr(ptr)
+         constexpr bounded_vector_storage(const Allocator& alloc, const OverflowPolicy& policy) noexcept :
+            overflow_holder<Allocator, OverflowPolicy>(alloc, policy),
+            m_Size(0)
          {
          }
 
-         const_reverse_iterator(const const_reverse_iterator& rhs) = default;
-         const_reverse_iterator(const_reverse_iterator&& rhs) = default;
-
-         const_reverse_iterator(const reverse_iterator& rhs) :
-            m_Ptr(rhs.m_Ptr)
+         NTL_CONSTEXPR20 T* get_element_as_pointer(std::size_t idx) noexcept
          {
+            return m_Elems.data() + idx;
          }
 
-         const_reverse_iterator& operator = (const reverse_iterator& rhs)
+         NTL_CONSTEXPR20 const T* get_element_as_pointer(std::size_t idx) const noexcept
          {
-            m_Ptr = rhs.m_Ptr;
-            return *this;
+            return m_Elems.data() + idx;
          }
 
-         const_reverse_iterator(reverse_iterator && rhs) :
-            m_Ptr(std::move(rhs.m_Ptr))
+         NTL_CONSTEXPR20 void set_size(std::size_t size) noexcept
          {
+            m_Size = static_cast<size_storage_type>(size);
          }
 
-         const_reverse_iterator& operator = (reverse_iterator&& rhs)
+         NTL_CONSTEXPR20 void destroy_range(T* first, T* last)
          {
-            m_Ptr = std::move(rhs.m_Ptr);
-            return *this;
+            detail::destroy_range(this->get_alloc(), first, last);
          }
 
-         const_reference operator *() const
-         {
-            return *m_Ptr;
-         }
+         size_storage_type m_Size;
+         alignas(std::max(alignof(T), Layout::buffer_alignment)) uninitialized_array<T, MaxElems> m_Elems;
+      };
 
-         const_pointer operator ->() const
-         {
-            return m_Ptr;
-         }
+      template <typename T, typename Allocator, typename OverflowPolicy = overflow::throw_error>
+      using is_trivial_bounded_storage = std::integral_constant<bool,
+         std::is_trivially_copyable<T>::value
+         && std::is_same<Allocator, std::allocator<T>>::value
+         && std::is_trivially_copyable<OverflowPolicy>::value>;
+
+      // Element buffers up to this many bytes are copied whole; larger ones
+      // copy only the live elements.
+      constexpr std::size_t trivial_copy_max_bytes = 128;
+
+      // Copy, move and destruction that touch only the live elements. Small
+      // buffers of trivially copyable T use the specialization below, which
+      // keeps every special member implicit and therefore trivial.
+      template <typename T, std::size_t MaxElems, typename Allocator, typename OverflowPolicy, typename Layout,
+         bool Trivial = is_trivial_bounded_storage<T, Allocator, OverflowPolicy>::value && sizeof(T) * MaxElems <= trivial_copy_max_bytes>
+      class bounded_vector_base : protected bounded_vector_storage<T, MaxElems, Allocator, OverflowPolicy, Layout>
+      {
+         using storage_type = bounded_vector_storage<T, MaxElems, Allocator, OverflowPolicy, Layout>;
+         using alloc_traits = std::allocator_traits<Allocator>;
 
-         template <typename Other>
-         bool operator == (const Other& rhs) const
-         {
-            return m_Ptr == rhs.m_Ptr;
-         }
+      protected:
+         bounded_vector_base() noexcept = default;
 
-         template <typename Other>
-         bool operator != (const Other& rhs) const
+         NTL_CONSTEXPR20 bounded_vector_base(const bounded_vector_base& rhs) :
+            storage_type(alloc_traits::select_on_container_copy_construction(rhs.get_alloc()), rhs.get_overflow())
          {
-            return !(*this == rhs);
+            copy_elements_from(rhs);
          }
 
-         template <typename Other>
-         bool operator > (const Other& rhs) const
+         NTL_CONSTEXPR20 bounded_vector_base(bounded_vector_base&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value) :
+            storage_type(rhs.get_alloc(), rhs.get_overflow())
          {
-            return m_Ptr < rhs.m_Ptr;
+            move_elements_from(rhs);
          }
 
-         template <typename Other>
-         bool operator >= (const Other& rhs) const
+         NTL_CONSTEXPR20 bounded_vector_base& operator = (const bounded_vector_base& rhs)
          {
-            return (*this > rhs) || (*this == rhs);
-         }
+            if (this != &rhs)
+            {
+               clear_elements();
+               copy_elements_from(rhs);
+               this->get_overflow() = rhs.get_overflow();
+            }
 
-         template <typename Other>
-         bool operator < (const Other& rhs) const
-         {
-            return m_Ptr > rhs.m_Ptr;
+            return *this;
          }
 
-         template <typename Other>
-         bool operator <= (const Other& rhs) const
+         NTL_CONSTEXPR20 bounded_vector_base& operator = (bounded_vector_base&& rhs) noexcept(std::is_nothrow_move_constructible<T>::value)
          {
-            return (*this < rhs) || (*this == rhs);
-         }
+            if (this != &rhs)
+            {
+               clear_elements();
+               move_elements_from(rhs);
+               this->get_overflow() = rhs.get_overflow();
+            }
 
-         const_reverse_iterator& operator ++()
-         {
-            --m_Ptr;
             return *this;
          }
 
-         const_reverse_iterator operator++(int unused)
+         NTL_CONSTEXPR20 ~bounded_vector_base()
          {
-            const_reverse_iterator i = *this;
-            --m_Ptr;
-            return i;
+            clear_elements();
          }
 
-         const_reverse_iterator& operator --()
+      private:
+         NTL_CONSTEXPR20 void clear_elements()
          {
-            ++m_Ptr;
-            return *this;
+            this->destroy_range(this->get_element_as_pointer(0), this->get_element_as_pointer(this->m_Size));
+            this->m_Size = 0;
          }
 
-         const_reverse_iterator operator--(int unused)
+         NTL_CONSTEXPR20 void copy_elements_from(const bounded_vector_base& rhs)
          {
-            const_reverse_iterator i = *this;
-            ++m_Ptr;
-            return i;
+            if (is_trivial_bounded_storage<T, Allocator, OverflowPolicy>::value && !is_constant_evaluated())
+            {
+               std::memcpy(static_cast<void*>(this->m_Elems.data()), static_cast<const void*>(rhs.m_Elems.data()), rhs.m_Size * sizeof(T));
+               this->m_Size = rhs.m_Size;
+            }
+            else
+            {
+               for (std::size_t i = 0; i < rhs.m_Size; ++i)
+               {
+                  alloc_traits::construct(this->get_alloc(), this->get_element_as_pointer(i), *rhs.get_element_as_pointer(i));
+                  ++this->m_Size;
+               }
+            }
          }
 
-         const_reverse_iterator& operator += (difference_type n)
+         NTL_CONSTEXPR20 void move_elements_from(bounded_vector_base& rhs)
          {
-            m_Ptr -= n;
-            return *this;
+            if (is_trivial_bounded_storage<T, Allocator, OverflowPolicy>::value)
+            {
+               copy_elements_from(rhs);
+            }
+            else
+            {
+               for (std::size_t i = 0; i < rhs.m_Size; ++i)
+               {
+                  alloc_traits::construct(this->get_alloc(), this->get_element_as_pointer(i), std::move(*rhs.get_element_as_pointer(i)));
+                  ++this->m_Size;
+               }
+            }
          }
+      };
 
-         const_reverse_iterator operator + (difference_type n) const
-         {
-            const_reverse_iterator newItr(m_Ptr - n);
-            return newItr;
-         }
+      template <typename T, std::size_t MaxElems, typename Allocator, typename OverflowPolicy, typename Layout>
+      class bounded_vector_base<T, MaxElems, Allocator, OverflowPolicy, Layout, true> : protected bounded_vector_storage<T, MaxElems, Allocator, OverflowPolicy, Layout>
+      {
+      };
+   }
 
-         const_reverse_iterator& operator -= (difference_type n)
-         {
-            m_Ptr += n;
-            return *this;
-         }
+   template <typename T, std::size_t MaxElems, typename Allocator = std::allocator<T>,
+      typename OverflowPolicy = overflow::throw_error, typename StatsPolicy = stats::disabled, typename Layout = layout::natural>
+   class bounded_vector : private detail::bounded_vector_base<T, MaxElems, Allocator, OverflowPolicy, Layout>,
+      private detail::stats_holder<StatsPolicy, MaxElems, sizeof(T)>
+   {
+      using base_type = detail::bounded_vector_base<T, MaxElems, Allocator, OverflowPolicy, Layout>;
+      using stats_holder_type = detail::stats_holder<StatsPolicy, MaxElems, sizeof(T)>;
 
-         const_reverse_iterator operator - (difference_type n) const
-         {
-            const_reverse_iterator ret(m_Ptr + n);
-            return ret;
-         }
+   public:
+      using value_type = T;
+      using allocator_type = Allocator;
+      using overflow_policy_type = OverflowPolicy;
+      using stats_policy_type = StatsPolicy;
+      using layout_type = Layout;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type&;
+      using const_reference = const value_type&;
+      using pointer = typename std::allocator_traits<allocator_type>::pointer;
+      using const_pointer = typename std::allocator_traits<allocator_type>::const_pointer;
 
-         difference_type operator - (const const_reverse_iterator& rhs) const
-         {
-            return m_Ptr + rhs.m_Ptr;
-         }
+      // Plain pointers satisfy std::contiguous_iterator and let the standard
+      // algorithms dispatch to their memmove/memcmp specializations.
+      using iterator = pointer;
+      using const_iterator = const_pointer;
+      using reverse_iterator = std::reverse_iterator<iterator>;
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
-         const_reference operator [](size_type n) const
-         {
-            return *(m_Ptr - n);
-         }
-      private:
-         friend class reverse_iterator;
-         pointer m_Ptr;
-      };
+      NTL_CONSTEXPR20 bounded_vector() noexcept = default;
 
-      bounded_vector() noexcept:
-         m_LastElem(get_element_as_pointer(0))
+      NTL_CONSTEXPR20 bounded_vector(std::initializer_list<T> init)
       {
+         append_range(init);
       }
 
-      bounded_vector(const bounded_vector& rhs) noexcept :
-         m_Elems(rhs.m_Elems)
+      NTL_CONSTEXPR20 bounded_vector(const bounded_vector& rhs) = default;
+      NTL_CONSTEXPR20 bounded_vector(bounded_vector&& rhs) = default;
+      NTL_CONSTEXPR20 bounded_vector& operator = (const bounded_vector& rhs) = default;
+      NTL_CONSTEXPR20 bounded_vector& operator = (bounded_vector&& rhs) = default;
+      NTL_CONSTEXPR20 ~bounded_vector() = default;
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      NTL_CONSTEXPR20 void assign(InputIt first, InputIt last)
       {
-         auto numElems = std::distance(rhs.begin(), rhs.end());
-         m_LastElem = get_element_as_pointer(0);
-         for (auto i = 0; i < numElems; ++i)
-         {
-            ++m_LastElem;
-         }
+         reset();
+         insert(cend(), first, last);
       }
 
-      bounded_vector(bounded_vector&& rhs) noexcept
+      NTL_CONSTEXPR20 void assign(size_type count, const T& value)
       {
-         auto numElems = std::distance(rhs.begin(), rhs.end());
-         m_LastElem = get_element_as_pointer(0);
-         for (auto i = 0; i < numElems; ++i)
-         {
-            ++m_LastElem;
-         }
-
-         m_Elems = std::move(rhs.m_Elems);
+         reset();
+         insert(cend(), count, value);
       }
 
-      bounded_vector& operator = (const bounded_vector& rhs) noexcept
+      NTL_CONSTEXPR20 void assign(std::initializer_list<T> init)
       {
-         if (this != &rhs)
-         {
-            reset();
-            std::copy(rhs.begin(), rhs.end(), std::back_inserter(*this));
-         }
-
-         return *this;
+         assign(init.begin(), init.end());
       }
 
-      bounded_vector& operator = (bounded_vector&& rhs) noexcept
+      NTL_CONSTEXPR20 iterator begin() noexcept
       {
-         if (this != &rhs)
-         {
-            reset();
-            for (auto i = 0; i < rhs.size(); ++i)
-            {
-               ++m_LastElem;
-            }
-
-            m_Elems = std::move(rhs.m_Elems);
-         }
-
-         return *this;
+         return get_element_as_pointer(0);
       }
 
-      ~bounded_vector()
+      NTL_CONSTEXPR20 const_iterator begin() const noexcept
       {
-         reset();
+         return cbegin();
       }
 
-      iterator begin() noexcept
+      NTL_CONSTEXPR20 const_iterator cbegin() const noexcept
       {
-         return iterator(get_element_as_pointer(0));
+         return get_element_as_pointer(0);
       }
 
-      const_iterator begin() const noexcept
+      NTL_CONSTEXPR20 reverse_iterator rbegin() noexcept
       {
-         return cbegin();
+         return reverse_iterator(end());
       }
 
-      const_iterator cbegin() const noexcept
+      NTL_CONSTEXPR20 const_reverse_iterator rbegin() const noexcept
       {
-         return const_iterator(get_element_as_pointer(0));
+         return crbegin();
       }
 
-      reverse_iterator rbegin() noexcept
+      NTL_CONSTEXPR20 const_reverse_iterator crbegin() const noexcept
       {
-         auto endItr = end();
-         --endItr;
-         return reverse_iterator(endItr);
+         return const_reverse_iterator(cend());
       }
 
-      const_reverse_iterator rbegin() const noexcept
+      NTL_CONSTEXPR20 iterator end() noexcept
       {
-         return crbegin();
+         return get_element_as_pointer(m_Size);
       }
 
-      const_reverse_iterator crbegin() const noexcept
+      NTL_CONSTEXPR20 const_iterator end() const noexcept
       {
-         auto endItr = end();
-         --endItr;
-         return const_reverse_iterator(endItr);
+         return cend();
       }
 
-      iterator end() noexcept
+      NTL_CONSTEXPR20 const_iterator cend() const noexcept
       {
-         return iterator(m_LastElem);
+         return get_element_as_pointer(m_Size);
       }
 
-      const_iterator end() const noexcept
+      NTL_CONSTEXPR20 reverse_iterator rend() noexcept
       {
-         return const_iterator(m_LastElem);
+         return reverse_iterator(begin());
       }
 
-      const_iterator cend() const noexcept
+      NTL_CONSTEXPR20 const_reverse_iterator rend() const noexcept
       {
-         return const_iterator(m_LastElem);
+         return crend();
       }
 
-      reverse_iterator rend() noexcept
+      NTL_CONSTEXPR20 const_reverse_iterator crend() const noexcept
       {
-         auto bItr = begin();
-         --bItr;
-         return reverse_iterator(bItr);
+         return const_reverse_iterator(cbegin());
       }
 
-      const_reverse_iterator rend() const noexcept
+      NTL_CONSTEXPR20 pointer data() noexcept
       {
-         return crend();
+         return get_element_as_pointer(0);
       }
 
-      const_reverse_iterator crend() const noexcept
+      NTL_CONSTEXPR20 const_pointer data() const noexcept
       {
-         auto bItr = begin();
-         --bItr;
-         return const_reverse_iterator(bItr);
+         return get_element_as_pointer(0);
       }
 
-      reference at(size_type pos)
+      NTL_CONSTEXPR20 reference at(size_type pos)
       {
-         if (pos > size())
+         if (pos >= size())
          {
-            throw std::out_of_range();
+            detail::throw_or_abort<std::out_of_range>("bounded_vector::at index out of range");
          }
 
          return *get_element_as_pointer(pos);
       }
 
-      const_reference at(size_type pos) const
+      NTL_CONSTEXPR20 const_reference at(size_type pos) const
       {
-         if (pos > size())
+         if (pos >= size())
          {
-            throw std::out_of_range();
+            detail::throw_or_abort<std::out_of_range>("bounded_vector::at index out of range");
          }
 
          return *get_element_as_pointer(pos);
       }
 
-      reference operator [](size_type pos) noexcept
+      NTL_CONSTEXPR20 reference operator [](size_type pos) noexcept
       {
          return *get_element_as_pointer(pos);
       }
 
-      const_reference operator [](size_type pos) const noexcept
+      NTL_CONSTEXPR20 const_reference operator [](size_type pos) const noexcept
       {
          return *get_element_as_pointer(pos);
       }
 
-      void clear() noexcept
+      NTL_CONSTEXPR20 void clear() noexcept
       {
          reset();
       }
@@ -816,279 +894,570 @@ namespace ntl
          return capacity();
       }
 
-      allocator_type get_allocator() const noexcept
+      NTL_CONSTEXPR20 allocator_type get_allocator() const noexcept
+      {
+         return this->get_alloc();
+      }
+
+      NTL_CONSTEXPR20 const overflow_policy_type& get_overflow_policy() const noexcept
+      {
+         return this->get_overflow();
+      }
+
+      // With stats::tracked (container_stats.h), the counters and the name shown by stats::dump()
+      NTL_CONSTEXPR20 decltype(auto) get_stats() noexcept
+      {
+         return stats_holder_type::get_stats();
+      }
+
+      NTL_CONSTEXPR20 decltype(auto) get_stats() const noexcept
       {
-         return m_Alloc;
+         return stats_holder_type::get_stats();
       }
 
-      reference front() noexcept
+      NTL_CONSTEXPR20 reference front() noexcept
       {
          return *get_element_as_pointer(0);
       }
 
-      const_reference front() const noexcept
+      NTL_CONSTEXPR20 const_reference front() const noexcept
       {
          return *get_element_as_pointer(0);
       }
 
-      reference back() noexcept
+      NTL_CONSTEXPR20 reference back() noexcept
       {
-         pointer elem = m_LastElem;
-         --elem;
-         return *elem;
+         return *get_element_as_pointer(m_Size - 1);
       }
 
-      const_reference back() const
+      NTL_CONSTEXPR20 const_reference back() const
       {
-         pointer elem = m_LastElem;
-         --elem;
-         return *elem;
+         return *get_element_as_pointer(m_Size - 1);
       }
 
-      size_type size() const noexcept
+      NTL_CONSTEXPR20 size_type size() const noexcept
       {
-         return end() - begin();
+         return m_Size;
       }
 
-      void push_back(const T& elem)
+      NTL_CONSTEXPR20 void push_back(const T& elem)
+      {
+         append("No space available to push_back", elem);
+      }
+
+      NTL_CONSTEXPR20 void push_back(T&& elem)
+      {
+         append("No space available to push_back", std::move(elem));
+      }
+
+      template <typename ... Args>
+      NTL_CONSTEXPR20 void emplace_back(Args&&... args)
+      {
+         append("No space available to emplace_back", std::forward<Args>(args)...);
+      }
+
+      // Returns nullptr instead of throwing when the vector is full
+      NTL_CONSTEXPR20 pointer try_push_back(const T& elem)
+      {
+         return try_emplace_back(elem);
+      }
+
+      NTL_CONSTEXPR20 pointer try_push_back(T&& elem)
+      {
+         return try_emplace_back(std::move(elem));
+      }
+
+      template <typename ... Args>
+      NTL_CONSTEXPR20 pointer try_emplace_back(Args&&... args)
       {
          if (size() < capacity())
          {
-            *m_LastElem = elem;
-            ++m_LastElem;
+            return std::addressof(unchecked_emplace_back(std::forward<Args>(args)...));
          }
-         else
+
+         return nullptr;
+      }
+
+      // The caller guarantees size() < capacity()
+      NTL_CONSTEXPR20 reference unchecked_push_back(const T& elem)
+      {
+         return unchecked_emplace_back(elem);
+      }
+
+      NTL_CONSTEXPR20 reference unchecked_push_back(T&& elem)
+      {
+         return unchecked_emplace_back(std::move(elem));
+      }
+
+      template <typename ... Args>
+      NTL_CONSTEXPR20 reference unchecked_emplace_back(Args&&... args)
+      {
+         assert(size() < capacity());
+
+         pointer elem = get_element_as_pointer(m_Size);
+         std::allocator_traits<allocator_type>::construct(this->get_alloc(), elem, std::forward<Args>(args)...);
+         ++m_Size;
+         this->get_stats().on_size(m_Size);
+         return *elem;
+      }
+
+      NTL_CONSTEXPR20 void pop_back()
+      {
+         --m_Size;
+         std::allocator_traits<allocator_type>::destroy(this->get_alloc(), get_element_as_pointer(m_Size));
+         this->get_overflow().on_shrink(m_Size);
+      }
+
+      // Grows with value-initialized elements or shrinks from the back. A
+      // growth that does not fit goes to the overflow policy, which decides
+      // how much of it happens.
+      NTL_CONSTEXPR20 void resize(size_type count)
+      {
+         if (shrink_to(count))
          {
-            throw std::runtime_error("No space available to push_back");
+            grow_to(size() + room_for(count - size(), "No space available to resize"));
          }
       }
 
-      void push_back(T&& elem)
+      NTL_CONSTEXPR20 void resize(size_type count, const T& value)
       {
-         if (size() < capacity())
+         if (shrink_to(count))
          {
-            *m_LastElem = std::move(elem);
-            ++m_LastElem;
+            grow_to(size() + room_for(count - size(), "No space available to resize"), value);
          }
-         else
+      }
+
+      // As resize, but new elements of trivially default constructible T are
+      // left indeterminate for the caller to overwrite; no zero-fill
+      NTL_CONSTEXPR20 void resize_for_overwrite(size_type count)
+      {
+         if (shrink_to(count))
          {
-            throw std::runtime_error("No space available to push_back");
+            count = size() + room_for(count - size(), "No space available to resize");
+            if (std::is_trivially_default_constructible<T>::value && !detail::is_constant_evaluated())
+            {
+               set_size(count);
+               this->get_stats().on_size(m_Size);
+            }
+            else
+            {
+               grow_to(count);
+            }
          }
       }
 
-      template <typename ... Args>
-      void emplace_back(Args&&... args)
+      // Zero-copy fill from read(), recv() and the like: returns the next
+      // count uninitialized slots past end() without changing size(), and
+      // commit_append(n) then makes the first n of them elements. When count
+      // does not fit the span is as long as the overflow policy allows.
+      // Anything that changes the size in between invalidates the span.
+      NTL_CONSTEXPR20 span<T> append_uninitialized(size_type count)
       {
-         if (size() < capacity())
+         static_assert(std::is_trivially_copyable<T>::value, "append_uninitialized requires trivially copyable elements");
+
+         return span<T>(get_element_as_pointer(m_Size), room_for(count, "No space available to append"));
+      }
+
+      NTL_CONSTEXPR20 void commit_append(size_type count) noexcept
+      {
+         assert(count <= capacity() - size());
+
+         set_size(m_Size + count);
+         this->get_stats().on_size(m_Size);
+      }
+
+      NTL_CONSTEXPR20 bool empty() const noexcept
+      {
+         return m_Size == 0;
+      }
+
+      NTL_CONSTEXPR20 iterator insert(const_iterator pos, const T& value)
+      {
+         return emplace(pos, value);
+      }
+
+      NTL_CONSTEXPR20 iterator insert(const_iterator pos, T&& value)
+      {
+         return emplace(pos, std::move(value));
+      }
+
+      NTL_CONSTEXPR20 iterator insert(const_iterator pos, size_type count, const T& value)
+      {
+         size_type idx = pos - cbegin();
+         size_type fitting = room_for(count, "No space available to insert");
+         if (fitting == 0 && count > 0)
          {
-            std::allocator_traits<allocator_type>::construct(m_Alloc, m_LastElem, std::forward<Args>(args)...);
-            ++m_LastElem;
+            return end();
          }
-         else
+
+         if (fitting > 0)
          {
-            throw std::runtime_error("No space available to emplace_back");
+            // Copy first in case value refers to an element that is about to move
+            value_type tmp(value);
+            insert_n(idx, fitting, [this, &tmp](pointer dst)
+            {
+               std::allocator_traits<allocator_type>::construct(this->get_alloc(), dst, tmp);
+            });
          }
+
+         return get_element_as_pointer(idx);
       }
 
-      void pop_back()
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      NTL_CONSTEXPR20 iterator insert(const_iterator pos, InputIt first, InputIt last)
       {
-         --m_LastElem;
-         std::allocator_traits<allocator_type>::destroy(m_Alloc, m_LastElem);
+         return insert_range(pos - cbegin(), first, last, typename std::iterator_traits<InputIt>::iterator_category());
       }
 
-      bool empty() const noexcept
+      NTL_CONSTEXPR20 iterator insert(const_iterator pos, std::initializer_list<T> init)
       {
-         return begin() == end();
+         return insert(pos, init.begin(), init.end());
       }
 
-      iterator insert(const_iterator pos, const T& value)
+      template <typename Range>
+      NTL_CONSTEXPR20 void append_range(Range&& range)
       {
-         if (size() < capacity())
-         {
-            iterator currLastElem = end();
-            iterator next = end();
-            --next;
+         using std::begin;
+         using std::end;
+         insert(cend(), begin(range), end(range));
+      }
 
-            while (next != pos)
+      template <typename ... Args>
+      NTL_CONSTEXPR20 iterator emplace(const_iterator pos, Args&&... args)
+      {
+         if (room_for(1, "No space available to insert") == 1)
+         {
+            size_type idx = pos - cbegin();
+            if (idx == size())
             {
-               std::swap(currLastElem, next);
-               --currLastElem;
-               --next;
+               unchecked_emplace_back(std::forward<Args>(args)...);
+            }
+            else
+            {
+               // Construct first so that args referring into this container stay valid
+               value_type tmp(std::forward<Args>(args)...);
+               insert_n(idx, 1, [this, &tmp](pointer dst)
+               {
+                  std::allocator_traits<allocator_type>::construct(this->get_alloc(), dst, std::move(tmp));
+               });
             }
 
-            ++m_LastElem;
-
-            *next = value;
-            return next;
-         }
-         else
-         {
-            throw std::runtime_error("No space available to insert");
+            return get_element_as_pointer(idx);
          }
+
+         return end();
       }
 
-      iterator insert(const_iterator pos, T&& value)
+      NTL_CONSTEXPR20 iterator erase(const_iterator pos)
       {
-         if (size() < capacity())
+         assert(pos != cend());
+
+         return erase(pos, pos + 1);
+      }
+
+      NTL_CONSTEXPR20 iterator erase(const_iterator first, const_iterator last)
+      {
+         size_type idx = first - cbegin();
+         size_type count = last - first;
+         if (count > 0)
          {
-            iterator currLastElem = end();
-            iterator next = end();
-            --next;
+            assert(idx + count <= size());
+            close_gap(idx, count);
+         }
 
-            while (next != pos)
-            {
-               std::swap(currLastElem, next);
-               --currLastElem;
-               --next;
-            }
+         return get_element_as_pointer(idx);
+      }
 
-            ++m_LastElem;
+      // O(1) erase for when order does not matter: the last element is moved
+      // into pos. Returns pos, which now holds the former last element.
+      NTL_CONSTEXPR20 iterator erase_unordered(const_iterator pos)
+      {
+         assert(pos != cend());
 
-            *next = std::move(value);
-            return next;
-         }
-         else
+         size_type idx = pos - cbegin();
+         if (idx != size() - 1)
          {
-            throw std::runtime_error("No space available to insert");
+            (*this)[idx] = std::move(back());
+            this->get_stats().on_shift(1);
          }
+
+         pop_back();
+         return get_element_as_pointer(idx);
       }
 
-      template <typename ... Args>
-      iterator emplace(const_iterator pos, Args&&... args)
+      // Removes every element matching pred in a single pass, keeping the
+      // order of the rest, and returns how many were removed
+      template <typename Pred>
+      NTL_CONSTEXPR20 size_type remove_if(Pred pred)
       {
-         if (size() < capacity())
+         pointer firstRemoved = std::find_if(begin(), end(), std::ref(pred));
+         if (firstRemoved == end())
          {
-            iterator currLastElem = end();
-            iterator next = end();
-            --next;
+            return 0;
+         }
 
-            while (next != pos)
+         pointer newLast = firstRemoved;
+         for (pointer src = firstRemoved + 1; src != end(); ++src)
+         {
+            if (!pred(*src))
             {
-               std::iter_swap(currLastElem, next);
-               --currLastElem;
-               --next;
+               *newLast++ = std::move(*src);
             }
+         }
+
+         size_type count = end() - newLast;
+         this->get_stats().on_shift(newLast - firstRemoved);
+         destroy_range(newLast, end());
+         set_size(m_Size - count);
+         this->get_overflow().on_shrink(m_Size);
+         return count;
+      }
+
+      NTL_CONSTEXPR20 size_type remove(const T& value)
+      {
+         // Copied in case value is one of the elements being shifted down
+         value_type tmp(value);
+         return remove_if([&tmp](const T& elem) { return elem == tmp; });
+      }
+
+      NTL_CONSTEXPR20 iterator find(const T& value) noexcept
+      {
+         return begin() + detail::find_n(data(), size(), value);
+      }
+
+      NTL_CONSTEXPR20 const_iterator find(const T& value) const noexcept
+      {
+         return begin() + detail::find_n(data(), size(), value);
+      }
 
-            std::iter_swap(currLastElem, next);
-            ++m_LastElem;
+      NTL_CONSTEXPR20 size_type count(const T& value) const noexcept
+      {
+         return detail::count_n(data(), size(), value);
+      }
+
+      NTL_CONSTEXPR20 bool contains(const T& value) const noexcept
+      {
+         return find(value) != end();
+      }
+
+      NTL_CONSTEXPR20 bool operator == (const bounded_vector& rhs) const noexcept
+      {
+         return size() == rhs.size()
+            && detail::mismatch_n(data(), rhs.data(), size()) == size();
+      }
 
-            std::allocator_traits<allocator_type>::construct(m_Alloc, &(*next), std::forward<Args>(args)...);
-            return next;
+      NTL_CONSTEXPR20 bool operator != (const bounded_vector& rhs) const noexcept
+      {
+         return !(*this == rhs);
+      }
+
+#if defined(__cpp_lib_three_way_comparison)
+      template <typename U = T>
+      NTL_CONSTEXPR20 detail::synth_three_way_result_t<U> operator <=> (const bounded_vector& rhs) const
+      {
+         size_type common = std::min(size(), rhs.size());
+         size_type idx = detail::mismatch_n(data(), rhs.data(), common);
+         if (idx != common)
+         {
+            return detail::synth_three_way()((*this)[idx], rhs[idx]);
          }
-         else
+
+         return size() <=> rhs.size();
+      }
+#else
+      NTL_CONSTEXPR20 bool operator < (const bounded_vector& rhs) const
+      {
+         size_type common = std::min(size(), rhs.size());
+         size_type idx = detail::mismatch_n(data(), rhs.data(), common);
+         if (idx != common)
          {
-            throw std::runtime_error("No space available to insert");
+            return (*this)[idx] < rhs[idx];
          }
+
+         return size() < rhs.size();
       }
 
-      iterator erase(const_iterator pos)
+      NTL_CONSTEXPR20 bool operator > (const bounded_vector& rhs) const
       {
-         assert(pos != end());
+         return rhs < *this;
+      }
 
-         const_iterator target = pos;
+      NTL_CONSTEXPR20 bool operator <= (const bounded_vector& rhs) const
+      {
+         return !(rhs < *this);
+      }
 
-         T* elem = &(const_cast<T&>(*target));
-         iterator mutableTarget(elem);
-         iterator next(mutableTarget);
-         iterator ret = next;
-         ++next;
+      NTL_CONSTEXPR20 bool operator >= (const bounded_vector& rhs) const
+      {
+         return !(*this < rhs);
+      }
+#endif
 
-         while (next != end())
+   private:
+      using base_type::m_Size;
+      using base_type::get_element_as_pointer;
+      using base_type::set_size;
+      using base_type::destroy_range;
+
+      // How many of count more elements to insert: all of them when they
+      // fit, otherwise what the overflow policy allows
+      NTL_CONSTEXPR20 size_type room_for(size_type count, const char* msg)
+      {
+         if (!overflow_policy_type::check_capacity)
          {
-            std::iter_swap(mutableTarget, next);
-            ++mutableTarget;
-            ++next;
+            assert(count <= capacity() - size());
+            return count;
          }
 
-         std::iter_swap(mutableTarget, next);
-         pop_back();
+         size_type room = capacity() - size();
+         if (count <= room)
+         {
+            return count;
+         }
+
+         this->get_stats().on_overflow(count - room);
+         return this->get_overflow().on_full_insert(msg, count, room);
+      }
 
-         return ret;
+      template <typename ... Args>
+      NTL_CONSTEXPR20 void append(const char* msg, Args&&... args)
+      {
+         if (!overflow_policy_type::check_capacity || size() < capacity())
+         {
+            unchecked_emplace_back(std::forward<Args>(args)...);
+         }
+         else
+         {
+            this->get_stats().on_overflow(1);
+            this->get_overflow().on_full_append(*this, msg, std::forward<Args>(args)...);
+         }
       }
 
-      iterator erase(const_iterator first, const_iterator last)
+      template <typename ForwardIt>
+      NTL_CONSTEXPR20 iterator insert_range(size_type idx, ForwardIt first, ForwardIt last, std::forward_iterator_tag)
       {
-         iterator ret = last;
-         if (first != last)
+         size_type count = std::distance(first, last);
+         size_type fitting = room_for(count, "No space available to insert");
+         if (fitting == 0 && count > 0)
          {
-            assert(first != end());
-            assert(last != end());
+            return end();
+         }
 
-            auto numElemsInRange = std::distance(first, last);
-            iterator next = last;
-            ++next;
-            while (next != end())
+         if (fitting > 0)
+         {
+            insert_n(idx, fitting, [this, &first](pointer dst)
             {
-               std::iter_swap(first, next);
+               std::allocator_traits<allocator_type>::construct(this->get_alloc(), dst, *first);
                ++first;
-               ++next;
-            }
-
-            for (auto i = 0; i < numElemsInRange; ++i)
-            {
-               pop_back();
-            }
+            });
          }
 
-         return ret;
+         return get_element_as_pointer(idx);
       }
 
-      bool operator == (const bounded_vector& rhs) const noexcept
+      template <typename InputIt>
+      NTL_CONSTEXPR20 iterator insert_range(size_type idx, InputIt first, InputIt last, std::input_iterator_tag)
       {
-         bool isEqual = true;
-         if (size() == rhs.size())
+         // Single pass input cannot be counted up front, so append and rotate into place
+         size_type oldSize = size();
+         for (; first != last; ++first)
          {
-            auto thisItr = begin();
-            auto rhsItr = rhs.begin();
+            emplace_back(*first);
+         }
 
-            while (thisItr != end()
-               && rhsItr != rhs.end())
-            {
-               if (*thisItr != *rhsItr)
-               {
-                  isEqual = false;
-                  break;
-               }
+         this->get_stats().on_shift(oldSize - idx);
+         std::rotate(get_element_as_pointer(idx), get_element_as_pointer(oldSize), get_element_as_pointer(m_Size));
+         return get_element_as_pointer(idx);
+      }
 
-               ++thisItr;
-               ++rhsItr;
+      NTL_CONSTEXPR20 void reset()
+      {
+         destroy_range(get_element_as_pointer(0), get_element_as_pointer(m_Size));
+         m_Size = 0;
+         this->get_overflow().on_shrink(0);
+      }
+
+      // Constructs elements up to count from args, all or none
+      template <typename ... Args>
+      NTL_CONSTEXPR20 void grow_to(size_type count, const Args&... args)
+      {
+         pointer first = get_element_as_pointer(m_Size);
+         pointer last = get_element_as_pointer(count);
+         pointer elem = first;
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            for (; elem != last; ++elem)
+            {
+               std::allocator_traits<allocator_type>::construct(this->get_alloc(), elem, args...);
             }
          }
-         else
+         catch (...)
          {
-            isEqual = false;
+            destroy_range(first, elem);
+            throw;
          }
+#else
+         for (; elem != last; ++elem)
+         {
+            std::allocator_traits<allocator_type>::construct(this->get_alloc(), elem, args...);
+         }
+#endif
 
-         return isEqual;
+         set_size(count);
+         this->get_stats().on_size(m_Size);
       }
 
-      bool operator != (const bounded_vector& rhs) const noexcept
+      // Destroys the elements past count; false if there is nothing to grow
+      NTL_CONSTEXPR20 bool shrink_to(size_type count)
       {
-         return !(*this == rhs);
-      }
+         if (count <= size())
+         {
+            if (count < size())
+            {
+               destroy_range(get_element_as_pointer(count), get_element_as_pointer(m_Size));
+               set_size(count);
+               this->get_overflow().on_shrink(m_Size);
+            }
 
-   private:
-      pointer get_element_as_pointer(std::size_t idx) noexcept
-      {
-         return reinterpret_cast<pointer>(&m_Elems[idx]);
+            return false;
+         }
+
+         return true;
       }
 
-      const_pointer get_element_as_pointer(std::size_t idx) const noexcept
+      // Constructs count elements at idx through build(slot); the size only
+      // grows once all of them are built
+      template <typename Build>
+      NTL_CONSTEXPR20 void insert_n(size_type idx, size_type count, Build&& build)
       {
-         return reinterpret_cast<const_pointer>(&m_Elems[idx]);
+         this->get_stats().on_shift(m_Size - idx);
+         detail::insert_gap(this->get_alloc(), get_element_as_pointer(idx), get_element_as_pointer(m_Size), count, build,
+            [this, count]()
+            {
+               set_size(m_Size + count);
+               this->get_stats().on_size(m_Size);
+            });
       }
 
-      void reset()
+      NTL_CONSTEXPR20 void close_gap(size_type idx, size_type count)
       {
-         while (end() != begin())
-         {
-            pop_back();
-         }
+         this->get_stats().on_shift(m_Size - idx - count);
+         detail::close_gap(this->get_alloc(), get_element_as_pointer(idx), get_element_as_pointer(m_Size), count);
+         set_size(m_Size - count);
+         this->get_overflow().on_shrink(m_Size);
       }
+   };
 
-      allocator_type m_Alloc;
-      pointer m_LastElem;
+   template <typename T, std::size_t MaxElems, typename Allocator, typename OverflowPolicy, typename StatsPolicy, typename Layout, typename U>
+   NTL_CONSTEXPR20 std::size_t erase(bounded_vector<T, MaxElems, Allocator, OverflowPolicy, StatsPolicy, Layout>& c, const U& value)
+   {
+      return c.remove_if([&value](const T& elem) { return elem == value; });
+   }
 
-      std::aligned_storage_t<sizeof(T), alignof(T)> m_Elems[MaxElems];
-   };
+   template <typename T, std::size_t MaxElems, typename Allocator, typename OverflowPolicy, typename StatsPolicy, typename Layout, typename Pred>
+   NTL_CONSTEXPR20 std::size_t erase_if(bounded_vector<T, MaxElems, Allocator, OverflowPolicy, StatsPolicy, Layout>& c, Pred pred)
+   {
+      return c.remove_if(pred);
+   }
 }
@@ -0,0 +1,349 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   // Append-only vector over fixed inline storage that any number of threads
+   // may append to and read from concurrently without locks. An append
+   // reserves a slot with one fetch_add, constructs the element in place and
+   // then publishes it with a release store on the slot's state. Slots are
+   // published in whatever order their producers finish, so readers see the
+   // published prefix: the leading run of finished slots, every one of which
+   // stays valid and unchanged for the life of the vector (until clear()).
+   //
+   // If a constructor throws, its slot is abandoned rather than published.
+   // It still counts toward the prefix so that later slots are not held
+   // back, and iteration skips it.
+   template <typename T, std::size_t Capacity>
+   class concurrent_bounded_vector
+   {
+      enum slot_state : std::uint8_t
+      {
+         slot_reserved = 0,
+         slot_published = 1,
+         slot_abandoned = 2
+      };
+
+      struct cell
+      {
+         std::atomic<std::uint8_t> m_State;
+         std::aligned_storage_t<sizeof(T), alignof(T)> m_Storage;
+
+         T* get_element_as_pointer() noexcept
+         {
+            return reinterpret_cast<T*>(&m_Storage);
+         }
+
+         const T* get_element_as_pointer() const noexcept
+         {
+            return reinterpret_cast<const T*>(&m_Storage);
+         }
+      };
+
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type&;
+      using const_reference = const value_type&;
+      using pointer = value_type*;
+      using const_pointer = const value_type*;
+
+      // Forward iterator over a range of settled slots that steps over
+      // abandoned ones
+      class const_iterator
+      {
+      public:
+         using iterator_category = std::forward_iterator_tag;
+         using value_type = T;
+         using difference_type = std::ptrdiff_t;
+         using pointer = const T*;
+         using reference = const T&;
+
+         const_iterator() noexcept = default;
+
+         const_iterator(const cell* pos, const cell* last) noexcept :
+            m_Pos(pos),
+            m_Last(last)
+         {
+            skip_abandoned();
+         }
+
+         reference operator * () const noexcept
+         {
+            return *m_Pos->get_element_as_pointer();
+         }
+
+         pointer operator -> () const noexcept
+         {
+            return m_Pos->get_element_as_pointer();
+         }
+
+         const_iterator& operator ++ () noexcept
+         {
+            ++m_Pos;
+            skip_abandoned();
+            return *this;
+         }
+
+         const_iterator operator ++ (int) noexcept
+         {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+         }
+
+         bool operator == (const const_iterator& rhs) const noexcept
+         {
+            return m_Pos == rhs.m_Pos;
+         }
+
+         bool operator != (const const_iterator& rhs) const noexcept
+         {
+            return m_Pos != rhs.m_Pos;
+         }
+
+      private:
+         void skip_abandoned() noexcept
+         {
+            // Relaxed suffices: the prefix scan that produced m_Last already
+            // acquired every slot in the range
+            while (m_Pos != m_Last && m_Pos->m_State.load(std::memory_order_relaxed) == slot_abandoned)
+            {
+               ++m_Pos;
+            }
+         }
+
+         const cell* m_Pos = nullptr;
+         const cell* m_Last = nullptr;
+      };
+
+      // The published prefix as of the call that produced it; later appends
+      // do not show up in an existing view
+      class published_view
+      {
+      public:
+         published_view(const cell* first, const cell* last) noexcept :
+            m_First(first),
+            m_Last(last)
+         {
+         }
+
+         const_iterator begin() const noexcept
+         {
+            return const_iterator(m_First, m_Last);
+         }
+
+         const_iterator end() const noexcept
+         {
+            return const_iterator(m_Last, m_Last);
+         }
+
+         // Slots in the view, abandoned ones included
+         size_type slot_count() const noexcept
+         {
+            return static_cast<size_type>(m_Last - m_First);
+         }
+
+      private:
+         const cell* m_First;
+         const cell* m_Last;
+      };
+
+      concurrent_bounded_vector() noexcept :
+         m_Reserved(0),
+         m_PublishedHint(0)
+      {
+         for (cell& c : m_Cells)
+         {
+            c.m_State.store(slot_reserved, std::memory_order_relaxed);
+         }
+      }
+
+      concurrent_bounded_vector(const concurrent_bounded_vector&) = delete;
+      concurrent_bounded_vector& operator = (const concurrent_bounded_vector&) = delete;
+
+      ~concurrent_bounded_vector()
+      {
+         destroy_published();
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return Capacity;
+      }
+
+      // Reserved slots, published or not
+      size_type size() const noexcept
+      {
+         size_type reserved = m_Reserved.load(std::memory_order_acquire);
+         return reserved < Capacity ? reserved : Capacity;
+      }
+
+      bool empty() const noexcept
+      {
+         return size() == 0;
+      }
+
+      bool full() const noexcept
+      {
+         return size() == capacity();
+      }
+
+      void push_back(const T& elem)
+      {
+         emplace_back(elem);
+      }
+
+      void push_back(T&& elem)
+      {
+         emplace_back(std::move(elem));
+      }
+
+      template <typename ... Args>
+      reference emplace_back(Args&&... args)
+      {
+         pointer elem = try_emplace_back(std::forward<Args>(args)...);
+         if (elem == nullptr)
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to emplace_back");
+         }
+
+         return *elem;
+      }
+
+      pointer try_push_back(const T& elem)
+      {
+         return try_emplace_back(elem);
+      }
+
+      pointer try_push_back(T&& elem)
+      {
+         return try_emplace_back(std::move(elem));
+      }
+
+      // Returns nullptr when full. The element may be read through the
+      // returned pointer by this thread only; other threads see it once it
+      // is in the published prefix.
+      template <typename ... Args>
+      pointer try_emplace_back(Args&&... args)
+      {
+         // Once full, stop bumping the counter so that it cannot run away
+         if (m_Reserved.load(std::memory_order_relaxed) >= Capacity)
+         {
+            return nullptr;
+         }
+
+         size_type idx = m_Reserved.fetch_add(1, std::memory_order_relaxed);
+         if (idx >= Capacity)
+         {
+            return nullptr;
+         }
+
+         cell& c = m_Cells[idx];
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            ::new (static_cast<void*>(c.get_element_as_pointer())) T(std::forward<Args>(args)...);
+         }
+         catch (...)
+         {
+            c.m_State.store(slot_abandoned, std::memory_order_release);
+            throw;
+         }
+#else
+         ::new (static_cast<void*>(c.get_element_as_pointer())) T(std::forward<Args>(args)...);
+#endif
+
+         c.m_State.store(slot_published, std::memory_order_release);
+         return c.get_element_as_pointer();
+      }
+
+      // Length of the published prefix. Amortized O(1): the scan resumes
+      // from the longest prefix any caller has seen.
+      size_type published_size() const noexcept
+      {
+         size_type pos = m_PublishedHint.load(std::memory_order_acquire);
+         size_type last = size();
+         while (pos < last && m_Cells[pos].m_State.load(std::memory_order_acquire) != slot_reserved)
+         {
+            ++pos;
+         }
+
+         size_type hint = m_PublishedHint.load(std::memory_order_relaxed);
+         while (hint < pos && !m_PublishedHint.compare_exchange_weak(hint, pos, std::memory_order_release, std::memory_order_relaxed))
+         {
+         }
+
+         return pos;
+      }
+
+      published_view published() const noexcept
+      {
+         return published_view(m_Cells, m_Cells + published_size());
+      }
+
+      bool is_published(size_type pos) const noexcept
+      {
+         return pos < capacity() && m_Cells[pos].m_State.load(std::memory_order_acquire) == slot_published;
+      }
+
+      // nullptr while slot pos is unreserved, under construction or abandoned
+      const_pointer try_get(size_type pos) const noexcept
+      {
+         return is_published(pos) ? m_Cells[pos].get_element_as_pointer() : nullptr;
+      }
+
+      // The caller has seen is_published(pos)
+      const_reference operator [](size_type pos) const noexcept
+      {
+         assert(is_published(pos));
+
+         return *m_Cells[pos].get_element_as_pointer();
+      }
+
+      // Not thread safe: no other thread may append or read meanwhile
+      void clear() noexcept
+      {
+         destroy_published();
+         size_type count = size();
+         for (size_type i = 0; i < count; ++i)
+         {
+            m_Cells[i].m_State.store(slot_reserved, std::memory_order_relaxed);
+         }
+
+         m_Reserved.store(0, std::memory_order_relaxed);
+         m_PublishedHint.store(0, std::memory_order_release);
+      }
+
+   private:
+      void destroy_published() noexcept
+      {
+         if (!std::is_trivially_destructible<T>::value)
+         {
+            size_type count = size();
+            for (size_type i = 0; i < count; ++i)
+            {
+               if (m_Cells[i].m_State.load(std::memory_order_acquire) == slot_published)
+               {
+                  m_Cells[i].get_element_as_pointer()->~T();
+               }
+            }
+         }
+      }
+
+      alignas(cache_line_size) std::atomic<size_type> m_Reserved;
+      alignas(cache_line_size) mutable std::atomic<size_type> m_PublishedHint;
+      alignas(cache_line_size) cell m_Cells[Capacity];
+   };
+}
@@ -0,0 +1,242 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <thread>
+
+#include "stats_policy.h"
+
+namespace ntl
+{
+   namespace stats
+   {
+      class tracked;
+   }
+
+   namespace detail
+   {
+      // Guarded by a spin lock rather than std::mutex: linking and unlinking
+      // run in noexcept constructors and destructors, and std::mutex::lock()
+      // may throw std::system_error
+      struct stats_registry
+      {
+         std::atomic_flag m_Busy = ATOMIC_FLAG_INIT;
+         stats::tracked* m_Head = nullptr;
+      };
+
+      class stats_registry_lock
+      {
+      public:
+         explicit stats_registry_lock(stats_registry& r) noexcept :
+            m_Registry(r)
+         {
+            while (m_Registry.m_Busy.test_and_set(std::memory_order_acquire))
+            {
+               std::this_thread::yield();
+            }
+         }
+
+         stats_registry_lock(const stats_registry_lock&) = delete;
+         stats_registry_lock& operator = (const stats_registry_lock&) = delete;
+
+         ~stats_registry_lock()
+         {
+            m_Registry.m_Busy.clear(std::memory_order_release);
+         }
+
+      private:
+         stats_registry& m_Registry;
+      };
+
+      inline stats_registry& get_stats_registry() noexcept
+      {
+         static stats_registry s_Registry;
+         return s_Registry;
+      }
+   }
+
+   namespace stats
+   {
+      // Counts high-water mark, overflow rejections and shifted elements,
+      // and links itself into a process-wide registry for as long as the
+      // container lives, so capacities can be sized from real data.
+      // A copy or move starts with the source's high-water mark (an upper
+      // bound on what it holds) and fresh event counters.
+      // The counters themselves are as thread-safe as the container: read
+      // them through for_each_instance() or dump() from a quiescent point.
+      class tracked
+      {
+      public:
+         static constexpr bool enabled = true;
+
+         tracked(std::size_t capacity, std::size_t elemSize) noexcept :
+            m_Capacity(capacity),
+            m_ElemSize(elemSize)
+         {
+            link();
+         }
+
+         tracked(const tracked& rhs) noexcept :
+            m_Name(rhs.m_Name),
+            m_Capacity(rhs.m_Capacity),
+            m_ElemSize(rhs.m_ElemSize),
+            m_HighWater(rhs.m_HighWater)
+         {
+            link();
+         }
+
+         tracked& operator = (const tracked& rhs) noexcept
+         {
+            m_HighWater = std::max(m_HighWater, rhs.m_HighWater);
+            return *this;
+         }
+
+         ~tracked()
+         {
+            unlink();
+         }
+
+         void on_size(std::size_t size) noexcept
+         {
+            m_HighWater = std::max(m_HighWater, size);
+         }
+
+         void on_overflow(std::size_t count) noexcept
+         {
+            m_Overflows += count;
+         }
+
+         void on_shift(std::size_t count) noexcept
+         {
+            m_Shifted += count;
+         }
+
+         // name must outlive the container; a string literal is typical
+         void set_name(const char* name) noexcept
+         {
+            m_Name = name;
+         }
+
+         const char* name() const noexcept
+         {
+            return m_Name;
+         }
+
+         std::size_t capacity() const noexcept
+         {
+            return m_Capacity;
+         }
+
+         std::size_t element_size() const noexcept
+         {
+            return m_ElemSize;
+         }
+
+         std::size_t high_water() const noexcept
+         {
+            return m_HighWater;
+         }
+
+         std::size_t overflows() const noexcept
+         {
+            return m_Overflows;
+         }
+
+         std::size_t shifted() const noexcept
+         {
+            return m_Shifted;
+         }
+
+         // Bytes that sizing the container to its high-water mark would save
+         std::size_t unused_bytes() const noexcept
+         {
+            return (m_Capacity - m_HighWater) * m_ElemSize;
+         }
+
+         void reset() noexcept
+         {
+            m_HighWater = 0;
+            m_Overflows = 0;
+            m_Shifted = 0;
+         }
+
+      private:
+         template <typename Func>
+         friend void for_each_instance(Func func);
+
+         void link() noexcept
+         {
+            detail::stats_registry& r = detail::get_stats_registry();
+            detail::stats_registry_lock lock(r);
+            m_Next = r.m_Head;
+            if (m_Next != nullptr)
+            {
+               m_Next->m_Prev = this;
+            }
+
+            r.m_Head = this;
+         }
+
+         void unlink() noexcept
+         {
+            detail::stats_registry& r = detail::get_stats_registry();
+            detail::stats_registry_lock lock(r);
+            if (m_Prev != nullptr)
+            {
+               m_Prev->m_Next = m_Next;
+            }
+            else
+            {
+               r.m_Head = m_Next;
+            }
+
+            if (m_Next != nullptr)
+            {
+               m_Next->m_Prev = m_Prev;
+            }
+         }
+
+         const char* m_Name = "unnamed";
+         std::size_t m_Capacity;
+         std::size_t m_ElemSize;
+         std::size_t m_HighWater = 0;
+         std::size_t m_Overflows = 0;
+         std::size_t m_Shifted = 0;
+         tracked* m_Prev = nullptr;
+         tracked* m_Next = nullptr;
+      };
+
+      // Calls func(const tracked&) for every live instrumented container.
+      // Containers must not be created or destroyed from inside func.
+      template <typename Func>
+      void for_each_instance(Func func)
+      {
+         detail::stats_registry& r = detail::get_stats_registry();
+         detail::stats_registry_lock lock(r);
+         for (const tracked* t = r.m_Head; t != nullptr; t = t->m_Next)
+         {
+            func(*t);
+         }
+      }
+
+      // One line per live instrumented container
+      inline void dump(std::FILE* out = stdout)
+      {
+         std::fprintf(out, "%-24s %10s %10s %10s %6s %10s %12s %12s\n",
+            "name", "capacity", "elem_size", "high_water", "used%", "overflows", "shifted", "unused_bytes");
+         for_each_instance([out](const tracked& t)
+         {
+            std::fprintf(out, "%-24s %10zu %10zu %10zu %5.1f%% %10zu %12zu %12zu\n",
+               t.name(),
+               t.capacity(),
+               t.element_size(),
+               t.high_water(),
+               t.capacity() == 0 ? 0.0 : 100.0 * t.high_water() / t.capacity(),
+               t.overflows(),
+               t.shifted(),
+               t.unused_bytes());
+         });
+      }
+   }
+}
@@ -0,0 +1,509 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      // CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320)
+      struct crc32_table
+      {
+         constexpr crc32_table() :
+            m_Entries()
+         {
+            for (std::uint32_t i = 0; i < 256; ++i)
+            {
+               std::uint32_t crc = i;
+               for (int bit = 0; bit < 8; ++bit)
+               {
+                  crc = (crc & 1) != 0 ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+               }
+
+               m_Entries[i] = crc;
+            }
+         }
+
+         std::uint32_t m_Entries[256];
+      };
+
+      // Continues a running CRC; start with crc = 0
+      inline std::uint32_t crc32(const void* data, std::size_t len, std::uint32_t crc = 0) noexcept
+      {
+         static constexpr crc32_table table;
+
+         const unsigned char* bytes = static_cast<const unsigned char*>(data);
+         crc = ~crc;
+         for (std::size_t i = 0; i < len; ++i)
+         {
+            crc = table.m_Entries[(crc ^ bytes[i]) & 0xFF] ^ (crc >> 8);
+         }
+
+         return ~crc;
+      }
+
+      // First bytes of a mapped_bounded_vector file. Every field has a fixed
+      // width and the elements are found by offset, so the file means the
+      // same thing at whatever address it is mapped. Fields are in native
+      // byte order; a file from a machine of the other endianness fails the
+      // magic check.
+      struct mapped_vector_header
+      {
+         std::uint64_t m_Magic;
+         std::uint32_t m_Version;
+         std::uint32_t m_ElemSize;
+         std::uint32_t m_ElemAlign;
+         std::uint32_t m_Checksum;
+         std::uint64_t m_Capacity;
+         std::uint64_t m_DataOffset;
+         std::uint64_t m_Size;
+      };
+
+      static_assert(sizeof(mapped_vector_header) == 48, "mapped_vector_header is part of the file format");
+   }
+
+   enum class map_mode
+   {
+      open_or_create,   // attach to the file, creating an empty one if missing
+      open_existing,    // attach to the file, which must exist
+      create            // start from an empty file, discarding any contents
+   };
+
+   // bounded_vector whose header and elements live in a MAP_SHARED mapping of
+   // a file. A restarted process attaches to the snapshot in O(1) instead of
+   // rebuilding it; every change is visible in the file through the page
+   // cache, and sync() makes it durable. POSIX only.
+   //
+   // The checksum covers the header and the live elements as of the last
+   // sync(). Attaching checks the layout fields only; verify() recomputes
+   // the checksum in O(size()) for callers that need to detect a snapshot
+   // torn by a crash between changes and sync().
+   template <typename T, std::size_t MaxElems>
+   class mapped_bounded_vector
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "mapped_bounded_vector requires trivially copyable elements");
+
+      using header_type = detail::mapped_vector_header;
+
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type&;
+      using const_reference = const value_type&;
+      using pointer = value_type*;
+      using const_pointer = const value_type*;
+      using iterator = pointer;
+      using const_iterator = const_pointer;
+      using reverse_iterator = std::reverse_iterator<iterator>;
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+      // "NTLMVEC\0" when stored little-endian
+      static constexpr std::uint64_t file_magic = 0x004345564D4C544Eull;
+      static constexpr std::uint32_t file_version = 1;
+
+      // The elements start on a cache line, or on alignof(T) if that is larger
+      static constexpr std::size_t data_offset = alignof(T) > cache_line_size ? alignof(T) : cache_line_size;
+      static constexpr std::size_t file_size = data_offset + sizeof(T) * MaxElems;
+
+      explicit mapped_bounded_vector(const char* path, map_mode mode = map_mode::open_or_create)
+      {
+         int flags = O_RDWR | O_CLOEXEC;
+         if (mode == map_mode::open_or_create)
+         {
+            flags |= O_CREAT;
+         }
+         else if (mode == map_mode::create)
+         {
+            flags |= O_CREAT | O_TRUNC;
+         }
+
+         m_Fd = ::open(path, flags, 0644);
+         if (m_Fd < 0)
+         {
+            detail::throw_or_abort<std::runtime_error>("Cannot open mapped_bounded_vector file");
+         }
+
+         struct stat st;
+         if (::fstat(m_Fd, &st) != 0)
+         {
+            fail("Cannot open mapped_bounded_vector file");
+         }
+
+         bool fresh = st.st_size == 0;
+         if (fresh)
+         {
+            if (::ftruncate(m_Fd, static_cast<off_t>(file_size)) != 0)
+            {
+               fail("Cannot size mapped_bounded_vector file");
+            }
+         }
+         else if (static_cast<std::uint64_t>(st.st_size) != file_size)
+         {
+            fail("mapped_bounded_vector file has a different layout");
+         }
+
+         void* map = ::mmap(nullptr, file_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_Fd, 0);
+         if (map == MAP_FAILED)
+         {
+            fail("Cannot map mapped_bounded_vector file");
+         }
+
+         m_Map = static_cast<unsigned char*>(map);
+         if (fresh)
+         {
+            header_type& h = header();
+            h.m_Magic = file_magic;
+            h.m_Version = file_version;
+            h.m_ElemSize = sizeof(T);
+            h.m_ElemAlign = alignof(T);
+            h.m_Capacity = MaxElems;
+            h.m_DataOffset = data_offset;
+            h.m_Size = 0;
+            h.m_Checksum = compute_checksum();
+         }
+         else if (!layout_matches())
+         {
+            fail("mapped_bounded_vector file has a different layout");
+         }
+      }
+
+      mapped_bounded_vector(mapped_bounded_vector&& rhs) noexcept :
+         m_Fd(rhs.m_Fd),
+         m_Map(rhs.m_Map)
+      {
+         rhs.m_Fd = -1;
+         rhs.m_Map = nullptr;
+      }
+
+      mapped_bounded_vector& operator = (mapped_bounded_vector&& rhs) noexcept
+      {
+         if (this != &rhs)
+         {
+            release();
+            m_Fd = rhs.m_Fd;
+            m_Map = rhs.m_Map;
+            rhs.m_Fd = -1;
+            rhs.m_Map = nullptr;
+         }
+
+         return *this;
+      }
+
+      mapped_bounded_vector(const mapped_bounded_vector&) = delete;
+      mapped_bounded_vector& operator = (const mapped_bounded_vector&) = delete;
+
+      // Unmaps without syncing; the page cache still holds every change
+      ~mapped_bounded_vector()
+      {
+         release();
+      }
+
+      iterator begin() noexcept
+      {
+         return data();
+      }
+
+      const_iterator begin() const noexcept
+      {
+         return data();
+      }
+
+      const_iterator cbegin() const noexcept
+      {
+         return data();
+      }
+
+      iterator end() noexcept
+      {
+         return data() + size();
+      }
+
+      const_iterator end() const noexcept
+      {
+         return data() + size();
+      }
+
+      const_iterator cend() const noexcept
+      {
+         return data() + size();
+      }
+
+      reverse_iterator rbegin() noexcept
+      {
+         return reverse_iterator(end());
+      }
+
+      const_reverse_iterator rbegin() const noexcept
+      {
+         return const_reverse_iterator(cend());
+      }
+
+      reverse_iterator rend() noexcept
+      {
+         return reverse_iterator(begin());
+      }
+
+      const_reverse_iterator rend() const noexcept
+      {
+         return const_reverse_iterator(cbegin());
+      }
+
+      pointer data() noexcept
+      {
+         return reinterpret_cast<pointer>(m_Map + data_offset);
+      }
+
+      const_pointer data() const noexcept
+      {
+         return reinterpret_cast<const_pointer>(m_Map + data_offset);
+      }
+
+      reference at(size_type pos)
+      {
+         if (pos >= size())
+         {
+            detail::throw_or_abort<std::out_of_range>("mapped_bounded_vector::at index out of range");
+         }
+
+         return data()[pos];
+      }
+
+      const_reference at(size_type pos) const
+      {
+         if (pos >= size())
+         {
+            detail::throw_or_abort<std::out_of_range>("mapped_bounded_vector::at index out of range");
+         }
+
+         return data()[pos];
+      }
+
+      reference operator [](size_type pos) noexcept
+      {
+         return data()[pos];
+      }
+
+      const_reference operator [](size_type pos) const noexcept
+      {
+         return data()[pos];
+      }
+
+      reference front() noexcept
+      {
+         return data()[0];
+      }
+
+      const_reference front() const noexcept
+      {
+         return data()[0];
+      }
+
+      reference back() noexcept
+      {
+         return data()[size() - 1];
+      }
+
+      const_reference back() const noexcept
+      {
+         return data()[size() - 1];
+      }
+
+      size_type size() const noexcept
+      {
+         return static_cast<size_type>(header().m_Size);
+      }
+
+      bool empty() const noexcept
+      {
+         return size() == 0;
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      constexpr size_type max_size() const noexcept
+      {
+         return capacity();
+      }
+
+      void push_back(const T& elem)
+      {
+         emplace_back(elem);
+      }
+
+      template <typename ... Args>
+      reference emplace_back(Args&&... args)
+      {
+         if (size() == capacity())
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to emplace_back");
+         }
+
+         pointer elem = ::new (static_cast<void*>(end())) T(std::forward<Args>(args)...);
+         ++header().m_Size;
+         return *elem;
+      }
+
+      // Returns nullptr instead of throwing when the vector is full
+      pointer try_push_back(const T& elem)
+      {
+         if (size() == capacity())
+         {
+            return nullptr;
+         }
+
+         return std::addressof(emplace_back(elem));
+      }
+
+      void pop_back() noexcept
+      {
+         assert(!empty());
+
+         --header().m_Size;
+      }
+
+      template <typename Range>
+      void append_range(const Range& range)
+      {
+         using std::begin;
+         using std::end;
+         size_type count = static_cast<size_type>(std::distance(begin(range), end(range)));
+         if (count > capacity() - size())
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to insert");
+         }
+
+         std::copy(begin(range), end(range), data() + size());
+         header().m_Size += count;
+      }
+
+      void resize(size_type count, const T& value = T())
+      {
+         if (count > capacity())
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to resize");
+         }
+
+         if (count > size())
+         {
+            std::uninitialized_fill(end(), data() + count, value);
+         }
+
+         header().m_Size = count;
+      }
+
+      // Zero-copy fill, as bounded_vector::append_uninitialized
+      span<T> append_uninitialized(size_type count)
+      {
+         if (count > capacity() - size())
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to append");
+         }
+
+         return span<T>(end(), count);
+      }
+
+      void commit_append(size_type count) noexcept
+      {
+         assert(count <= capacity() - size());
+
+         header().m_Size += count;
+      }
+
+      void clear() noexcept
+      {
+         header().m_Size = 0;
+      }
+
+      // Stores the checksum and blocks until the mapping is written back
+      void sync()
+      {
+         header().m_Checksum = compute_checksum();
+         if (::msync(m_Map, file_size, MS_SYNC) != 0)
+         {
+            detail::throw_or_abort<std::runtime_error>("Cannot sync mapped_bounded_vector file");
+         }
+      }
+
+      // True if the contents match the checksum stored by the last sync()
+      bool verify() const noexcept
+      {
+         return header().m_Checksum == compute_checksum();
+      }
+
+   private:
+      header_type& header() noexcept
+      {
+         return *reinterpret_cast<header_type*>(m_Map);
+      }
+
+      const header_type& header() const noexcept
+      {
+         return *reinterpret_cast<const header_type*>(m_Map);
+      }
+
+      bool layout_matches() const noexcept
+      {
+         const header_type& h = header();
+         return h.m_Magic == file_magic
+            && h.m_Version == file_version
+            && h.m_ElemSize == sizeof(T)
+            && h.m_ElemAlign == alignof(T)
+            && h.m_Capacity == MaxElems
+            && h.m_DataOffset == data_offset
+            && h.m_Size <= MaxElems;
+      }
+
+      // CRC-32 of the header with a zero checksum field, then of the live elements
+      std::uint32_t compute_checksum() const noexcept
+      {
+         header_type h = header();
+         h.m_Checksum = 0;
+         std::uint32_t crc = detail::crc32(&h, sizeof(h));
+         return detail::crc32(data(), size() * sizeof(T), crc);
+      }
+
+      [[noreturn]] void fail(const char* msg)
+      {
+         release();
+         detail::throw_or_abort<std::runtime_error>(msg);
+      }
+
+      void release() noexcept
+      {
+         if (m_Map != nullptr)
+         {
+            ::munmap(m_Map, file_size);
+            m_Map = nullptr;
+         }
+
+         if (m_Fd >= 0)
+         {
+            ::close(m_Fd);
+            m_Fd = -1;
+         }
+      }
+
+      int m_Fd = -1;
+      unsigned char* m_Map = nullptr;
+   };
+}
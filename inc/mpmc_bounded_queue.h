@@ -0,0 +1,378 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      inline void cpu_relax() noexcept
+      {
+#if NTL_SIMD_X86
+         _mm_pause();
+#endif
+      }
+
+      // Blocks while word == expected. Spurious wakeups are allowed.
+      inline void wait_on_word(std::atomic<std::uint32_t>& word, std::uint32_t expected) noexcept
+      {
+#if defined(__linux__)
+         syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#elif defined(__cpp_lib_atomic_wait)
+         word.wait(expected, std::memory_order_acquire);
+#else
+         if (word.load(std::memory_order_acquire) == expected)
+         {
+            std::this_thread::yield();
+         }
+#endif
+      }
+
+      inline void wake_all_on_word(std::atomic<std::uint32_t>& word) noexcept
+      {
+#if defined(__linux__)
+         syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#elif defined(__cpp_lib_atomic_wait)
+         word.notify_all();
+#else
+         (void)word;
+#endif
+      }
+
+      // Sleep/wake channel for one side of a queue. Waiters register before
+      // re-checking the queue and notifiers check for waiters after a seq_cst
+      // fence, so a wakeup cannot be lost between the two.
+      class wait_channel
+      {
+      public:
+         wait_channel() noexcept :
+            m_Epoch(0),
+            m_Waiters(0)
+         {
+         }
+
+         template <typename Predicate>
+         void wait_until(Predicate ready)
+         {
+            m_Waiters.fetch_add(1, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::uint32_t epoch = m_Epoch.load(std::memory_order_seq_cst);
+            if (!ready())
+            {
+               wait_on_word(m_Epoch, epoch);
+            }
+
+            m_Waiters.fetch_sub(1, std::memory_order_relaxed);
+         }
+
+         void notify() noexcept
+         {
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_Waiters.load(std::memory_order_relaxed) != 0)
+            {
+               m_Epoch.fetch_add(1, std::memory_order_seq_cst);
+               wake_all_on_word(m_Epoch);
+            }
+         }
+
+      private:
+         std::atomic<std::uint32_t> m_Epoch;
+         std::atomic<std::uint32_t> m_Waiters;
+      };
+   }
+
+   // Bounded multi-producer / multi-consumer queue over fixed inline storage
+   // (Dmitry Vyukov's design). Each slot carries a sequence number that says
+   // whether it is ready for the producer or the consumer of a given lap, so
+   // try_push and try_pop each cost one CAS on the shared position.
+   // push and pop block: they spin for SpinCount attempts, then sleep on a
+   // futex (or std::atomic::wait where futexes are unavailable).
+   //
+   // A producer whose constructor throws after claiming a slot marks it
+   // abandoned, and consumers step over it, so the queue keeps moving. If
+   // moving an element out throws, that element is destroyed and lost.
+   template <typename T, std::size_t Capacity, std::size_t SpinCount = 128>
+   class mpmc_bounded_queue
+   {
+      static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "mpmc_bounded_queue capacity must be a power of two");
+
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+
+      mpmc_bounded_queue() noexcept :
+         m_EnqueuePos(0),
+         m_DequeuePos(0)
+      {
+         for (size_type i = 0; i < Capacity; ++i)
+         {
+            m_Cells[i].m_Sequence.store(i, std::memory_order_relaxed);
+            m_Cells[i].m_Abandoned = false;
+         }
+      }
+
+      mpmc_bounded_queue(const mpmc_bounded_queue&) = delete;
+      mpmc_bounded_queue& operator = (const mpmc_bounded_queue&) = delete;
+
+      ~mpmc_bounded_queue()
+      {
+         size_type pos = m_DequeuePos.load(std::memory_order_relaxed);
+         size_type last = m_EnqueuePos.load(std::memory_order_relaxed);
+         for (; pos != last; ++pos)
+         {
+            cell& c = m_Cells[pos & s_Mask];
+            if (!c.m_Abandoned)
+            {
+               c.get_element_as_pointer()->~T();
+            }
+         }
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return Capacity;
+      }
+
+      // Approximate when producers or consumers are active
+      size_type size() const noexcept
+      {
+         size_type dequeuePos = m_DequeuePos.load(std::memory_order_relaxed);
+         size_type enqueuePos = m_EnqueuePos.load(std::memory_order_relaxed);
+         return enqueuePos > dequeuePos ? enqueuePos - dequeuePos : 0;
+      }
+
+      bool try_push(const T& elem)
+      {
+         return try_emplace(elem);
+      }
+
+      bool try_push(T&& elem)
+      {
+         return try_emplace(std::move(elem));
+      }
+
+      template <typename ... Args>
+      bool try_emplace(Args&&... args)
+      {
+         if (try_emplace_no_notify(std::forward<Args>(args)...))
+         {
+            m_NotEmpty.notify();
+            return true;
+         }
+
+         return false;
+      }
+
+      bool try_pop(T& out)
+      {
+         if (try_pop_no_notify(out))
+         {
+            m_NotFull.notify();
+            return true;
+         }
+
+         return false;
+      }
+
+      void push(const T& elem)
+      {
+         emplace(elem);
+      }
+
+      void push(T&& elem)
+      {
+         emplace(std::move(elem));
+      }
+
+      template <typename ... Args>
+      void emplace(Args&&... args)
+      {
+         // Build the value once so that retries do not re-run the constructor
+         T elem(std::forward<Args>(args)...);
+         for (;;)
+         {
+            for (size_type spin = 0; spin < SpinCount; ++spin)
+            {
+               if (try_push(std::move(elem)))
+               {
+                  return;
+               }
+
+               detail::cpu_relax();
+            }
+
+            m_NotFull.wait_until([this] { return !full(); });
+         }
+      }
+
+      void pop(T& out)
+      {
+         for (;;)
+         {
+            for (size_type spin = 0; spin < SpinCount; ++spin)
+            {
+               if (try_pop(out))
+               {
+                  return;
+               }
+
+               detail::cpu_relax();
+            }
+
+            m_NotEmpty.wait_until([this] { return !empty(); });
+         }
+      }
+
+      bool empty() const noexcept
+      {
+         size_type pos = m_DequeuePos.load(std::memory_order_relaxed);
+         const cell& c = m_Cells[pos & s_Mask];
+         return static_cast<std::ptrdiff_t>(c.m_Sequence.load(std::memory_order_acquire) - (pos + 1)) < 0;
+      }
+
+      bool full() const noexcept
+      {
+         size_type pos = m_EnqueuePos.load(std::memory_order_relaxed);
+         const cell& c = m_Cells[pos & s_Mask];
+         return static_cast<std::ptrdiff_t>(c.m_Sequence.load(std::memory_order_acquire) - pos) < 0;
+      }
+
+   private:
+      static constexpr size_type s_Mask = Capacity - 1;
+
+      struct cell
+      {
+         std::atomic<size_type> m_Sequence;
+
+         // Set by a producer whose constructor threw; published by m_Sequence
+         bool m_Abandoned;
+         std::aligned_storage_t<sizeof(T), alignof(T)> m_Storage;
+
+         T* get_element_as_pointer() noexcept
+         {
+            return reinterpret_cast<T*>(&m_Storage);
+         }
+      };
+
+      template <typename ... Args>
+      bool try_emplace_no_notify(Args&&... args)
+      {
+         size_type pos = m_EnqueuePos.load(std::memory_order_relaxed);
+         for (;;)
+         {
+            cell& c = m_Cells[pos & s_Mask];
+            size_type seq = c.m_Sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0)
+            {
+               if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+               {
+#if NTL_HAS_EXCEPTIONS
+                  try
+                  {
+                     ::new (static_cast<void*>(c.get_element_as_pointer())) T(std::forward<Args>(args)...);
+                  }
+                  catch (...)
+                  {
+                     // The slot is claimed and cannot be handed back; pass it
+                     // to the consumers empty so they can step over it
+                     c.m_Abandoned = true;
+                     c.m_Sequence.store(pos + 1, std::memory_order_release);
+                     m_NotEmpty.notify();
+                     throw;
+                  }
+#else
+                  ::new (static_cast<void*>(c.get_element_as_pointer())) T(std::forward<Args>(args)...);
+#endif
+
+                  c.m_Sequence.store(pos + 1, std::memory_order_release);
+                  return true;
+               }
+            }
+            else if (diff < 0)
+            {
+               return false;
+            }
+            else
+            {
+               pos = m_EnqueuePos.load(std::memory_order_relaxed);
+            }
+         }
+      }
+
+      bool try_pop_no_notify(T& out)
+      {
+         size_type pos = m_DequeuePos.load(std::memory_order_relaxed);
+         for (;;)
+         {
+            cell& c = m_Cells[pos & s_Mask];
+            size_type seq = c.m_Sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0)
+            {
+               if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+               {
+                  if (c.m_Abandoned)
+                  {
+                     // Recycle the slot and try the next one. A producer may
+                     // be waiting for exactly this slot to free up.
+                     c.m_Abandoned = false;
+                     c.m_Sequence.store(pos + Capacity, std::memory_order_release);
+                     m_NotFull.notify();
+                     pos = m_DequeuePos.load(std::memory_order_relaxed);
+                     continue;
+                  }
+
+                  T* elem = c.get_element_as_pointer();
+#if NTL_HAS_EXCEPTIONS
+                  try
+                  {
+                     out = std::move(*elem);
+                  }
+                  catch (...)
+                  {
+                     elem->~T();
+                     c.m_Sequence.store(pos + Capacity, std::memory_order_release);
+                     m_NotFull.notify();
+                     throw;
+                  }
+#else
+                  out = std::move(*elem);
+#endif
+
+                  elem->~T();
+                  c.m_Sequence.store(pos + Capacity, std::memory_order_release);
+                  return true;
+               }
+            }
+            else if (diff < 0)
+            {
+               return false;
+            }
+            else
+            {
+               pos = m_DequeuePos.load(std::memory_order_relaxed);
+            }
+         }
+      }
+
+      alignas(cache_line_size) std::atomic<size_type> m_EnqueuePos;
+      alignas(cache_line_size) std::atomic<size_type> m_DequeuePos;
+      alignas(cache_line_size) detail::wait_channel m_NotEmpty;
+      alignas(cache_line_size) detail::wait_channel m_NotFull;
+      alignas(cache_line_size) cell m_Cells[Capacity];
+   };
+}
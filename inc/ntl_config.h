@@ -0,0 +1,34 @@
+#pragma once
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<version>)
+#include <version>
+#endif
+#endif
+
+// Under C++20 the containers are usable during constant evaluation: that
+// needs std::construct_at, constexpr destructors and a way to steer around
+// memcpy, SIMD and other runtime-only code paths while evaluating.
+#if defined(__cpp_lib_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated)
+#define NTL_CONSTEXPR_CONTAINERS 1
+#define NTL_CONSTEXPR20 constexpr
+#else
+#define NTL_CONSTEXPR_CONTAINERS 0
+#define NTL_CONSTEXPR20
+#endif
+
+namespace ntl
+{
+   namespace detail
+   {
+      constexpr bool is_constant_evaluated() noexcept
+      {
+#if NTL_CONSTEXPR_CONTAINERS
+         return std::is_constant_evaluated();
+#else
+         return false;
+#endif
+      }
+   }
+}
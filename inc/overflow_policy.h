@@ -0,0 +1,177 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <stdexcept>
+#include <utility>
+
+#include "ntl_config.h"
+
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define NTL_HAS_EXCEPTIONS 1
+#else
+#define NTL_HAS_EXCEPTIONS 0
+#endif
+
+namespace ntl
+{
+   namespace detail
+   {
+      // With exceptions disabled a failed check is fatal instead of throwing.
+      template <typename Exception>
+      [[noreturn]] NTL_CONSTEXPR20 void throw_or_abort(const char* msg)
+      {
+#if NTL_HAS_EXCEPTIONS
+         throw Exception(msg);
+#else
+         (void)msg;
+         assert(!"ntl container check failed");
+         std::abort();
+#endif
+      }
+   }
+
+   // Compile-time choice of what a fixed-capacity container does when an
+   // insertion does not fit. Each policy provides:
+   //   check_capacity           - false skips the runtime check entirely
+   //   on_full_append(c, ...)   - a single element append hit a full container
+   //   on_full_insert(n, room)  - n elements did not fit in room free slots;
+   //                              returns how many of them to insert, at most room
+   //   on_shrink(size)          - the container dropped to size elements
+   namespace overflow
+   {
+      // Throws std::runtime_error (or aborts under -fno-exceptions)
+      struct throw_error
+      {
+         static constexpr bool check_capacity = true;
+
+         template <typename Container, typename ... Args>
+         NTL_CONSTEXPR20 void on_full_append(Container&, const char* msg, Args&&...)
+         {
+            detail::throw_or_abort<std::runtime_error>(msg);
+         }
+
+         NTL_CONSTEXPR20 std::size_t on_full_insert(const char* msg, std::size_t, std::size_t)
+         {
+            detail::throw_or_abort<std::runtime_error>(msg);
+         }
+
+         NTL_CONSTEXPR20 void on_shrink(std::size_t) noexcept
+         {
+         }
+      };
+
+      // Debug builds assert, release builds do no check at all
+      struct assert_only
+      {
+         static constexpr bool check_capacity = false;
+
+         template <typename Container, typename ... Args>
+         void on_full_append(Container&, const char*, Args&&...) noexcept
+         {
+            assert(!"container capacity exceeded");
+         }
+
+         std::size_t on_full_insert(const char*, std::size_t, std::size_t room) noexcept
+         {
+            assert(!"container capacity exceeded");
+            return room;
+         }
+
+         NTL_CONSTEXPR20 void on_shrink(std::size_t) noexcept
+         {
+         }
+      };
+
+      // Inserts what fits and discards the rest
+      struct drop
+      {
+         static constexpr bool check_capacity = true;
+
+         template <typename Container, typename ... Args>
+         NTL_CONSTEXPR20 void on_full_append(Container&, const char*, Args&&...) noexcept
+         {
+         }
+
+         NTL_CONSTEXPR20 std::size_t on_full_insert(const char*, std::size_t, std::size_t room) noexcept
+         {
+            return room;
+         }
+
+         NTL_CONSTEXPR20 void on_shrink(std::size_t) noexcept
+         {
+         }
+      };
+
+      // Inserts what fits, discards the rest and counts the discarded elements
+      class saturate
+      {
+      public:
+         static constexpr bool check_capacity = true;
+
+         template <typename Container, typename ... Args>
+         NTL_CONSTEXPR20 void on_full_append(Container&, const char*, Args&&...) noexcept
+         {
+            ++m_Dropped;
+         }
+
+         NTL_CONSTEXPR20 std::size_t on_full_insert(const char*, std::size_t count, std::size_t room) noexcept
+         {
+            m_Dropped += count - room;
+            return room;
+         }
+
+         NTL_CONSTEXPR20 void on_shrink(std::size_t) noexcept
+         {
+         }
+
+         std::size_t dropped() const noexcept
+         {
+            return m_Dropped;
+         }
+
+      private:
+         std::size_t m_Dropped = 0;
+      };
+
+      // Once full, each append overwrites the oldest element in ring order.
+      // oldest_index() is the slot the next append will overwrite, so the
+      // elements in chronological order are [oldest_index(), size()) followed
+      // by [0, oldest_index()). Bulk inserts keep what fits and drop the rest.
+      // Once the size drops below capacity the ring order is gone, so the
+      // next wrap starts again at slot 0.
+      class overwrite_oldest
+      {
+      public:
+         static constexpr bool check_capacity = true;
+
+         template <typename Container, typename ... Args>
+         NTL_CONSTEXPR20 void on_full_append(Container& c, const char*, Args&&... args)
+         {
+            c[m_Oldest] = typename Container::value_type(std::forward<Args>(args)...);
+            if (++m_Oldest == c.capacity())
+            {
+               m_Oldest = 0;
+            }
+         }
+
+         NTL_CONSTEXPR20 std::size_t on_full_insert(const char*, std::size_t, std::size_t room) noexcept
+         {
+            return room;
+         }
+
+         NTL_CONSTEXPR20 void on_shrink(std::size_t) noexcept
+         {
+            m_Oldest = 0;
+         }
+
+         std::size_t oldest_index() const noexcept
+         {
+            return m_Oldest;
+         }
+
+      private:
+         std::size_t m_Oldest = 0;
+      };
+   }
+}
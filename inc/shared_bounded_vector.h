@@ -0,0 +1,365 @@
+#pragma once
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "bounded_vector.h"
+#include "mapped_bounded_vector.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      // First bytes of a shared_bounded_vector segment. The creator fills in
+      // the layout fields and stores the magic last, so an attaching process
+      // that sees the magic sees the rest of the header too.
+      struct shared_vector_header
+      {
+         std::atomic<std::uint64_t> m_Magic;
+         std::uint32_t m_Version;
+         std::uint32_t m_ElemSize;
+         std::uint32_t m_ElemAlign;
+         std::uint32_t m_SlotSize;
+         std::uint64_t m_Capacity;
+         std::uint64_t m_DataOffset;
+
+         // Slots handed out so far; may run past the capacity once full
+         alignas(cache_line_size) std::atomic<std::uint64_t> m_Reserved;
+      };
+   }
+
+   // Append-only log in POSIX shared memory that any number of processes
+   // (and threads) can append to and read from without locks. Appending
+   // reserves a slot with one fetch_add on the shared counter, copies the
+   // element in and sets the slot's ready flag with release semantics; a
+   // reader that sees the flag sees the element. Slots are published in
+   // whatever order their producers finish, so readers either tail the
+   // log with published_prefix() or skip holes with try_get(). A producer
+   // that dies between reserving and publishing leaves a permanent hole.
+   //
+   // T must be trivially copyable: elements are shared as bytes between
+   // address spaces. Elements are never removed individually; clear() or
+   // map_mode::create start a fresh log. The segment outlives every process
+   // until unlink().
+   template <typename T, std::size_t MaxElems>
+   class shared_bounded_vector
+   {
+      static_assert(std::is_trivially_copyable<T>::value, "shared_bounded_vector requires trivially copyable elements");
+      static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2, "process-shared atomics must be lock-free");
+      static_assert(alignof(T) <= cache_line_size, "shared_bounded_vector elements are at most cache line aligned");
+
+      using header_type = detail::shared_vector_header;
+
+      struct slot
+      {
+         std::atomic<std::uint32_t> m_Ready;
+         std::aligned_storage_t<sizeof(T), alignof(T)> m_Storage;
+
+         T* get_element_as_pointer() noexcept
+         {
+            return reinterpret_cast<T*>(&m_Storage);
+         }
+
+         const T* get_element_as_pointer() const noexcept
+         {
+            return reinterpret_cast<const T*>(&m_Storage);
+         }
+      };
+
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+      using const_reference = const value_type&;
+      using const_pointer = const value_type*;
+
+      // "NTLSVEC\0" when stored little-endian
+      static constexpr std::uint64_t segment_magic = 0x00434556534C544Eull;
+      static constexpr std::uint32_t segment_version = 1;
+
+      static constexpr std::size_t data_offset = sizeof(header_type) > cache_line_size ? sizeof(header_type) : cache_line_size;
+      static constexpr std::size_t segment_size = data_offset + sizeof(slot) * MaxElems;
+
+      // name is a shm_open name such as "/my_log"
+      explicit shared_bounded_vector(const char* name, map_mode mode = map_mode::open_or_create)
+      {
+         bool creator = mode == map_mode::create;
+         int fd = -1;
+         if (mode == map_mode::create)
+         {
+            fd = ::shm_open(name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+         }
+         else if (mode == map_mode::open_or_create)
+         {
+            // O_EXCL decides which of several racing processes initializes
+            fd = ::shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0644);
+            creator = fd >= 0;
+            if (fd < 0 && errno == EEXIST)
+            {
+               fd = ::shm_open(name, O_RDWR, 0644);
+            }
+         }
+         else
+         {
+            fd = ::shm_open(name, O_RDWR, 0644);
+         }
+
+         if (fd < 0)
+         {
+            detail::throw_or_abort<std::runtime_error>("Cannot open shared_bounded_vector segment");
+         }
+
+         bool sized = creator ? ::ftruncate(fd, static_cast<off_t>(segment_size)) == 0 : wait_for_size(fd);
+         void* map = sized ? ::mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+         ::close(fd);
+         if (map == MAP_FAILED)
+         {
+            detail::throw_or_abort<std::runtime_error>("Cannot map shared_bounded_vector segment");
+         }
+
+         m_Map = static_cast<unsigned char*>(map);
+         if (creator)
+         {
+            // ftruncate zero-filled the segment, which is the unpublished state of every slot
+            header_type* h = ::new (static_cast<void*>(m_Map)) header_type();
+            h->m_Version = segment_version;
+            h->m_ElemSize = sizeof(T);
+            h->m_ElemAlign = alignof(T);
+            h->m_SlotSize = sizeof(slot);
+            h->m_Capacity = MaxElems;
+            h->m_DataOffset = data_offset;
+            h->m_Reserved.store(0, std::memory_order_relaxed);
+            h->m_Magic.store(segment_magic, std::memory_order_release);
+         }
+         else if (!wait_for_header() || !layout_matches())
+         {
+            release();
+            detail::throw_or_abort<std::runtime_error>("shared_bounded_vector segment has a different layout");
+         }
+      }
+
+      shared_bounded_vector(shared_bounded_vector&& rhs) noexcept :
+         m_Map(rhs.m_Map)
+      {
+         rhs.m_Map = nullptr;
+      }
+
+      shared_bounded_vector& operator = (shared_bounded_vector&& rhs) noexcept
+      {
+         if (this != &rhs)
+         {
+            release();
+            m_Map = rhs.m_Map;
+            rhs.m_Map = nullptr;
+         }
+
+         return *this;
+      }
+
+      shared_bounded_vector(const shared_bounded_vector&) = delete;
+      shared_bounded_vector& operator = (const shared_bounded_vector&) = delete;
+
+      // Unmaps this process's view; the segment itself stays until unlink()
+      ~shared_bounded_vector()
+      {
+         release();
+      }
+
+      static bool unlink(const char* name) noexcept
+      {
+         return ::shm_unlink(name) == 0;
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return MaxElems;
+      }
+
+      // Reserved slots, published or not
+      size_type size() const noexcept
+      {
+         std::uint64_t reserved = header().m_Reserved.load(std::memory_order_acquire);
+         return reserved < MaxElems ? static_cast<size_type>(reserved) : MaxElems;
+      }
+
+      bool empty() const noexcept
+      {
+         return size() == 0;
+      }
+
+      bool full() const noexcept
+      {
+         return size() == capacity();
+      }
+
+      void push_back(const T& elem)
+      {
+         if (!try_push_back(elem))
+         {
+            detail::throw_or_abort<std::runtime_error>("No space available to push_back");
+         }
+      }
+
+      bool try_push_back(const T& elem)
+      {
+         return try_emplace_back(elem);
+      }
+
+      // Returns false when full
+      template <typename ... Args>
+      bool try_emplace_back(Args&&... args)
+      {
+         std::uint64_t idx = header().m_Reserved.fetch_add(1, std::memory_order_relaxed);
+         if (idx >= MaxElems)
+         {
+            return false;
+         }
+
+         slot& s = slots()[idx];
+         ::new (static_cast<void*>(s.get_element_as_pointer())) T(std::forward<Args>(args)...);
+         s.m_Ready.store(1, std::memory_order_release);
+         return true;
+      }
+
+      // Empties the log for reuse without recreating the segment. No other
+      // process or thread may be appending or reading meanwhile.
+      void clear() noexcept
+      {
+         size_type count = size();
+         for (size_type i = 0; i < count; ++i)
+         {
+            slots()[i].m_Ready.store(0, std::memory_order_relaxed);
+         }
+
+         header().m_Reserved.store(0, std::memory_order_release);
+      }
+
+      bool is_published(size_type pos) const noexcept
+      {
+         return pos < capacity() && slots()[pos].m_Ready.load(std::memory_order_acquire) != 0;
+      }
+
+      // nullptr while slot pos is unreserved or its producer has not finished
+      const_pointer try_get(size_type pos) const noexcept
+      {
+         return is_published(pos) ? slots()[pos].get_element_as_pointer() : nullptr;
+      }
+
+      // The caller has seen is_published(pos)
+      const_reference operator [](size_type pos) const noexcept
+      {
+         assert(is_published(pos));
+
+         return *slots()[pos].get_element_as_pointer();
+      }
+
+      // End of the run of published slots starting at from. Every slot in
+      // [from, result) is safe to read; a reader tailing the log passes the
+      // previous result back in.
+      size_type published_prefix(size_type from = 0) const noexcept
+      {
+         size_type last = size();
+         while (from < last && slots()[from].m_Ready.load(std::memory_order_acquire) != 0)
+         {
+            ++from;
+         }
+
+         return from;
+      }
+
+   private:
+      // Attempts, a millisecond apart, to see a racing creator finish
+      static constexpr int init_wait_tries = 1000;
+
+      header_type& header() noexcept
+      {
+         return *reinterpret_cast<header_type*>(m_Map);
+      }
+
+      const header_type& header() const noexcept
+      {
+         return *reinterpret_cast<const header_type*>(m_Map);
+      }
+
+      slot* slots() noexcept
+      {
+         return reinterpret_cast<slot*>(m_Map + data_offset);
+      }
+
+      const slot* slots() const noexcept
+      {
+         return reinterpret_cast<const slot*>(m_Map + data_offset);
+      }
+
+      static bool wait_for_size(int fd) noexcept
+      {
+         for (int tries = 0; tries < init_wait_tries; ++tries)
+         {
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+               return false;
+            }
+
+            if (st.st_size != 0)
+            {
+               return static_cast<std::uint64_t>(st.st_size) == segment_size;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         }
+
+         return false;
+      }
+
+      bool wait_for_header() const noexcept
+      {
+         for (int tries = 0; tries < init_wait_tries; ++tries)
+         {
+            if (header().m_Magic.load(std::memory_order_acquire) != 0)
+            {
+               return true;
+            }
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+         }
+
+         return false;
+      }
+
+      bool layout_matches() const noexcept
+      {
+         const header_type& h = header();
+         return h.m_Magic.load(std::memory_order_acquire) == segment_magic
+            && h.m_Version == segment_version
+            && h.m_ElemSize == sizeof(T)
+            && h.m_ElemAlign == alignof(T)
+            && h.m_SlotSize == sizeof(slot)
+            && h.m_Capacity == MaxElems
+            && h.m_DataOffset == data_offset;
+      }
+
+      void release() noexcept
+      {
+         if (m_Map != nullptr)
+         {
+            ::munmap(m_Map, segment_size);
+            m_Map = nullptr;
+         }
+      }
+
+      unsigned char* m_Map = nullptr;
+   };
+}
@@ -0,0 +1,439 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include "ntl_config.h"
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NTL_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define NTL_SIMD_X86 0
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define NTL_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define NTL_TARGET_AVX2
+#endif
+
+namespace ntl
+{
+   // Types whose operator== is equivalent to comparing their object
+   // representations byte for byte. Specialize this for padding-free structs
+   // with memberwise equality to get the vectorized comparison kernels.
+   // Floating point types are excluded since NaN != NaN and -0.0 == 0.0.
+   template <typename T>
+   struct is_trivially_comparable : std::integral_constant<bool,
+      std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>
+   {
+   };
+
+   namespace detail
+   {
+      namespace simd
+      {
+         // mask must be non-zero
+         inline unsigned count_trailing_zeros(unsigned mask) noexcept
+         {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long idx;
+            _BitScanForward(&idx, mask);
+            return idx;
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+         }
+
+         inline unsigned popcount(unsigned mask) noexcept
+         {
+#if defined(_MSC_VER) && !defined(__clang__)
+            mask = mask - ((mask >> 1) & 0x55555555u);
+            mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+            return (((mask + (mask >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#else
+            return static_cast<unsigned>(__builtin_popcount(mask));
+#endif
+         }
+      }
+
+#if NTL_SIMD_X86
+      namespace simd
+      {
+         inline bool detect_avx2() noexcept
+         {
+#if defined(_MSC_VER) && !defined(__clang__)
+            int regs[4];
+            __cpuid(regs, 1);
+            bool osUsesXsave = (regs[2] & (1 << 27)) != 0;
+            bool hasAvx = (regs[2] & (1 << 28)) != 0;
+            if (!osUsesXsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6)
+            {
+               return false;
+            }
+
+            __cpuidex(regs, 7, 0);
+            return (regs[1] & (1 << 5)) != 0;
+#else
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") != 0;
+#endif
+         }
+
+         inline bool has_avx2() noexcept
+         {
+            static const bool s_HasAvx2 = detect_avx2();
+            return s_HasAvx2;
+         }
+
+         // Lane-wise equality for each element width. Every lane that compares
+         // equal sets all of its bytes, so movemask yields Width bits per match.
+         template <std::size_t Width>
+         struct lanes;
+
+         template <>
+         struct lanes<1>
+         {
+            static __m128i set1(const void* value) noexcept
+            {
+               std::int8_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm_set1_epi8(v);
+            }
+
+            static __m128i cmpeq(__m128i a, __m128i b) noexcept
+            {
+               return _mm_cmpeq_epi8(a, b);
+            }
+
+            NTL_TARGET_AVX2 static __m256i set1_256(const void* value) noexcept
+            {
+               std::int8_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm256_set1_epi8(v);
+            }
+
+            NTL_TARGET_AVX2 static __m256i cmpeq_256(__m256i a, __m256i b) noexcept
+            {
+               return _mm256_cmpeq_epi8(a, b);
+            }
+         };
+
+         template <>
+         struct lanes<2>
+         {
+            static __m128i set1(const void* value) noexcept
+            {
+               std::int16_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm_set1_epi16(v);
+            }
+
+            static __m128i cmpeq(__m128i a, __m128i b) noexcept
+            {
+               return _mm_cmpeq_epi16(a, b);
+            }
+
+            NTL_TARGET_AVX2 static __m256i set1_256(const void* value) noexcept
+            {
+               std::int16_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm256_set1_epi16(v);
+            }
+
+            NTL_TARGET_AVX2 static __m256i cmpeq_256(__m256i a, __m256i b) noexcept
+            {
+               return _mm256_cmpeq_epi16(a, b);
+            }
+         };
+
+         template <>
+         struct lanes<4>
+         {
+            static __m128i set1(const void* value) noexcept
+            {
+               std::int32_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm_set1_epi32(v);
+            }
+
+            static __m128i cmpeq(__m128i a, __m128i b) noexcept
+            {
+               return _mm_cmpeq_epi32(a, b);
+            }
+
+            NTL_TARGET_AVX2 static __m256i set1_256(const void* value) noexcept
+            {
+               std::int32_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm256_set1_epi32(v);
+            }
+
+            NTL_TARGET_AVX2 static __m256i cmpeq_256(__m256i a, __m256i b) noexcept
+            {
+               return _mm256_cmpeq_epi32(a, b);
+            }
+         };
+
+         template <>
+         struct lanes<8>
+         {
+            static __m128i set1(const void* value) noexcept
+            {
+               std::int64_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm_set1_epi64x(v);
+            }
+
+            static __m128i cmpeq(__m128i a, __m128i b) noexcept
+            {
+               // SSE2 has no 64-bit compare; both 32-bit halves have to match
+               __m128i eq = _mm_cmpeq_epi32(a, b);
+               return _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+            }
+
+            NTL_TARGET_AVX2 static __m256i set1_256(const void* value) noexcept
+            {
+               std::int64_t v;
+               std::memcpy(&v, value, sizeof(v));
+               return _mm256_set1_epi64x(v);
+            }
+
+            NTL_TARGET_AVX2 static __m256i cmpeq_256(__m256i a, __m256i b) noexcept
+            {
+               return _mm256_cmpeq_epi64(a, b);
+            }
+         };
+
+         // Byte offset of the first difference in [0, numBytes), or numBytes
+         inline std::size_t mismatch_bytes_sse2(const unsigned char* a, const unsigned char* b, std::size_t numBytes) noexcept
+         {
+            std::size_t i = 0;
+            for (; i + 16 <= numBytes; i += 16)
+            {
+               __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+               __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+               unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))) ^ 0xFFFFu;
+               if (mask != 0)
+               {
+                  return i + count_trailing_zeros(mask);
+               }
+            }
+
+            for (; i < numBytes && a[i] == b[i]; ++i)
+            {
+            }
+
+            return i;
+         }
+
+         NTL_TARGET_AVX2 inline std::size_t mismatch_bytes_avx2(const unsigned char* a, const unsigned char* b, std::size_t numBytes) noexcept
+         {
+            std::size_t i = 0;
+            for (; i + 32 <= numBytes; i += 32)
+            {
+               __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+               __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+               unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)));
+               if (mask != 0)
+               {
+                  return i + count_trailing_zeros(mask);
+               }
+            }
+
+            return i + mismatch_bytes_sse2(a + i, b + i, numBytes - i);
+         }
+
+         template <std::size_t Width>
+         std::size_t find_sse2(const unsigned char* first, std::size_t numBytes, const void* value) noexcept
+         {
+            __m128i needle = lanes<Width>::set1(value);
+            std::size_t i = 0;
+            for (; i + 16 <= numBytes; i += 16)
+            {
+               __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+               unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(lanes<Width>::cmpeq(v, needle)));
+               if (mask != 0)
+               {
+                  return i + count_trailing_zeros(mask);
+               }
+            }
+
+            for (; i < numBytes && std::memcmp(first + i, value, Width) != 0; i += Width)
+            {
+            }
+
+            return i;
+         }
+
+         template <std::size_t Width>
+         NTL_TARGET_AVX2 std::size_t find_avx2(const unsigned char* first, std::size_t numBytes, const void* value) noexcept
+         {
+            __m256i needle = lanes<Width>::set1_256(value);
+            std::size_t i = 0;
+            for (; i + 32 <= numBytes; i += 32)
+            {
+               __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+               unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(lanes<Width>::cmpeq_256(v, needle)));
+               if (mask != 0)
+               {
+                  return i + count_trailing_zeros(mask);
+               }
+            }
+
+            return i + find_sse2<Width>(first + i, numBytes - i, value);
+         }
+
+         // Returns the number of matching bytes; divide by Width for elements
+         template <std::size_t Width>
+         std::size_t count_sse2(const unsigned char* first, std::size_t numBytes, const void* value) noexcept
+         {
+            __m128i needle = lanes<Width>::set1(value);
+            std::size_t matchedBytes = 0;
+            std::size_t i = 0;
+            for (; i + 16 <= numBytes; i += 16)
+            {
+               __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+               matchedBytes += popcount(static_cast<unsigned>(_mm_movemask_epi8(lanes<Width>::cmpeq(v, needle))));
+            }
+
+            for (; i < numBytes; i += Width)
+            {
+               if (std::memcmp(first + i, value, Width) == 0)
+               {
+                  matchedBytes += Width;
+               }
+            }
+
+            return matchedBytes;
+         }
+
+         template <std::size_t Width>
+         NTL_TARGET_AVX2 std::size_t count_avx2(const unsigned char* first, std::size_t numBytes, const void* value) noexcept
+         {
+            __m256i needle = lanes<Width>::set1_256(value);
+            std::size_t matchedBytes = 0;
+            std::size_t i = 0;
+            for (; i + 32 <= numBytes; i += 32)
+            {
+               __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+               matchedBytes += popcount(static_cast<unsigned>(_mm256_movemask_epi8(lanes<Width>::cmpeq_256(v, needle))));
+            }
+
+            return matchedBytes + count_sse2<Width>(first + i, numBytes - i, value);
+         }
+      }
+#endif
+
+      template <typename T>
+      using is_simd_searchable = std::integral_constant<bool,
+         is_trivially_comparable<T>::value
+         && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)>;
+
+      // Index of the first position where a and b differ, or count
+      template <typename T>
+      std::size_t mismatch_n(const T* a, const T* b, std::size_t count, std::true_type) noexcept
+      {
+#if NTL_SIMD_X86
+         const unsigned char* aBytes = reinterpret_cast<const unsigned char*>(a);
+         const unsigned char* bBytes = reinterpret_cast<const unsigned char*>(b);
+         std::size_t numBytes = count * sizeof(T);
+         std::size_t byteIdx = (simd::has_avx2() && numBytes >= 32)
+            ? simd::mismatch_bytes_avx2(aBytes, bBytes, numBytes)
+            : simd::mismatch_bytes_sse2(aBytes, bBytes, numBytes);
+         return byteIdx / sizeof(T);
+#else
+         return std::mismatch(a, a + count, b).first - a;
+#endif
+      }
+
+      template <typename T>
+      std::size_t mismatch_n(const T* a, const T* b, std::size_t count, std::false_type)
+      {
+         return std::mismatch(a, a + count, b).first - a;
+      }
+
+      template <typename T>
+      NTL_CONSTEXPR20 std::size_t mismatch_n(const T* a, const T* b, std::size_t count)
+      {
+         if (is_constant_evaluated())
+         {
+            return std::mismatch(a, a + count, b).first - a;
+         }
+
+         return mismatch_n(a, b, count, is_trivially_comparable<T>());
+      }
+
+      // Index of the first element equal to value, or count
+      template <typename T>
+      std::size_t find_n(const T* first, std::size_t count, const T& value, std::true_type) noexcept
+      {
+#if NTL_SIMD_X86
+         const unsigned char* bytes = reinterpret_cast<const unsigned char*>(first);
+         std::size_t numBytes = count * sizeof(T);
+         std::size_t byteIdx = (simd::has_avx2() && numBytes >= 32)
+            ? simd::find_avx2<sizeof(T)>(bytes, numBytes, &value)
+            : simd::find_sse2<sizeof(T)>(bytes, numBytes, &value);
+         return byteIdx / sizeof(T);
+#else
+         return std::find(first, first + count, value) - first;
+#endif
+      }
+
+      template <typename T>
+      std::size_t find_n(const T* first, std::size_t count, const T& value, std::false_type)
+      {
+         return std::find(first, first + count, value) - first;
+      }
+
+      template <typename T>
+      NTL_CONSTEXPR20 std::size_t find_n(const T* first, std::size_t count, const T& value)
+      {
+         if (is_constant_evaluated())
+         {
+            return std::find(first, first + count, value) - first;
+         }
+
+         return find_n(first, count, value, is_simd_searchable<T>());
+      }
+
+      template <typename T>
+      std::size_t count_n(const T* first, std::size_t count, const T& value, std::true_type) noexcept
+      {
+#if NTL_SIMD_X86
+         const unsigned char* bytes = reinterpret_cast<const unsigned char*>(first);
+         std::size_t numBytes = count * sizeof(T);
+         std::size_t matchedBytes = (simd::has_avx2() && numBytes >= 32)
+            ? simd::count_avx2<sizeof(T)>(bytes, numBytes, &value)
+            : simd::count_sse2<sizeof(T)>(bytes, numBytes, &value);
+         return matchedBytes / sizeof(T);
+#else
+         return std::count(first, first + count, value);
+#endif
+      }
+
+      template <typename T>
+      std::size_t count_n(const T* first, std::size_t count, const T& value, std::false_type)
+      {
+         return std::count(first, first + count, value);
+      }
+
+      template <typename T>
+      NTL_CONSTEXPR20 std::size_t count_n(const T* first, std::size_t count, const T& value)
+      {
+         if (is_constant_evaluated())
+         {
+            return std::count(first, first + count, value);
+         }
+
+         return count_n(first, count, value, is_simd_searchable<T>());
+      }
+   }
+}
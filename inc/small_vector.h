@@ -0,0 +1,844 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   namespace detail
+   {
+      // Constructs [dst, dst + (last - first)) from [first, last), moving
+      // when that cannot throw and copying otherwise, as std::vector does
+      // when it grows. The sources are left in place. If a construction
+      // throws, the elements already built in dst are destroyed and the
+      // exception propagates with [first, last) untouched.
+      template <typename Allocator, typename T>
+      void uninitialized_move_if_noexcept(Allocator& alloc, T* first, T* last, T* dst)
+      {
+         T* built = dst;
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            for (; first != last; ++first, ++built)
+            {
+               std::allocator_traits<Allocator>::construct(alloc, built, std::move_if_noexcept(*first));
+            }
+         }
+         catch (...)
+         {
+            destroy_range(alloc, dst, built);
+            throw;
+         }
+#else
+         for (; first != last; ++first, ++built)
+         {
+            std::allocator_traits<Allocator>::construct(alloc, built, std::move_if_noexcept(*first));
+         }
+#endif
+      }
+   }
+
+   // Vector that keeps up to N elements in inline storage and moves to a
+   // buffer obtained from Allocator only once it grows past N. Growth is
+   // geometric, and a heap buffer is kept until shrink_to_fit() or
+   // destruction, so clear() followed by refilling does not reallocate.
+   //
+   // Growing gives the strong guarantee: elements whose move constructor
+   // may throw are copied into the new buffer, so a throw leaves the
+   // vector as it was. A type that can only be moved, and may throw while
+   // doing so, gets the basic guarantee.
+   template <typename T, std::size_t N, typename Allocator = std::allocator<T>>
+   class small_vector : private detail::allocator_holder<Allocator>
+   {
+      static_assert(N > 0, "small_vector needs at least one inline element");
+
+      using alloc_traits = std::allocator_traits<Allocator>;
+      using nothrow_move = std::integral_constant<bool, std::is_nothrow_move_constructible<T>::value
+         && alloc_traits::is_always_equal::value>;
+
+   public:
+      using value_type = T;
+      using allocator_type = Allocator;
+      using size_type = std::size_t;
+      using difference_type = std::ptrdiff_t;
+      using reference = value_type&;
+      using const_reference = const value_type&;
+      using pointer = typename alloc_traits::pointer;
+      using const_pointer = typename alloc_traits::const_pointer;
+
+      using iterator = pointer;
+      using const_iterator = const_pointer;
+      using reverse_iterator = std::reverse_iterator<iterator>;
+      using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+      small_vector() noexcept :
+         m_Data(inline_data()),
+         m_Size(0),
+         m_Capacity(N)
+      {
+      }
+
+      explicit small_vector(const Allocator& alloc) noexcept :
+         detail::allocator_holder<Allocator>(alloc),
+         m_Data(inline_data()),
+         m_Size(0),
+         m_Capacity(N)
+      {
+      }
+
+      small_vector(size_type count, const T& value, const Allocator& alloc = Allocator()) :
+         small_vector(alloc)
+      {
+         insert(cend(), count, value);
+      }
+
+      small_vector(std::initializer_list<T> init, const Allocator& alloc = Allocator()) :
+         small_vector(alloc)
+      {
+         append_range(init);
+      }
+
+      small_vector(const small_vector& rhs) :
+         small_vector(alloc_traits::select_on_container_copy_construction(rhs.get_alloc()))
+      {
+         copy_elements_from(rhs);
+      }
+
+      // Allocators that may compare unequal force a reserve() and so can throw
+      small_vector(small_vector&& rhs) noexcept(nothrow_move::value) :
+         small_vector(rhs.get_alloc())
+      {
+         move_elements_from(rhs);
+      }
+
+      small_vector& operator = (const small_vector& rhs)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            copy_elements_from(rhs);
+         }
+
+         return *this;
+      }
+
+      small_vector& operator = (small_vector&& rhs) noexcept(nothrow_move::value)
+      {
+         if (this != &rhs)
+         {
+            clear();
+            move_elements_from(rhs);
+         }
+
+         return *this;
+      }
+
+      ~small_vector()
+      {
+         clear();
+         release_heap();
+      }
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      void assign(InputIt first, InputIt last)
+      {
+         clear();
+         insert(cend(), first, last);
+      }
+
+      void assign(size_type count, const T& value)
+      {
+         clear();
+         insert(cend(), count, value);
+      }
+
+      void assign(std::initializer_list<T> init)
+      {
+         assign(init.begin(), init.end());
+      }
+
+      iterator begin() noexcept
+      {
+         return m_Data;
+      }
+
+      const_iterator begin() const noexcept
+      {
+         return cbegin();
+      }
+
+      const_iterator cbegin() const noexcept
+      {
+         return m_Data;
+      }
+
+      reverse_iterator rbegin() noexcept
+      {
+         return reverse_iterator(end());
+      }
+
+      const_reverse_iterator rbegin() const noexcept
+      {
+         return crbegin();
+      }
+
+      const_reverse_iterator crbegin() const noexcept
+      {
+         return const_reverse_iterator(cend());
+      }
+
+      iterator end() noexcept
+      {
+         return m_Data + m_Size;
+      }
+
+      const_iterator end() const noexcept
+      {
+         return cend();
+      }
+
+      const_iterator cend() const noexcept
+      {
+         return m_Data + m_Size;
+      }
+
+      reverse_iterator rend() noexcept
+      {
+         return reverse_iterator(begin());
+      }
+
+      const_reverse_iterator rend() const noexcept
+      {
+         return crend();
+      }
+
+      const_reverse_iterator crend() const noexcept
+      {
+         return const_reverse_iterator(cbegin());
+      }
+
+      pointer data() noexcept
+      {
+         return m_Data;
+      }
+
+      const_pointer data() const noexcept
+      {
+         return m_Data;
+      }
+
+      reference at(size_type pos)
+      {
+         if (pos >= size())
+         {
+            detail::throw_or_abort<std::out_of_range>("small_vector::at index out of range");
+         }
+
+         return m_Data[pos];
+      }
+
+      const_reference at(size_type pos) const
+      {
+         if (pos >= size())
+         {
+            detail::throw_or_abort<std::out_of_range>("small_vector::at index out of range");
+         }
+
+         return m_Data[pos];
+      }
+
+      reference operator [](size_type pos) noexcept
+      {
+         return m_Data[pos];
+      }
+
+      const_reference operator [](size_type pos) const noexcept
+      {
+         return m_Data[pos];
+      }
+
+      reference front() noexcept
+      {
+         return m_Data[0];
+      }
+
+      const_reference front() const noexcept
+      {
+         return m_Data[0];
+      }
+
+      reference back() noexcept
+      {
+         return m_Data[m_Size - 1];
+      }
+
+      const_reference back() const noexcept
+      {
+         return m_Data[m_Size - 1];
+      }
+
+      size_type size() const noexcept
+      {
+         return m_Size;
+      }
+
+      bool empty() const noexcept
+      {
+         return m_Size == 0;
+      }
+
+      size_type capacity() const noexcept
+      {
+         return m_Capacity;
+      }
+
+      size_type max_size() const noexcept
+      {
+         return alloc_traits::max_size(this->get_alloc());
+      }
+
+      // True while the elements live in the inline buffer
+      bool is_inline() const noexcept
+      {
+         return m_Data == inline_data();
+      }
+
+      allocator_type get_allocator() const noexcept
+      {
+         return this->get_alloc();
+      }
+
+      void reserve(size_type newCapacity)
+      {
+         if (newCapacity > capacity())
+         {
+            reallocate(newCapacity);
+         }
+      }
+
+      // Returns to the inline buffer when the elements fit, otherwise trims
+      // the heap buffer to size()
+      void shrink_to_fit()
+      {
+         if (is_inline() || m_Size == m_Capacity)
+         {
+            return;
+         }
+
+         if (m_Size <= N)
+         {
+            pointer heap = m_Data;
+            size_type heapCapacity = m_Capacity;
+            relocate_into(inline_data(), m_Size, 0);
+            alloc_traits::deallocate(this->get_alloc(), heap, heapCapacity);
+            m_Data = inline_data();
+            m_Capacity = N;
+         }
+         else
+         {
+            reallocate(m_Size);
+         }
+      }
+
+      void clear() noexcept
+      {
+         detail::destroy_range(this->get_alloc(), begin(), end());
+         m_Size = 0;
+      }
+
+      void push_back(const T& elem)
+      {
+         emplace_back(elem);
+      }
+
+      void push_back(T&& elem)
+      {
+         emplace_back(std::move(elem));
+      }
+
+      template <typename ... Args>
+      reference emplace_back(Args&&... args)
+      {
+         if (m_Size == m_Capacity)
+         {
+            return grow_and_emplace_back(std::forward<Args>(args)...);
+         }
+
+         pointer elem = m_Data + m_Size;
+         alloc_traits::construct(this->get_alloc(), elem, std::forward<Args>(args)...);
+         ++m_Size;
+         return *elem;
+      }
+
+      void pop_back()
+      {
+         --m_Size;
+         alloc_traits::destroy(this->get_alloc(), m_Data + m_Size);
+      }
+
+      iterator insert(const_iterator pos, const T& value)
+      {
+         return emplace(pos, value);
+      }
+
+      iterator insert(const_iterator pos, T&& value)
+      {
+         return emplace(pos, std::move(value));
+      }
+
+      iterator insert(const_iterator pos, size_type count, const T& value)
+      {
+         size_type idx = pos - cbegin();
+         if (count > 0)
+         {
+            // Copy first in case value refers to an element that is about to move
+            value_type tmp(value);
+            insert_n(idx, count, [this, &tmp](pointer dst) { alloc_traits::construct(this->get_alloc(), dst, tmp); });
+         }
+
+         return m_Data + idx;
+      }
+
+      template <typename InputIt, typename = detail::enable_if_iterator_t<InputIt>>
+      iterator insert(const_iterator pos, InputIt first, InputIt last)
+      {
+         return insert_range(pos - cbegin(), first, last, typename std::iterator_traits<InputIt>::iterator_category());
+      }
+
+      iterator insert(const_iterator pos, std::initializer_list<T> init)
+      {
+         return insert(pos, init.begin(), init.end());
+      }
+
+      template <typename Range>
+      void append_range(Range&& range)
+      {
+         using std::begin;
+         using std::end;
+         insert(cend(), begin(range), end(range));
+      }
+
+      template <typename ... Args>
+      iterator emplace(const_iterator pos, Args&&... args)
+      {
+         size_type idx = pos - cbegin();
+         if (idx == size())
+         {
+            emplace_back(std::forward<Args>(args)...);
+         }
+         else
+         {
+            // Construct first so that args referring into this container stay valid
+            value_type tmp(std::forward<Args>(args)...);
+            insert_n(idx, 1, [this, &tmp](pointer dst) { alloc_traits::construct(this->get_alloc(), dst, std::move(tmp)); });
+         }
+
+         return m_Data + idx;
+      }
+
+      iterator erase(const_iterator pos)
+      {
+         assert(pos != cend());
+
+         return erase(pos, pos + 1);
+      }
+
+      iterator erase(const_iterator first, const_iterator last)
+      {
+         size_type idx = first - cbegin();
+         size_type count = last - first;
+         if (count > 0)
+         {
+            assert(idx + count <= size());
+            detail::close_gap(this->get_alloc(), m_Data + idx, end(), count);
+            m_Size -= count;
+         }
+
+         return m_Data + idx;
+      }
+
+      // O(1) erase for when order does not matter: the last element is moved
+      // into pos. Returns pos, which now holds the former last element.
+      iterator erase_unordered(const_iterator pos)
+      {
+         assert(pos != cend());
+
+         size_type idx = pos - cbegin();
+         if (idx != size() - 1)
+         {
+            m_Data[idx] = std::move(back());
+         }
+
+         pop_back();
+         return m_Data + idx;
+      }
+
+      // Removes every element matching pred in a single pass, keeping the
+      // order of the rest, and returns how many were removed
+      template <typename Pred>
+      size_type remove_if(Pred pred)
+      {
+         pointer newLast = std::remove_if(begin(), end(), std::ref(pred));
+         size_type count = end() - newLast;
+         detail::destroy_range(this->get_alloc(), newLast, end());
+         m_Size -= count;
+         return count;
+      }
+
+      size_type remove(const T& value)
+      {
+         // Copied in case value is one of the elements being shifted down
+         value_type tmp(value);
+         return remove_if([&tmp](const T& elem) { return elem == tmp; });
+      }
+
+      iterator find(const T& value) noexcept
+      {
+         return begin() + detail::find_n(data(), size(), value);
+      }
+
+      const_iterator find(const T& value) const noexcept
+      {
+         return begin() + detail::find_n(data(), size(), value);
+      }
+
+      size_type count(const T& value) const noexcept
+      {
+         return detail::count_n(data(), size(), value);
+      }
+
+      bool contains(const T& value) const noexcept
+      {
+         return find(value) != end();
+      }
+
+      bool operator == (const small_vector& rhs) const noexcept
+      {
+         return size() == rhs.size()
+            && detail::mismatch_n(data(), rhs.data(), size()) == size();
+      }
+
+      bool operator != (const small_vector& rhs) const noexcept
+      {
+         return !(*this == rhs);
+      }
+
+#if defined(__cpp_lib_three_way_comparison)
+      template <typename U = T>
+      detail::synth_three_way_result_t<U> operator <=> (const small_vector& rhs) const
+      {
+         size_type common = std::min(size(), rhs.size());
+         size_type idx = detail::mismatch_n(data(), rhs.data(), common);
+         if (idx != common)
+         {
+            return detail::synth_three_way()((*this)[idx], rhs[idx]);
+         }
+
+         return size() <=> rhs.size();
+      }
+#else
+      bool operator < (const small_vector& rhs) const
+      {
+         size_type common = std::min(size(), rhs.size());
+         size_type idx = detail::mismatch_n(data(), rhs.data(), common);
+         if (idx != common)
+         {
+            return (*this)[idx] < rhs[idx];
+         }
+
+         return size() < rhs.size();
+      }
+
+      bool operator > (const small_vector& rhs) const
+      {
+         return rhs < *this;
+      }
+
+      bool operator <= (const small_vector& rhs) const
+      {
+         return !(rhs < *this);
+      }
+
+      bool operator >= (const small_vector& rhs) const
+      {
+         return !(*this < rhs);
+      }
+#endif
+
+   private:
+      pointer inline_data() noexcept
+      {
+         return reinterpret_cast<pointer>(&m_Inline[0]);
+      }
+
+      const_pointer inline_data() const noexcept
+      {
+         return reinterpret_cast<const_pointer>(&m_Inline[0]);
+      }
+
+      // Capacity for at least required elements, doubling to keep appends amortized O(1)
+      size_type grown_capacity(size_type required) const
+      {
+         size_type maxSize = max_size();
+         if (required > maxSize)
+         {
+            detail::throw_or_abort<std::length_error>("small_vector size exceeds max_size");
+         }
+
+         return m_Capacity > maxSize / 2 ? maxSize : std::max(m_Capacity * 2, required);
+      }
+
+      void release_heap() noexcept
+      {
+         if (!is_inline())
+         {
+            alloc_traits::deallocate(this->get_alloc(), m_Data, m_Capacity);
+            m_Data = inline_data();
+            m_Capacity = N;
+         }
+      }
+
+      void adopt_buffer(pointer buffer, size_type capacity) noexcept
+      {
+         release_heap();
+         m_Data = buffer;
+         m_Capacity = capacity;
+      }
+
+      // Relocates the elements into buffer, leaving count uninitialized
+      // slots at idx. Elements that cannot be moved without the risk of a
+      // throw are copied first and the originals destroyed only once every
+      // copy succeeded; if one throws, *this is unchanged and the caller
+      // still owns buffer.
+      void relocate_into(pointer buffer, size_type idx, size_type count)
+      {
+         if (is_trivially_relocatable<T>::value || std::is_nothrow_move_constructible<T>::value)
+         {
+            detail::relocate(this->get_alloc(), m_Data, m_Data + idx, buffer);
+            detail::relocate(this->get_alloc(), m_Data + idx, end(), buffer + idx + count);
+            return;
+         }
+
+         detail::uninitialized_move_if_noexcept(this->get_alloc(), m_Data, m_Data + idx, buffer);
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            detail::uninitialized_move_if_noexcept(this->get_alloc(), m_Data + idx, end(), buffer + idx + count);
+         }
+         catch (...)
+         {
+            detail::destroy_range(this->get_alloc(), buffer, buffer + idx);
+            throw;
+         }
+#else
+         detail::uninitialized_move_if_noexcept(this->get_alloc(), m_Data + idx, end(), buffer + idx + count);
+#endif
+
+         detail::destroy_range(this->get_alloc(), begin(), end());
+      }
+
+      // Moves the elements to a fresh buffer of newCapacity
+      void reallocate(size_type newCapacity)
+      {
+         pointer buffer = alloc_traits::allocate(this->get_alloc(), newCapacity);
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            relocate_into(buffer, m_Size, 0);
+         }
+         catch (...)
+         {
+            alloc_traits::deallocate(this->get_alloc(), buffer, newCapacity);
+            throw;
+         }
+#else
+         relocate_into(buffer, m_Size, 0);
+#endif
+
+         adopt_buffer(buffer, newCapacity);
+      }
+
+      template <typename ... Args>
+      reference grow_and_emplace_back(Args&&... args)
+      {
+         size_type newCapacity = grown_capacity(m_Size + 1);
+         pointer buffer = alloc_traits::allocate(this->get_alloc(), newCapacity);
+
+         // The new element goes in before the old ones move, since args may refer to one of them
+         pointer elem = buffer + m_Size;
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            alloc_traits::construct(this->get_alloc(), elem, std::forward<Args>(args)...);
+         }
+         catch (...)
+         {
+            alloc_traits::deallocate(this->get_alloc(), buffer, newCapacity);
+            throw;
+         }
+
+         try
+         {
+            relocate_into(buffer, m_Size, 0);
+         }
+         catch (...)
+         {
+            alloc_traits::destroy(this->get_alloc(), elem);
+            alloc_traits::deallocate(this->get_alloc(), buffer, newCapacity);
+            throw;
+         }
+#else
+         alloc_traits::construct(this->get_alloc(), elem, std::forward<Args>(args)...);
+         relocate_into(buffer, m_Size, 0);
+#endif
+
+         adopt_buffer(buffer, newCapacity);
+         ++m_Size;
+         return *elem;
+      }
+
+      // Constructs count elements at idx through build(slot). The size only
+      // grows once all of them are live; if a build throws, the ones built so
+      // far are destroyed and the vector is as it was. When the elements do
+      // not fit, the new ones are built in the new buffer first and both
+      // halves are then relocated straight around them, so nothing is moved
+      // twice.
+      template <typename Build>
+      void insert_n(size_type idx, size_type count, Build&& build)
+      {
+         if (count <= m_Capacity - m_Size)
+         {
+            detail::insert_gap(this->get_alloc(), m_Data + idx, end(), count, build, [this, count]() { m_Size += count; });
+            return;
+         }
+
+         size_type newCapacity = grown_capacity(m_Size + count);
+         pointer buffer = alloc_traits::allocate(this->get_alloc(), newCapacity);
+#if NTL_HAS_EXCEPTIONS
+         try
+         {
+            detail::construct_each(this->get_alloc(), buffer + idx, buffer + idx + count, build);
+         }
+         catch (...)
+         {
+            alloc_traits::deallocate(this->get_alloc(), buffer, newCapacity);
+            throw;
+         }
+
+         try
+         {
+            relocate_into(buffer, idx, count);
+         }
+         catch (...)
+         {
+            detail::destroy_range(this->get_alloc(), buffer + idx, buffer + idx + count);
+            alloc_traits::deallocate(this->get_alloc(), buffer, newCapacity);
+            throw;
+         }
+#else
+         detail::construct_each(this->get_alloc(), buffer + idx, buffer + idx + count, build);
+         relocate_into(buffer, idx, count);
+#endif
+
+         adopt_buffer(buffer, newCapacity);
+         m_Size += count;
+      }
+
+      template <typename ForwardIt>
+      iterator insert_range(size_type idx, ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+      {
+         size_type count = std::distance(first, last);
+         if (count > 0)
+         {
+            insert_n(idx, count, [this, &first](pointer dst)
+            {
+               alloc_traits::construct(this->get_alloc(), dst, *first);
+               ++first;
+            });
+         }
+
+         return m_Data + idx;
+      }
+
+      template <typename InputIt>
+      iterator insert_range(size_type idx, InputIt first, InputIt last, std::input_iterator_tag)
+      {
+         // Single pass input cannot be counted up front, so append and rotate into place
+         size_type oldSize = size();
+         for (; first != last; ++first)
+         {
+            emplace_back(*first);
+         }
+
+         std::rotate(m_Data + idx, m_Data + oldSize, end());
+         return m_Data + idx;
+      }
+
+      void copy_elements_from(const small_vector& rhs)
+      {
+         reserve(rhs.size());
+         if (std::is_trivially_copyable<T>::value && std::is_same<Allocator, std::allocator<T>>::value)
+         {
+            std::memcpy(static_cast<void*>(m_Data), static_cast<const void*>(rhs.m_Data), rhs.m_Size * sizeof(T));
+            m_Size = rhs.m_Size;
+         }
+         else
+         {
+            for (const_pointer src = rhs.begin(); src != rhs.end(); ++src)
+            {
+               alloc_traits::construct(this->get_alloc(), m_Data + m_Size, *src);
+               ++m_Size;
+            }
+         }
+      }
+
+      // A heap buffer changes hands without touching the elements; inline
+      // elements are relocated one by one. rhs is left empty either way.
+      void move_elements_from(small_vector& rhs)
+      {
+         if (!rhs.is_inline() && this->get_alloc() == rhs.get_alloc())
+         {
+            adopt_buffer(rhs.m_Data, rhs.m_Capacity);
+            m_Size = rhs.m_Size;
+            rhs.m_Data = rhs.inline_data();
+            rhs.m_Capacity = N;
+         }
+         else
+         {
+            reserve(rhs.size());
+            detail::relocate(this->get_alloc(), rhs.begin(), rhs.end(), m_Data);
+            m_Size = rhs.m_Size;
+         }
+
+         rhs.m_Size = 0;
+      }
+
+      pointer m_Data;
+      size_type m_Size;
+      size_type m_Capacity;
+      std::aligned_storage_t<sizeof(T), alignof(T)> m_Inline[N];
+   };
+
+   template <typename T, std::size_t N, typename Allocator, typename U>
+   std::size_t erase(small_vector<T, N, Allocator>& c, const U& value)
+   {
+      return c.remove_if([&value](const T& elem) { return elem == value; });
+   }
+
+   template <typename T, std::size_t N, typename Allocator, typename Pred>
+   std::size_t erase_if(small_vector<T, N, Allocator>& c, Pred pred)
+   {
+      return c.remove_if(pred);
+   }
+}
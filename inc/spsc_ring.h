@@ -0,0 +1,294 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "bounded_vector.h"
+
+namespace ntl
+{
+   // Lock-free single producer / single consumer queue over fixed inline
+   // storage. Exactly one thread may call the producer side (try_push,
+   // try_emplace, push_n) and exactly one thread the consumer side (try_pop,
+   // pop_n, peek, consume). size() and empty() are approximate when called
+   // concurrently.
+   template <typename T, std::size_t Capacity>
+   class spsc_ring
+   {
+      static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "spsc_ring capacity must be a power of two");
+
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+      using reference = value_type&;
+      using const_reference = const value_type&;
+      using pointer = value_type*;
+      using const_pointer = const value_type*;
+
+      // Contiguous run of readable elements; stays valid until consume()
+      class read_span
+      {
+      public:
+         read_span(const_pointer first, size_type count) noexcept :
+            m_First(first),
+            m_Count(count)
+         {
+         }
+
+         const_pointer data() const noexcept
+         {
+            return m_First;
+         }
+
+         size_type size() const noexcept
+         {
+            return m_Count;
+         }
+
+         bool empty() const noexcept
+         {
+            return m_Count == 0;
+         }
+
+         const_pointer begin() const noexcept
+         {
+            return m_First;
+         }
+
+         const_pointer end() const noexcept
+         {
+            return m_First + m_Count;
+         }
+
+         const_reference operator [](size_type n) const noexcept
+         {
+            return m_First[n];
+         }
+
+      private:
+         const_pointer m_First;
+         size_type m_Count;
+      };
+
+      spsc_ring() noexcept :
+         m_Head(0),
+         m_CachedTail(0),
+         m_Tail(0),
+         m_CachedHead(0)
+      {
+      }
+
+      spsc_ring(const spsc_ring&) = delete;
+      spsc_ring& operator = (const spsc_ring&) = delete;
+
+      ~spsc_ring()
+      {
+         size_type head = m_Head.load(std::memory_order_relaxed);
+         size_type tail = m_Tail.load(std::memory_order_relaxed);
+         for (; head != tail; ++head)
+         {
+            get_element_as_pointer(head)->~T();
+         }
+      }
+
+      constexpr size_type capacity() const noexcept
+      {
+         return Capacity;
+      }
+
+      size_type size() const noexcept
+      {
+         size_type head = m_Head.load(std::memory_order_acquire);
+         size_type tail = m_Tail.load(std::memory_order_acquire);
+         return tail - head;
+      }
+
+      bool empty() const noexcept
+      {
+         return size() == 0;
+      }
+
+      bool try_push(const T& elem)
+      {
+         return try_emplace(elem);
+      }
+
+      bool try_push(T&& elem)
+      {
+         return try_emplace(std::move(elem));
+      }
+
+      template <typename ... Args>
+      bool try_emplace(Args&&... args)
+      {
+         size_type tail = m_Tail.load(std::memory_order_relaxed);
+         if (free_slots(tail, 1) == 0)
+         {
+            return false;
+         }
+
+         ::new (static_cast<void*>(get_element_as_pointer(tail))) T(std::forward<Args>(args)...);
+         m_Tail.store(tail + 1, std::memory_order_release);
+         return true;
+      }
+
+      // Pushes as many of [src, src + count) as fit; returns the number pushed
+      size_type push_n(const T* src, size_type count)
+      {
+         size_type tail = m_Tail.load(std::memory_order_relaxed);
+         count = std::min(count, free_slots(tail, count));
+
+         size_type idx = tail & s_Mask;
+         size_type firstRun = std::min(count, Capacity - idx);
+         copy_into(get_element_as_pointer(tail), src, firstRun);
+         copy_into(get_element_as_pointer(0), src + firstRun, count - firstRun);
+
+         m_Tail.store(tail + count, std::memory_order_release);
+         return count;
+      }
+
+      bool try_pop(T& out)
+      {
+         size_type head = m_Head.load(std::memory_order_relaxed);
+         if (readable_slots(head, 1) == 0)
+         {
+            return false;
+         }
+
+         pointer elem = get_element_as_pointer(head);
+         out = std::move(*elem);
+         elem->~T();
+         m_Head.store(head + 1, std::memory_order_release);
+         return true;
+      }
+
+      // Pops up to count elements into dst; returns the number popped
+      size_type pop_n(T* dst, size_type count)
+      {
+         size_type head = m_Head.load(std::memory_order_relaxed);
+         count = std::min(count, readable_slots(head, count));
+
+         size_type idx = head & s_Mask;
+         size_type firstRun = std::min(count, Capacity - idx);
+         move_out_of(get_element_as_pointer(head), dst, firstRun);
+         move_out_of(get_element_as_pointer(0), dst + firstRun, count - firstRun);
+
+         m_Head.store(head + count, std::memory_order_release);
+         return count;
+      }
+
+      // Zero-copy view of the readable elements up to the wrap point. Call
+      // again after consume() to see elements past the wrap.
+      read_span peek() noexcept
+      {
+         size_type head = m_Head.load(std::memory_order_relaxed);
+         size_type count = std::min(readable_slots(head, Capacity), Capacity - (head & s_Mask));
+         return read_span(get_element_as_pointer(head), count);
+      }
+
+      // Releases count elements previously observed through peek()
+      void consume(size_type count) noexcept
+      {
+         size_type head = m_Head.load(std::memory_order_relaxed);
+         // Kept out of the assert so that it updates the cached tail the
+         // same way in every build; after a peek() it is only a compare
+         size_type readable = readable_slots(head, count);
+         assert(count <= readable);
+         (void)readable;
+
+         if (!std::is_trivially_destructible<T>::value)
+         {
+            for (size_type i = 0; i < count; ++i)
+            {
+               get_element_as_pointer(head + i)->~T();
+            }
+         }
+
+         m_Head.store(head + count, std::memory_order_release);
+      }
+
+   private:
+      static constexpr size_type s_Mask = Capacity - 1;
+
+      // Indices increase monotonically and are masked on access, so
+      // tail - head is the fill level even after the counters wrap.
+      pointer get_element_as_pointer(size_type idx) noexcept
+      {
+         return reinterpret_cast<pointer>(&m_Elems[idx & s_Mask]);
+      }
+
+      // Producer side: only touches the consumer's cache line when the cached
+      // head says fewer than wanted slots are free.
+      size_type free_slots(size_type tail, size_type wanted) noexcept
+      {
+         size_type available = Capacity - (tail - m_CachedHead);
+         if (available < wanted)
+         {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            available = Capacity - (tail - m_CachedHead);
+         }
+
+         return available;
+      }
+
+      // Consumer side counterpart of free_slots
+      size_type readable_slots(size_type head, size_type wanted) noexcept
+      {
+         size_type available = m_CachedTail - head;
+         if (available < wanted)
+         {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            available = m_CachedTail - head;
+         }
+
+         return available;
+      }
+
+      static void copy_into(pointer dst, const T* src, size_type count)
+      {
+         if (std::is_trivially_copyable<T>::value)
+         {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+         }
+         else
+         {
+            for (size_type i = 0; i < count; ++i)
+            {
+               ::new (static_cast<void*>(dst + i)) T(src[i]);
+            }
+         }
+      }
+
+      static void move_out_of(pointer src, T* dst, size_type count)
+      {
+         if (std::is_trivially_copyable<T>::value)
+         {
+            std::memcpy(static_cast<void*>(dst), static_cast<const void*>(src), count * sizeof(T));
+         }
+         else
+         {
+            for (size_type i = 0; i < count; ++i)
+            {
+               dst[i] = std::move(src[i]);
+               src[i].~T();
+            }
+         }
+      }
+
+      // Consumer-owned line: its index plus its cached view of the producer
+      alignas(cache_line_size) std::atomic<size_type> m_Head;
+      size_type m_CachedTail;
+
+      // Producer-owned line
+      alignas(cache_line_size) std::atomic<size_type> m_Tail;
+      size_type m_CachedHead;
+
+      alignas(std::max(cache_line_size, alignof(T))) std::aligned_storage_t<sizeof(T), alignof(T)> m_Elems[Capacity];
+   };
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+
+namespace ntl
+{
+   // Compile-time choice of whether a fixed-capacity container records how
+   // it is used. Each policy is constructed with the container's capacity
+   // and element size, and provides:
+   //   enabled        - false compiles every hook down to nothing
+   //   on_size(n)     - the container grew to n elements
+   //   on_overflow(n) - n elements did not fit
+   //   on_shift(n)    - insert or erase moved n existing elements
+   //
+   // Only the default lives here, so containers that never record anything
+   // do not pull in the registry; stats::tracked is in container_stats.h.
+   namespace stats
+   {
+      struct disabled
+      {
+         static constexpr bool enabled = false;
+
+         constexpr disabled(std::size_t, std::size_t) noexcept
+         {
+         }
+
+         constexpr void on_size(std::size_t) const noexcept
+         {
+         }
+
+         constexpr void on_overflow(std::size_t) const noexcept
+         {
+         }
+
+         constexpr void on_shift(std::size_t) const noexcept
+         {
+         }
+      };
+   }
+}
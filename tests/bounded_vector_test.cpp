@@ -0,0 +1,433 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "bounded_vector.h"
+#include "test.h"
+
+namespace
+{
+   // Counts live instances; once armed, the copy constructor throws on the
+   // Nth copy. With Relocatable the vector shifts it with memmove.
+   template <bool Relocatable>
+   struct counted
+   {
+      static int s_Live;
+      static int s_CopiesUntilThrow;
+
+      int m_Value;
+
+      explicit counted(int value) :
+         m_Value(value)
+      {
+         ++s_Live;
+      }
+
+      counted(const counted& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         if (s_CopiesUntilThrow > 0 && --s_CopiesUntilThrow == 0)
+         {
+            throw std::runtime_error("copy");
+         }
+
+         ++s_Live;
+      }
+
+      counted(counted&& rhs) noexcept :
+         m_Value(rhs.m_Value)
+      {
+         ++s_Live;
+      }
+
+      counted& operator = (const counted&) = default;
+      counted& operator = (counted&&) noexcept = default;
+
+      ~counted()
+      {
+         --s_Live;
+      }
+
+      bool operator == (const counted& rhs) const noexcept
+      {
+         return m_Value == rhs.m_Value;
+      }
+   };
+
+   template <bool Relocatable>
+   int counted<Relocatable>::s_Live = 0;
+
+   template <bool Relocatable>
+   int counted<Relocatable>::s_CopiesUntilThrow = 0;
+}
+
+namespace ntl
+{
+   template <>
+   struct is_trivially_relocatable<counted<true>> : std::true_type
+   {
+   };
+}
+
+namespace
+{
+   template <typename Vector>
+   bool holds_sequence(const Vector& v, int count)
+   {
+      if (v.size() != static_cast<std::size_t>(count))
+      {
+         return false;
+      }
+
+      for (int i = 0; i < count; ++i)
+      {
+         if (v[i].m_Value != i)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   void run_appends(test::context& ctx)
+   {
+      ntl::bounded_vector<std::string, 3> v;
+      std::string moved = "moved";
+      NTL_CHECK(v.try_push_back(std::string("a")) == v.data());
+      NTL_CHECK(v.try_push_back(moved) == v.data() + 1 && moved == "moved");
+      std::string* elem = v.try_emplace_back(2, 'c');
+      NTL_CHECK(elem == v.data() + 2 && *elem == "cc");
+
+      // Full: nothing is built, and the argument is not moved from
+      NTL_CHECK(v.try_push_back(std::move(moved)) == nullptr && moved == "moved");
+      NTL_CHECK(v.try_emplace_back(4, 'd') == nullptr);
+      NTL_CHECK(v.size() == 3 && v.back() == "cc");
+
+      v.clear();
+      std::string& first = v.unchecked_push_back(std::string("x"));
+      NTL_CHECK(&first == v.data() && first == "x");
+      NTL_CHECK(v.unchecked_push_back(moved) == "moved");
+      NTL_CHECK(v.unchecked_emplace_back(3, 'z') == "zzz");
+      NTL_CHECK(v.size() == 3 && v[1] == "moved");
+
+      ntl::bounded_vector<int, 2> ints;
+      NTL_CHECK(*ints.try_push_back(1) == 1);
+      ints.unchecked_emplace_back(2);
+      NTL_CHECK(ints.try_push_back(3) == nullptr);
+      NTL_CHECK(ints.size() == 2 && ints[0] == 1 && ints[1] == 2);
+   }
+
+   // Every checked path throws on a full vector or a bad index and leaves
+   // the contents alone
+   void run_throwing_checks(test::context& ctx)
+   {
+      ntl::bounded_vector<std::string, 4> v{ "a", "b", "c" };
+      NTL_CHECK_THROWS(v.at(3), std::out_of_range);
+      const auto& cv = v;
+      NTL_CHECK_THROWS(cv.at(7), std::out_of_range);
+      NTL_CHECK(v.at(2) == "c");
+
+      NTL_CHECK_THROWS(v.insert(v.cbegin(), 2, "x"), std::runtime_error);
+      NTL_CHECK_THROWS(v.insert(v.cbegin() + 1, { "x", "y" }), std::runtime_error);
+      NTL_CHECK_THROWS(v.resize(5), std::runtime_error);
+      NTL_CHECK_THROWS(v.resize(6, "x"), std::runtime_error);
+      NTL_CHECK(v.size() == 3 && v[0] == "a" && v[2] == "c");
+
+      v.push_back("d");
+      NTL_CHECK_THROWS(v.push_back("e"), std::runtime_error);
+      NTL_CHECK_THROWS(v.emplace_back(2, 'e'), std::runtime_error);
+      NTL_CHECK_THROWS(v.emplace(v.cbegin(), "e"), std::runtime_error);
+      NTL_CHECK_THROWS(v.insert(v.cend(), "e"), std::runtime_error);
+      NTL_CHECK(v.size() == 4 && v[0] == "a" && v[3] == "d");
+
+      ntl::bounded_vector<char, 8> bytes;
+      bytes.resize(5, 'x');
+      NTL_CHECK_THROWS(bytes.append_uninitialized(4), std::runtime_error);
+      NTL_CHECK_THROWS(bytes.resize_for_overwrite(9), std::runtime_error);
+      NTL_CHECK(bytes.append_uninitialized(3).size() == 3 && bytes.size() == 5);
+   }
+
+   void run_erase_unordered(test::context& ctx)
+   {
+      ntl::bounded_vector<std::string, 8> v{ "a", "b", "c", "d" };
+      auto it = v.erase_unordered(v.cbegin() + 1);
+      NTL_CHECK(it == v.begin() + 1 && *it == "d");
+      NTL_CHECK(v.size() == 3 && v[0] == "a" && v[2] == "c");
+
+      // The last element just goes
+      it = v.erase_unordered(v.cend() - 1);
+      NTL_CHECK(it == v.end() && v.size() == 2 && v[1] == "d");
+
+      it = v.erase_unordered(v.cbegin());
+      it = v.erase_unordered(v.cbegin());
+      NTL_CHECK(it == v.end() && v.empty());
+   }
+
+   // remove_if keeps the survivors in order and destroys exactly the
+   // removed elements
+   void run_remove_if(test::context& ctx)
+   {
+      using elem = counted<false>;
+
+      {
+         ntl::bounded_vector<elem, 16> v;
+         for (int i = 0; i < 10; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         NTL_CHECK(v.remove_if([](const elem& e) { return e.m_Value % 3 == 0; }) == 4);
+         NTL_CHECK(v.size() == 6 && elem::s_Live == 6);
+         const int survivors[] = { 1, 2, 4, 5, 7, 8 };
+         NTL_CHECK(std::equal(v.begin(), v.end(), std::begin(survivors), [](const elem& e, int value) { return e.m_Value == value; }));
+
+         NTL_CHECK(v.remove_if([](const elem& e) { return e.m_Value > 100; }) == 0);
+         NTL_CHECK(v.size() == 6);
+         NTL_CHECK(ntl::erase(v, elem(5)) == 1 && v.size() == 5 && v[3].m_Value == 7);
+         NTL_CHECK(ntl::erase_if(v, [](const elem&) { return true; }) == 5);
+         NTL_CHECK(v.empty() && elem::s_Live == 0);
+      }
+
+      // remove() copes with a value that refers into the vector
+      ntl::bounded_vector<std::string, 8> v{ "x", "y", "x", "z", "x" };
+      NTL_CHECK(v.remove(v[0]) == 3);
+      NTL_CHECK(v.size() == 2 && v[0] == "y" && v[1] == "z");
+   }
+
+   void run_resize(test::context& ctx)
+   {
+      ntl::bounded_vector<int, 8> v{ 1, 2 };
+      v.resize(5);
+      NTL_CHECK(v.size() == 5 && v[1] == 2 && v[2] == 0 && v[4] == 0);
+      v.resize(7, 9);
+      NTL_CHECK(v.size() == 7 && v[4] == 0 && v[5] == 9 && v[6] == 9);
+      v.resize(3);
+      NTL_CHECK(v.size() == 3 && v[2] == 0);
+      v.resize(3, 4);
+      NTL_CHECK(v.size() == 3);
+
+      // Non-trivial elements are value-initialized and destroyed
+      ntl::bounded_vector<std::string, 8> strings{ "a" };
+      strings.resize_for_overwrite(3);
+      NTL_CHECK(strings.size() == 3 && strings[0] == "a" && strings[2].empty());
+      strings.resize_for_overwrite(1);
+      NTL_CHECK(strings.size() == 1 && strings[0] == "a");
+   }
+
+   // resize_for_overwrite and append_uninitialized hand out slots for the
+   // caller to fill, as read() or recv() would
+   void run_uninitialized_fill(test::context& ctx)
+   {
+      const char msg[] = "hello, world";
+      const std::size_t len = sizeof(msg) - 1;
+
+      ntl::bounded_vector<char, 32> buf;
+      buf.push_back('>');
+      buf.resize_for_overwrite(1 + len);
+      std::memcpy(buf.data() + 1, msg, len);
+      NTL_CHECK(buf.size() == 1 + len && std::string(buf.begin(), buf.end()) == ">hello, world");
+
+      // Only what commit_append() covers becomes part of the vector
+      auto tail = buf.append_uninitialized(8);
+      NTL_CHECK(tail.size() == 8 && tail.data() == buf.data() + buf.size());
+      std::memcpy(tail.data(), "!?", 2);
+      buf.commit_append(1);
+      NTL_CHECK(buf.size() == 2 + len && buf.back() == '!');
+
+      tail = buf.append_uninitialized(buf.capacity() - buf.size());
+      NTL_CHECK(tail.size() == 32 - 2 - len);
+      buf.commit_append(0);
+      NTL_CHECK(buf.size() == 2 + len);
+
+      buf.resize_for_overwrite(4);
+      NTL_CHECK(std::string(buf.begin(), buf.end()) == ">hel");
+   }
+
+   // A copy that throws while resize() grows the vector undoes the growth
+   void run_throwing_resize(test::context& ctx)
+   {
+      using elem = counted<false>;
+
+      {
+         ntl::bounded_vector<elem, 16> v;
+         for (int i = 0; i < 3; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         elem::s_CopiesUntilThrow = 4;
+         NTL_CHECK_THROWS(v.resize(10, elem(7)), std::runtime_error);
+         elem::s_CopiesUntilThrow = 0;
+         NTL_CHECK(holds_sequence(v, 3));
+         NTL_CHECK(elem::s_Live == 3);
+
+         v.resize(5, elem(7));
+         NTL_CHECK(v.size() == 5 && v[4].m_Value == 7 && elem::s_Live == 5);
+      }
+
+      NTL_CHECK(elem::s_Live == 0);
+   }
+
+   // Moves may throw, and do on the Nth move once armed
+   struct move_throws
+   {
+      static int s_Live;
+      static int s_MovesUntilThrow;
+
+      int m_Value;
+
+      explicit move_throws(int value) :
+         m_Value(value)
+      {
+         ++s_Live;
+      }
+
+      move_throws(const move_throws& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         ++s_Live;
+      }
+
+      move_throws(move_throws&& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         count_move();
+         ++s_Live;
+      }
+
+      move_throws& operator = (const move_throws&) = default;
+
+      move_throws& operator = (move_throws&& rhs)
+      {
+         count_move();
+         m_Value = rhs.m_Value;
+         return *this;
+      }
+
+      ~move_throws()
+      {
+         --s_Live;
+      }
+
+      static void count_move()
+      {
+         if (s_MovesUntilThrow > 0 && --s_MovesUntilThrow == 0)
+         {
+            throw std::runtime_error("move");
+         }
+      }
+   };
+
+   int move_throws::s_Live = 0;
+   int move_throws::s_MovesUntilThrow = 0;
+
+   // emplace and insert with a throwing move never leave a slot without an
+   // object inside size(): either nothing changed, or every element is
+   // still there, perhaps out of order
+   void run_throwing_move(test::context& ctx)
+   {
+      {
+         ntl::bounded_vector<move_throws, 16> v;
+         for (int i = 0; i < 6; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         // Moving the temporary into place throws: nothing changes
+         move_throws::s_MovesUntilThrow = 1;
+         NTL_CHECK_THROWS(v.emplace(v.cbegin() + 2, 9), std::runtime_error);
+         move_throws::s_MovesUntilThrow = 0;
+         NTL_CHECK(holds_sequence(v, 6));
+         NTL_CHECK(move_throws::s_Live == 6);
+
+         // Rotating the new element into place throws: it stays, and every
+         // slot inside size() holds an object
+         move_throws::s_MovesUntilThrow = 3;
+         NTL_CHECK_THROWS(v.emplace(v.cbegin() + 2, 9), std::runtime_error);
+         move_throws::s_MovesUntilThrow = 0;
+         NTL_CHECK(v.size() == 7);
+         NTL_CHECK(move_throws::s_Live == 7);
+         int sum = 0;
+         for (const move_throws& e : v)
+         {
+            sum += e.m_Value;
+         }
+
+         NTL_CHECK(sum == 0 + 1 + 2 + 3 + 4 + 5 + 9);
+
+         v.clear();
+         for (int i = 0; i < 4; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         v.emplace(v.cbegin() + 1, 7);
+         v.insert(v.cbegin(), 2, move_throws(8));
+         NTL_CHECK(v.size() == 7 && v[0].m_Value == 8 && v[1].m_Value == 8 && v[2].m_Value == 0 && v[3].m_Value == 7 && v[6].m_Value == 3);
+      }
+
+      NTL_CHECK(move_throws::s_Live == 0);
+   }
+
+   // A copy that throws partway through an insert leaves the vector as it
+   // was: no slot without an object inside size(), nothing destroyed twice
+   template <bool Relocatable>
+   void run_throwing_insert(test::context& ctx)
+   {
+      using elem = counted<Relocatable>;
+
+      {
+         ntl::bounded_vector<elem, 16> v;
+         for (int i = 0; i < 5; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         // The first copy is the temporary, the next ones fill the gap
+         elem::s_CopiesUntilThrow = 3;
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 2, 3, elem(9)), std::runtime_error);
+         elem::s_CopiesUntilThrow = 0;
+         NTL_CHECK(holds_sequence(v, 5));
+         NTL_CHECK(elem::s_Live == 5);
+
+         // A gap wider than the tail reaches past the old end
+         elem::s_CopiesUntilThrow = 5;
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 4, 6, elem(9)), std::runtime_error);
+         elem::s_CopiesUntilThrow = 0;
+         NTL_CHECK(holds_sequence(v, 5));
+         NTL_CHECK(elem::s_Live == 5);
+
+         const std::vector<elem> more = { elem(7), elem(8), elem(9) };
+         elem::s_CopiesUntilThrow = 3;
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 1, more.begin(), more.end()), std::runtime_error);
+         elem::s_CopiesUntilThrow = 0;
+         NTL_CHECK(holds_sequence(v, 5));
+         NTL_CHECK(elem::s_Live == 5 + 3);
+
+         v.insert(v.cbegin() + 1, more.begin(), more.end());
+         NTL_CHECK(v.size() == 8 && v[1].m_Value == 7 && v[3].m_Value == 9 && v[4].m_Value == 1 && v[7].m_Value == 4);
+      }
+
+      NTL_CHECK(elem::s_Live == 0);
+   }
+}
+
+NTL_TEST_SUITE(bounded_vector)
+{
+   run_appends(ctx);
+   run_throwing_checks(ctx);
+   run_erase_unordered(ctx);
+   run_remove_if(ctx);
+   run_resize(ctx);
+   run_uninitialized_fill(ctx);
+   run_throwing_resize(ctx);
+   run_throwing_insert<false>(ctx);
+   run_throwing_insert<true>(ctx);
+   run_throwing_move(ctx);
+}
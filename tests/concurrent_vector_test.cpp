@@ -0,0 +1,184 @@
+#include <atomic>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "concurrent_bounded_vector.h"
+#include "test.h"
+
+namespace
+{
+   // Throws from the constructor for one chosen value
+   struct fragile
+   {
+      static int s_ThrowOn;
+      static int s_Live;
+
+      int m_Value;
+
+      explicit fragile(int value) :
+         m_Value(value)
+      {
+         if (value == s_ThrowOn)
+         {
+            throw std::runtime_error("construct");
+         }
+
+         ++s_Live;
+      }
+
+      fragile(const fragile&) = delete;
+      fragile& operator = (const fragile&) = delete;
+
+      ~fragile()
+      {
+         --s_Live;
+      }
+   };
+
+   int fragile::s_ThrowOn = -1;
+   int fragile::s_Live = 0;
+
+   void run_abandoned_slots(test::context& ctx)
+   {
+      {
+         ntl::concurrent_bounded_vector<fragile, 8> v;
+         v.emplace_back(1);
+         fragile::s_ThrowOn = 2;
+         NTL_CHECK_THROWS(v.emplace_back(2), std::runtime_error);
+         fragile::s_ThrowOn = -1;
+         v.emplace_back(3);
+
+         // The abandoned slot counts toward the prefix but is never read
+         NTL_CHECK(v.size() == 3 && v.published_size() == 3);
+         NTL_CHECK(!v.is_published(1) && v.try_get(1) == nullptr);
+         NTL_CHECK(v.try_get(2) != nullptr && v[2].m_Value == 3);
+
+         auto view = v.published();
+         NTL_CHECK(view.slot_count() == 3);
+         std::vector<int> seen;
+         for (const fragile& elem : view)
+         {
+            seen.push_back(elem.m_Value);
+         }
+
+         NTL_CHECK(seen == std::vector<int>({ 1, 3 }));
+
+         // An existing view does not grow with later appends
+         v.emplace_back(4);
+         NTL_CHECK(view.slot_count() == 3 && v.published_size() == 4);
+         NTL_CHECK(fragile::s_Live == 3);
+
+         // clear destroys the published elements and starts over
+         v.clear();
+         NTL_CHECK(fragile::s_Live == 0);
+         NTL_CHECK(v.empty() && v.published_size() == 0 && v.try_get(0) == nullptr);
+         v.emplace_back(5);
+         NTL_CHECK(v.published_size() == 1 && v[0].m_Value == 5);
+
+         // An abandoned slot at the end of the buffer, and nothing past it
+         for (int i = 6; i < 12; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         fragile::s_ThrowOn = 12;
+         NTL_CHECK_THROWS(v.emplace_back(12), std::runtime_error);
+         fragile::s_ThrowOn = -1;
+         NTL_CHECK(v.full() && v.try_emplace_back(13) == nullptr);
+         NTL_CHECK_THROWS(v.emplace_back(13), std::runtime_error);
+         NTL_CHECK(v.published_size() == 8 && fragile::s_Live == 7);
+      }
+
+      NTL_CHECK(fragile::s_Live == 0);
+   }
+
+   // Appenders race each other while a reader keeps walking the published
+   // prefix; everything it sees must be complete and in each appender's order
+   void run_threads(test::context& ctx)
+   {
+      constexpr unsigned numAppenders = 4;
+      constexpr std::uint32_t perAppender = 5000;
+
+      // Too big for the stack, and over-aligned for operator new before C++17
+      static ntl::concurrent_bounded_vector<std::uint64_t, numAppenders * perAppender> v;
+      std::atomic<unsigned> finished(0);
+      std::atomic<bool> readerOk(true);
+
+      std::thread reader([&finished, &readerOk]()
+      {
+         while (finished.load(std::memory_order_acquire) != numAppenders)
+         {
+            std::vector<std::uint32_t> next(numAppenders, 0);
+            for (std::uint64_t value : v.published())
+            {
+               std::uint32_t appender = static_cast<std::uint32_t>(value >> 32);
+               if (appender >= numAppenders || static_cast<std::uint32_t>(value) < next[appender])
+               {
+                  readerOk.store(false, std::memory_order_relaxed);
+               }
+               else
+               {
+                  next[appender] = static_cast<std::uint32_t>(value) + 1;
+               }
+            }
+
+            std::this_thread::yield();
+         }
+      });
+
+      std::vector<std::thread> appenders;
+      for (unsigned a = 0; a < numAppenders; ++a)
+      {
+         appenders.emplace_back([&finished, a]()
+         {
+            for (std::uint32_t i = 0; i < perAppender; ++i)
+            {
+               std::uint64_t value = static_cast<std::uint64_t>(a) << 32 | i;
+               if (i % 2 == 0)
+               {
+                  v.push_back(value);
+               }
+               else
+               {
+                  v.try_emplace_back(value);
+               }
+            }
+
+            finished.fetch_add(1, std::memory_order_release);
+         });
+      }
+
+      for (std::thread& th : appenders)
+      {
+         th.join();
+      }
+
+      reader.join();
+      NTL_CHECK(readerOk.load());
+      NTL_CHECK(v.full() && v.published_size() == v.capacity());
+      NTL_CHECK(v.try_push_back(0) == nullptr);
+
+      // Every value exactly once
+      std::vector<std::uint32_t> next(numAppenders, 0);
+      bool inOrder = true;
+      for (std::uint64_t value : v.published())
+      {
+         std::uint32_t appender = static_cast<std::uint32_t>(value >> 32);
+         inOrder = inOrder && appender < numAppenders && static_cast<std::uint32_t>(value) == next[appender]++;
+      }
+
+      NTL_CHECK(inOrder);
+      NTL_CHECK(next == std::vector<std::uint32_t>(numAppenders, perAppender));
+
+      v.clear();
+      NTL_CHECK(v.empty() && v.published_size() == 0);
+   }
+}
+
+NTL_TEST_SUITE(concurrent_vector)
+{
+   run_abandoned_slots(ctx);
+   run_threads(ctx);
+}
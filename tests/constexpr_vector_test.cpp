@@ -0,0 +1,141 @@
+#include <cstdint>
+#include <utility>
+
+#include "bounded_vector.h"
+#include "test.h"
+
+// Every helper here runs twice: inside static_asserts during constant
+// evaluation, where bounded_vector avoids memcpy and SIMD, and again at run
+// time through the suite. Both must agree. Before C++20 only the run time
+// half is built.
+namespace
+{
+   using crc_table_type = ntl::bounded_vector<std::uint32_t, 256>;
+
+   constexpr std::uint32_t crc32_polynomial = 0xEDB88320u;
+
+   NTL_CONSTEXPR20 crc_table_type make_crc32_table(std::uint32_t polynomial)
+   {
+      crc_table_type table;
+      for (std::uint32_t i = 0; i < 256; ++i)
+      {
+         std::uint32_t crc = i;
+         for (int bit = 0; bit < 8; ++bit)
+         {
+            crc = (crc & 1) != 0 ? polynomial ^ (crc >> 1) : crc >> 1;
+         }
+
+         table.push_back(crc);
+      }
+
+      return table;
+   }
+
+   // Character classes for a tokenizer, one bounded_vector per class
+   struct char_class_table
+   {
+      ntl::bounded_vector<char, 64> m_Digits;
+      ntl::bounded_vector<char, 64> m_Letters;
+      ntl::bounded_vector<char, 64> m_Punct;
+   };
+
+   NTL_CONSTEXPR20 char_class_table make_char_class_table()
+   {
+      char_class_table t;
+      for (int c = 0x21; c < 0x7F; ++c)
+      {
+         char ch = static_cast<char>(c);
+         if (ch >= '0' && ch <= '9')
+         {
+            t.m_Digits.push_back(ch);
+         }
+         else if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'))
+         {
+            t.m_Letters.push_back(ch);
+         }
+         else
+         {
+            t.m_Punct.push_back(ch);
+         }
+      }
+
+      return t;
+   }
+
+   // The modifiers and comparisons
+   NTL_CONSTEXPR20 int exercise_modifiers()
+   {
+      ntl::bounded_vector<int, 16> v{ 5, 1, 4 };
+      v.insert(v.begin() + 1, 9);
+      v.insert(v.end(), 2, 7);
+      v.erase(v.begin());
+      v.erase_unordered(v.begin());
+      ntl::erase(v, 7);
+      v.emplace(v.begin(), 3);
+
+      ntl::bounded_vector<int, 16> w = v;
+      if (w != v || v.count(4) != 1 || v.find(1) != v.begin() + 1)
+      {
+         return -1;
+      }
+
+      w.push_back(0);
+      if (!(v < w))
+      {
+         return -2;
+      }
+
+      ntl::bounded_vector<int, 16> moved = std::move(w);
+      moved.pop_back();
+      moved.clear();
+      v.assign({ 1, 2, 3, 4 });
+      ntl::erase_if(v, [](int x) { return x % 2 == 0; });
+      return v.front() * 10 + v.back() + static_cast<int>(moved.size());
+   }
+
+   NTL_CONSTEXPR20 int exercise_resize()
+   {
+      ntl::bounded_vector<int, 8> v{ 1, 2 };
+      v.resize(4);
+      v.resize(5, 9);
+      v.resize_for_overwrite(6);
+      v[5] = 4;
+      ntl::span<int> slots = v.append_uninitialized(2);
+      slots[0] = 3;
+      v.commit_append(1);
+      v.resize(6);
+      return v[2] + v[4] + v[5] + static_cast<int>(v.size());
+   }
+
+#if NTL_CONSTEXPR_CONTAINERS
+   constexpr crc_table_type s_Crc32Table = make_crc32_table(crc32_polynomial);
+
+   static_assert(s_Crc32Table.size() == 256, "one entry per byte value");
+   static_assert(s_Crc32Table[1] == 0x77073096u && s_Crc32Table[255] == 0x2D02EF8Du, "CRC-32 reference values");
+
+   constexpr char_class_table s_CharClasses = make_char_class_table();
+
+   static_assert(s_CharClasses.m_Digits.size() == 10 && s_CharClasses.m_Letters.size() == 52, "ASCII classes");
+   static_assert(s_CharClasses.m_Punct.contains('+') && !s_CharClasses.m_Punct.contains('a'), "constexpr find");
+
+   static_assert(exercise_modifiers() == 13, "constexpr modifiers");
+   static_assert(exercise_resize() == 19, "constexpr resize");
+#endif
+}
+
+NTL_TEST_SUITE(constexpr_vector)
+{
+   crc_table_type crcTable = make_crc32_table(crc32_polynomial);
+   NTL_CHECK(crcTable.size() == 256);
+   NTL_CHECK(crcTable[1] == 0x77073096u && crcTable[255] == 0x2D02EF8Du);
+#if NTL_CONSTEXPR_CONTAINERS
+   NTL_CHECK(crcTable == s_Crc32Table);
+#endif
+
+   char_class_table charClasses = make_char_class_table();
+   NTL_CHECK(charClasses.m_Digits.size() == 10 && charClasses.m_Letters.size() == 52);
+   NTL_CHECK(charClasses.m_Punct.contains('+') && !charClasses.m_Punct.contains('a'));
+
+   NTL_CHECK(exercise_modifiers() == 13);
+   NTL_CHECK(exercise_resize() == 19);
+}
@@ -0,0 +1,151 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "bounded_vector.h"
+#include "container_stats.h"
+#include "test.h"
+
+namespace
+{
+   using tracked_vector = ntl::bounded_vector<int, 8, std::allocator<int>, ntl::overflow::drop, ntl::stats::tracked>;
+
+   std::size_t instances_named(const char* name)
+   {
+      std::size_t count = 0;
+      ntl::stats::for_each_instance([name, &count](const ntl::stats::tracked& t)
+      {
+         if (std::strcmp(t.name(), name) == 0)
+         {
+            ++count;
+         }
+      });
+
+      return count;
+   }
+
+   // Every copy links itself into the registry and every destruction
+   // unlinks, whatever order they go in
+   void run_registry(test::context& ctx)
+   {
+      NTL_CHECK(instances_named("registry") == 0);
+      {
+         std::unique_ptr<tracked_vector> a(new tracked_vector());
+         a->get_stats().set_name("registry");
+         NTL_CHECK(instances_named("registry") == 1);
+
+         tracked_vector b(*a);
+         tracked_vector c(std::move(b));
+         NTL_CHECK(instances_named("registry") == 3);
+         NTL_CHECK(std::strcmp(c.get_stats().name(), "registry") == 0);
+
+         // Unlink the head, the middle and the tail of the list
+         a.reset();
+         NTL_CHECK(instances_named("registry") == 2);
+         {
+            tracked_vector d(c);
+            tracked_vector e(c);
+            NTL_CHECK(instances_named("registry") == 4);
+         }
+
+         NTL_CHECK(instances_named("registry") == 2);
+      }
+
+      NTL_CHECK(instances_named("registry") == 0);
+   }
+
+   // The counters follow what the vector actually did
+   void run_counters(test::context& ctx)
+   {
+      tracked_vector v;
+      const ntl::stats::tracked& stats = v.get_stats();
+      NTL_CHECK(stats.capacity() == 8 && stats.element_size() == sizeof(int));
+
+      for (int i = 0; i < 5; ++i)
+      {
+         v.push_back(i);
+      }
+
+      NTL_CHECK(stats.high_water() == 5 && stats.shifted() == 0);
+
+      // Inserting at the front moves all five, erasing the front moves them back
+      v.insert(v.cbegin(), 9);
+      NTL_CHECK(stats.shifted() == 5 && stats.high_water() == 6);
+      v.erase(v.cbegin());
+      NTL_CHECK(stats.shifted() == 10 && v.size() == 5);
+
+      // Three of six fit; the other three, and a push onto the full vector, overflow
+      v.insert(v.cend(), { 1, 2, 3, 4, 5, 6 });
+      NTL_CHECK(v.size() == 8 && stats.high_water() == 8 && stats.overflows() == 3);
+      v.push_back(7);
+      NTL_CHECK(stats.overflows() == 4);
+
+      // Shrinking keeps the high-water mark; unordered erase shifts one element
+      v.resize(2);
+      v.erase_unordered(v.cbegin());
+      NTL_CHECK(stats.high_water() == 8 && stats.shifted() == 11 && stats.unused_bytes() == 0);
+
+      // A copy starts from the source's high-water mark with fresh event counters
+      tracked_vector copy(v);
+      NTL_CHECK(copy.get_stats().high_water() == 8);
+      NTL_CHECK(copy.get_stats().overflows() == 0 && copy.get_stats().shifted() == 0);
+
+      v.get_stats().reset();
+      NTL_CHECK(stats.high_water() == 0 && stats.overflows() == 0 && stats.shifted() == 0);
+      v.push_back(1);
+      NTL_CHECK(stats.high_water() == 2 && stats.unused_bytes() == 6 * sizeof(int));
+
+      // Assignment keeps the larger mark
+      v = copy;
+      NTL_CHECK(stats.high_water() == 8);
+   }
+
+   std::string dump_to_string()
+   {
+      std::string text;
+      std::FILE* f = std::tmpfile();
+      if (f != nullptr)
+      {
+         ntl::stats::dump(f);
+         std::rewind(f);
+         char buf[256];
+         std::size_t n;
+         while ((n = std::fread(buf, 1, sizeof(buf), f)) > 0)
+         {
+            text.append(buf, n);
+         }
+
+         std::fclose(f);
+      }
+
+      return text;
+   }
+
+   void run_dump(test::context& ctx)
+   {
+      tracked_vector v;
+      v.get_stats().set_name("dumped");
+      v.resize(6);
+      v.insert(v.cend(), 4, 1);
+
+      std::string text = dump_to_string();
+      NTL_CHECK(text.compare(0, 4, "name") == 0);
+      NTL_CHECK(text.find("unused_bytes") != std::string::npos);
+
+      // name, capacity, elem_size, high_water, used%, overflows, shifted, unused_bytes
+      char expected[128];
+      std::snprintf(expected, sizeof(expected), "%-24s %10zu %10zu %10zu %5.1f%% %10zu %12zu %12zu\n",
+         "dumped", std::size_t(8), sizeof(int), std::size_t(8), 100.0, std::size_t(2), std::size_t(0), std::size_t(0));
+      NTL_CHECK(text.find(expected) != std::string::npos);
+   }
+}
+
+NTL_TEST_SUITE(container_stats)
+{
+   run_registry(ctx);
+   run_counters(ctx);
+   run_dump(ctx);
+}
@@ -0,0 +1,141 @@
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "bounded_flat_map.h"
+#include "test.h"
+
+namespace
+{
+   template <typename Map, typename Ref>
+   bool same_contents(const Map& m, const Ref& ref)
+   {
+      if (m.size() != ref.size())
+      {
+         return false;
+      }
+
+      auto expected = ref.begin();
+      for (auto it = m.begin(); it != m.end(); ++it, ++expected)
+      {
+         if (it.key() != expected->first || it.value() != expected->second)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   // Bulk inserts into std::map keep the first of equal keys, as the flat
+   // map does
+   template <typename Map>
+   void run_differential(test::context& ctx)
+   {
+      std::mt19937 rng(11);
+      Map m;
+      const int keyRange = static_cast<int>(m.capacity() * 3);
+      std::map<int, std::string> ref;
+      for (int i = 0; i < 20000; ++i)
+      {
+         int key = static_cast<int>(rng() % keyRange);
+         switch (rng() % 4)
+         {
+         case 0:
+         case 1:
+            if (ref.size() < m.capacity() || ref.count(key) != 0)
+            {
+               auto result = m.try_emplace(key, std::to_string(i));
+               auto expected = ref.emplace(key, std::to_string(i));
+               NTL_CHECK(result.second == expected.second);
+               NTL_CHECK(result.first.value() == expected.first->second);
+            }
+            else
+            {
+               NTL_CHECK_THROWS(m.try_emplace(key, "x"), std::runtime_error);
+            }
+            break;
+         case 2:
+            NTL_CHECK(m.erase(key) == ref.erase(key));
+            break;
+         default:
+         {
+            std::vector<std::pair<int, std::string>> batch;
+            for (unsigned n = rng() % 8; n > 0; --n)
+            {
+               batch.emplace_back(static_cast<int>(rng() % keyRange), std::to_string(i));
+            }
+
+            std::map<int, std::string> merged = ref;
+            merged.insert(batch.begin(), batch.end());
+            if (merged.size() <= m.capacity())
+            {
+               m.insert(batch.begin(), batch.end());
+               ref = merged;
+            }
+            else
+            {
+               // A range that does not fit throws and leaves a sorted map
+               // holding a subset of the union
+               NTL_CHECK_THROWS(m.insert(batch.begin(), batch.end()), std::runtime_error);
+               ref.clear();
+               for (auto it = m.begin(); it != m.end(); ++it)
+               {
+                  NTL_CHECK(merged.count(it.key()) == 1);
+                  ref.emplace(it.key(), it.value());
+               }
+            }
+            break;
+         }
+         }
+
+         NTL_CHECK(same_contents(m, ref));
+         if (i % 101 == 0)
+         {
+            for (int k = -1; k <= keyRange; ++k)
+            {
+               NTL_CHECK(m.contains(k) == (ref.count(k) == 1));
+               NTL_CHECK(m.lower_bound(k) - m.begin() == std::distance(ref.begin(), ref.lower_bound(k)));
+               NTL_CHECK(m.upper_bound(k) - m.begin() == std::distance(ref.begin(), ref.upper_bound(k)));
+            }
+         }
+      }
+   }
+
+   template <typename SearchPolicy>
+   void run_full_bulk_insert(test::context& ctx)
+   {
+      using map_type = ntl::bounded_flat_map<int, int, 4, std::less<int>, SearchPolicy>;
+
+      // Keys already present need no room, so neither of these throws
+      map_type m{ { 1, 1 }, { 2, 2 }, { 3, 3 }, { 4, 4 } };
+      std::pair<int, int> present[] = { { 1, 9 }, { 4, 9 }, { 1, 8 } };
+      m.insert(std::begin(present), std::end(present));
+      NTL_CHECK(m.size() == 4);
+      NTL_CHECK(m.at(1) == 1 && m.at(4) == 4);
+
+      // The union fits even though the map is full partway through
+      map_type half{ { 1, 1 }, { 2, 2 } };
+      std::pair<int, int> overlap[] = { { 3, 3 }, { 4, 4 }, { 1, 9 }, { 3, 9 }, { 2, 9 } };
+      half.insert(std::begin(overlap), std::end(overlap));
+      NTL_CHECK(half == m);
+
+      std::pair<int, int> absent[] = { { 2, 9 }, { 5, 5 } };
+      NTL_CHECK_THROWS(m.insert(std::begin(absent), std::end(absent)), std::runtime_error);
+      NTL_CHECK(half == m);
+   }
+}
+
+NTL_TEST_SUITE(flat_map)
+{
+   run_differential<ntl::bounded_flat_map<int, std::string, 64>>(ctx);
+   run_differential<ntl::bounded_flat_map<int, std::string, 64, std::less<int>, ntl::flat_search::eytzinger>>(ctx);
+   run_differential<ntl::bounded_flat_map<int, std::string, 5>>(ctx);
+   run_differential<ntl::bounded_flat_map<int, std::string, 5, std::less<int>, ntl::flat_search::eytzinger>>(ctx);
+   run_full_bulk_insert<ntl::flat_search::binary>(ctx);
+   run_full_bulk_insert<ntl::flat_search::eytzinger>(ctx);
+}
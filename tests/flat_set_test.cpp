@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bounded_flat_set.h"
+#include "test.h"
+
+namespace
+{
+   template <typename Set, typename Ref>
+   bool same_contents(const Set& s, const Ref& ref)
+   {
+      return s.size() == ref.size() && std::equal(s.begin(), s.end(), ref.begin());
+   }
+
+   template <typename Set>
+   void run_differential(test::context& ctx)
+   {
+      std::mt19937 rng(13);
+      Set s;
+      const int keyRange = static_cast<int>(s.capacity() * 3);
+      std::set<int> ref;
+      for (int i = 0; i < 20000; ++i)
+      {
+         int key = static_cast<int>(rng() % keyRange);
+         switch (rng() % 4)
+         {
+         case 0:
+         case 1:
+            if (ref.size() < s.capacity() || ref.count(key) != 0)
+            {
+               auto result = s.insert(key);
+               auto expected = ref.insert(key);
+               NTL_CHECK(result.second == expected.second);
+               NTL_CHECK(*result.first == *expected.first);
+            }
+            else
+            {
+               NTL_CHECK_THROWS(s.insert(key), std::runtime_error);
+            }
+            break;
+         case 2:
+            NTL_CHECK(s.erase(key) == ref.erase(key));
+            break;
+         default:
+         {
+            std::vector<int> batch;
+            for (unsigned n = rng() % 8; n > 0; --n)
+            {
+               batch.push_back(static_cast<int>(rng() % keyRange));
+            }
+
+            std::set<int> merged = ref;
+            merged.insert(batch.begin(), batch.end());
+            if (merged.size() <= s.capacity())
+            {
+               s.insert(batch.begin(), batch.end());
+               ref = merged;
+            }
+            else
+            {
+               // A range that does not fit throws and leaves a sorted set
+               // holding a subset of the union
+               NTL_CHECK_THROWS(s.insert(batch.begin(), batch.end()), std::runtime_error);
+               NTL_CHECK(std::includes(merged.begin(), merged.end(), s.begin(), s.end()));
+               ref.clear();
+               ref.insert(s.begin(), s.end());
+               NTL_CHECK(ref.size() == s.size());
+            }
+            break;
+         }
+         }
+
+         NTL_CHECK(same_contents(s, ref));
+         if (i % 101 == 0)
+         {
+            for (int k = -1; k <= keyRange; ++k)
+            {
+               NTL_CHECK(s.contains(k) == (ref.count(k) == 1));
+               NTL_CHECK(s.lower_bound(k) - s.begin() == std::distance(ref.begin(), ref.lower_bound(k)));
+               NTL_CHECK(s.upper_bound(k) - s.begin() == std::distance(ref.begin(), ref.upper_bound(k)));
+            }
+         }
+      }
+   }
+
+   template <typename SearchPolicy>
+   void run_full_bulk_insert(test::context& ctx)
+   {
+      using set_type = ntl::bounded_flat_set<int, 4, std::less<int>, SearchPolicy>;
+
+      // Keys already present need no room, so neither of these throws
+      set_type s{ 1, 2, 3, 4 };
+      int present[] = { 2 };
+      s.insert(std::begin(present), std::end(present));
+      int repeated[] = { 4, 1, 4 };
+      s.insert(std::begin(repeated), std::end(repeated));
+      NTL_CHECK(s.size() == 4);
+
+      // The union fits even though the set is full partway through
+      set_type half{ 4, 2 };
+      int overlap[] = { 3, 1, 2, 3, 4 };
+      half.insert(std::begin(overlap), std::end(overlap));
+      NTL_CHECK(half == s);
+
+      int absent[] = { 3, 5 };
+      NTL_CHECK_THROWS(s.insert(std::begin(absent), std::end(absent)), std::runtime_error);
+      NTL_CHECK(half == s);
+   }
+}
+
+NTL_TEST_SUITE(flat_set)
+{
+   run_differential<ntl::bounded_flat_set<int, 64>>(ctx);
+   run_differential<ntl::bounded_flat_set<int, 64, std::less<int>, ntl::flat_search::eytzinger>>(ctx);
+   run_differential<ntl::bounded_flat_set<int, 5>>(ctx);
+   run_differential<ntl::bounded_flat_set<int, 5, std::less<int>, ntl::flat_search::eytzinger>>(ctx);
+   run_full_bulk_insert<ntl::flat_search::binary>(ctx);
+   run_full_bulk_insert<ntl::flat_search::eytzinger>(ctx);
+
+   // Equal keys within one range keep the first occurrence
+   struct first_digit
+   {
+      bool operator () (const std::string& a, const std::string& b) const
+      {
+         return a[0] < b[0];
+      }
+   };
+
+   std::vector<std::string> words = { "b2", "a1", "b1", "c1", "a2", "b3" };
+   ntl::bounded_flat_set<std::string, 6, first_digit> byFirst(words.begin(), words.end());
+   std::vector<std::string> expected = { "a1", "b2", "c1" };
+   NTL_CHECK(std::equal(byFirst.begin(), byFirst.end(), expected.begin(), expected.end()));
+}
@@ -0,0 +1,137 @@
+#include <cstddef>
+#include <functional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+
+#include "bounded_hash_map.h"
+#include "test.h"
+
+namespace
+{
+   // Sends every key to one of a few buckets, so probe clusters run long
+   // and wrap around the slot array
+   struct colliding_hash
+   {
+      std::size_t operator()(int key) const noexcept
+      {
+         return static_cast<std::size_t>(key % 7);
+      }
+   };
+
+   static_assert(std::is_nothrow_move_constructible<ntl::bounded_hash_map<std::string, std::string, 8>>::value, "");
+   static_assert(std::is_nothrow_move_assignable<ntl::bounded_hash_map<std::string, std::string, 8>>::value, "");
+
+   // Copying a std::function hasher may allocate
+   static_assert(!std::is_nothrow_move_constructible<ntl::bounded_hash_map<int, int, 8, std::function<std::size_t(int)>>>::value, "");
+   static_assert(!std::is_nothrow_move_assignable<ntl::bounded_hash_map<int, int, 8, std::function<std::size_t(int)>>>::value, "");
+
+   int int_key(int i)
+   {
+      return i;
+   }
+
+   std::string string_key(int i)
+   {
+      // Longer than any small string buffer
+      return std::to_string(i) + "-padding-past-the-sso-buffer";
+   }
+
+   // Random inserts and erases against std::unordered_map, comparing every
+   // result and, now and then, the whole contents
+   template <typename Map, typename MakeKey>
+   void run_differential(test::context& ctx, MakeKey makeKey, int keyRange, int ops)
+   {
+      using key_type = typename Map::key_type;
+
+      std::mt19937 rng(7);
+      Map m;
+      std::unordered_map<key_type, int> ref;
+      for (int i = 0; i < ops; ++i)
+      {
+         key_type key = makeKey(static_cast<int>(rng() % keyRange));
+         if (rng() % 3 != 0)
+         {
+            if (ref.size() < m.capacity() || ref.count(key) != 0)
+            {
+               auto result = m.try_emplace(key, i);
+               auto expected = ref.emplace(key, i);
+               NTL_CHECK(result.second == expected.second);
+               NTL_CHECK(result.first.value() == expected.first->second);
+            }
+            else
+            {
+               NTL_CHECK_THROWS(m.try_emplace(key, i), std::runtime_error);
+            }
+         }
+         else
+         {
+            NTL_CHECK(m.erase(key) == ref.erase(key));
+         }
+
+         NTL_CHECK(m.size() == ref.size());
+         if (i % 97 == 0)
+         {
+            for (int k = 0; k < keyRange; ++k)
+            {
+               key_type probe = makeKey(k);
+               auto it = m.find(probe);
+               auto expected = ref.find(probe);
+               NTL_CHECK((it == m.end()) == (expected == ref.end()));
+               if (expected != ref.end() && it != m.end())
+               {
+                  NTL_CHECK(it.key() == probe);
+                  NTL_CHECK(it.value() == expected->second);
+               }
+            }
+
+            std::size_t visited = 0;
+            for (auto it = m.begin(); it != m.end(); ++it)
+            {
+               NTL_CHECK(ref.count(it.key()) == 1);
+               ++visited;
+            }
+
+            NTL_CHECK(visited == ref.size());
+         }
+      }
+
+      Map copy(m);
+      NTL_CHECK(copy == m);
+      Map moved(std::move(copy));
+      NTL_CHECK(moved == m);
+      copy = m;
+      NTL_CHECK(copy == m);
+      copy.clear();
+      NTL_CHECK(copy.empty());
+      NTL_CHECK(copy.begin() == copy.end());
+      NTL_CHECK(copy != m || m.empty());
+   }
+}
+
+NTL_TEST_SUITE(hash_map)
+{
+   run_differential<ntl::bounded_hash_map<int, int, 100>>(ctx, int_key, 300, 20000);
+   run_differential<ntl::bounded_hash_map<int, int, 100, colliding_hash>>(ctx, int_key, 300, 20000);
+   run_differential<ntl::bounded_hash_map<std::string, int, 50, std::hash<std::string>, std::equal_to<std::string>, 95>>(ctx, string_key, 120, 20000);
+   run_differential<ntl::bounded_hash_map<int, int, 3>>(ctx, int_key, 10, 5000);
+
+   ntl::bounded_hash_map<int, std::string, 4> m{ { 1, "a" }, { 2, "b" } };
+   m.try_emplace(3, "c");
+   m[4].push_back('d');
+   NTL_CHECK(m.size() == 4);
+   NTL_CHECK_THROWS(m[5], std::runtime_error);
+   NTL_CHECK(m.at(3) == "c");
+   NTL_CHECK(m.at(4) == "d");
+   NTL_CHECK_THROWS(m.at(9), std::out_of_range);
+
+   // Inserting a key that is already present succeeds on a full map
+   NTL_CHECK(!m.insert({ 1, "z" }).second);
+   NTL_CHECK(m.insert_or_assign(1, std::string("z")).first.value() == "z");
+
+   m.erase(m.find(1));
+   NTL_CHECK(!m.contains(1));
+   NTL_CHECK(m.size() == 3);
+}
@@ -0,0 +1,89 @@
+#include <cstdio>
+#include <cstring>
+
+#include "test.h"
+
+namespace test
+{
+   std::vector<suite>& registry()
+   {
+      static std::vector<suite> s_Suites;
+      return s_Suites;
+   }
+
+   void context::check(bool passed, const char* file, int line, const char* expr)
+   {
+      ++m_Checks;
+      if (!passed)
+      {
+         ++m_Failures;
+         std::printf("%s:%d: check failed: %s\n", file, line, expr);
+         std::fflush(stdout);
+      }
+   }
+}
+
+namespace
+{
+   bool wanted(int argc, char** argv, const char* name)
+   {
+      if (argc < 2)
+      {
+         return true;
+      }
+
+      for (int i = 1; i < argc; ++i)
+      {
+         if (std::strcmp(argv[i], name) == 0)
+         {
+            return true;
+         }
+      }
+
+      return false;
+   }
+}
+
+// ntl_tests [suite...] runs the named suites, or all of them; the exit code
+// is nonzero if any check failed or a name matched no suite
+int main(int argc, char** argv)
+{
+   if (argc == 2 && std::strcmp(argv[1], "--list") == 0)
+   {
+      for (const test::suite& s : test::registry())
+      {
+         std::printf("%s\n", s.m_Name);
+      }
+
+      return 0;
+   }
+
+   for (int i = 1; i < argc; ++i)
+   {
+      bool known = false;
+      for (const test::suite& s : test::registry())
+      {
+         known = known || std::strcmp(argv[i], s.m_Name) == 0;
+      }
+
+      if (!known)
+      {
+         std::printf("unknown suite %s\n", argv[i]);
+         return 1;
+      }
+   }
+
+   test::context ctx;
+   for (const test::suite& s : test::registry())
+   {
+      if (wanted(argc, argv, s.m_Name))
+      {
+         unsigned failuresBefore = ctx.failures();
+         s.m_Func(ctx);
+         std::printf("%-24s %s\n", s.m_Name, ctx.failures() == failuresBefore ? "ok" : "FAILED");
+      }
+   }
+
+   std::printf("%u checks, %u failed\n", ctx.checks(), ctx.failures());
+   return ctx.failures() == 0 ? 0 : 1;
+}
@@ -0,0 +1,167 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_bounded_vector.h"
+#include "test.h"
+
+namespace
+{
+   struct record
+   {
+      std::uint32_t m_Id;
+      float m_Value;
+      char m_Tag[8];
+   };
+
+   using record_vector = ntl::mapped_bounded_vector<record, 100>;
+
+   record make_record(std::uint32_t id, const char* tag)
+   {
+      record r{ id, id * 0.5f, {} };
+      std::strncpy(r.m_Tag, tag, sizeof(r.m_Tag) - 1);
+      return r;
+   }
+
+   std::string temp_path()
+   {
+      return "/tmp/ntl_mapped_test_" + std::to_string(getpid()) + ".vec";
+   }
+
+   void run_round_trip(test::context& ctx, const char* path)
+   {
+      NTL_CHECK_THROWS(record_vector(path, ntl::map_mode::open_existing), std::runtime_error);
+
+      {
+         record_vector v(path);
+         NTL_CHECK(v.empty());
+         NTL_CHECK(v.verify());
+         NTL_CHECK(reinterpret_cast<std::uintptr_t>(v.data()) % ntl::cache_line_size == 0);
+         for (std::uint32_t i = 0; i < 60; ++i)
+         {
+            v.push_back(make_record(i, "abc"));
+         }
+
+         v.pop_back();
+         auto tail = v.append_uninitialized(2);
+         tail[0] = make_record(1000, "x");
+         v.commit_append(1);
+         v.sync();
+         NTL_CHECK(v.verify());
+         NTL_CHECK(v.size() == 60);
+
+         record_vector moved = std::move(v);
+         NTL_CHECK(moved.size() == 60);
+      }
+
+      struct stat st;
+      NTL_CHECK(::stat(path, &st) == 0 && static_cast<std::size_t>(st.st_size) == record_vector::file_size);
+
+      record_vector v(path, ntl::map_mode::open_existing);
+      NTL_CHECK(v.size() == 60);
+      NTL_CHECK(v.verify());
+      NTL_CHECK(v[10].m_Id == 10);
+      NTL_CHECK(v.back().m_Id == 1000);
+      NTL_CHECK(std::string(v[3].m_Tag) == "abc");
+   }
+
+   // Changes reach the file without sync(), but the checksum only covers
+   // what was synced, so verify() flags the difference
+   void run_unsynced_change(test::context& ctx, const char* path)
+   {
+      {
+         record_vector v(path);
+         NTL_CHECK(v.verify());
+         v[5].m_Id = 77;
+         NTL_CHECK(!v.verify());
+      }
+
+      {
+         record_vector v(path);
+         NTL_CHECK(v[5].m_Id == 77);
+         NTL_CHECK(!v.verify());
+         v.sync();
+         NTL_CHECK(v.verify());
+
+         v.push_back(make_record(1, "y"));
+         NTL_CHECK(!v.verify());
+         v.resize(70);
+         NTL_CHECK(v[69].m_Id == 0);
+         v.resize(3);
+         NTL_CHECK(v.size() == 3);
+         NTL_CHECK_THROWS(v.resize(101), std::runtime_error);
+         v.sync();
+      }
+   }
+
+   void run_layout_rejection(test::context& ctx, const char* path)
+   {
+      // A different capacity changes the file size
+      NTL_CHECK_THROWS((ntl::mapped_bounded_vector<record, 99>(path)), std::runtime_error);
+
+      // Same file size, different element size: caught by the header
+      static_assert(ntl::mapped_bounded_vector<std::uint64_t, 200>::file_size == record_vector::file_size, "sizes must match for this case");
+      NTL_CHECK_THROWS((ntl::mapped_bounded_vector<std::uint64_t, 200>(path)), std::runtime_error);
+
+      // A file that is not a mapped_bounded_vector at all
+      std::string other = std::string(path) + ".other";
+      std::FILE* f = std::fopen(other.c_str(), "wb");
+      NTL_CHECK(f != nullptr);
+      if (f != nullptr)
+      {
+         char zeros[record_vector::file_size] = {};
+         std::fwrite(zeros, 1, sizeof(zeros), f);
+         std::fclose(f);
+         NTL_CHECK_THROWS(record_vector(other.c_str()), std::runtime_error);
+         std::remove(other.c_str());
+      }
+
+      // The rejected attempts left the file alone
+      record_vector v(path, ntl::map_mode::open_existing);
+      NTL_CHECK(v.size() == 3);
+   }
+
+   void run_truncate(test::context& ctx, const char* path)
+   {
+      using word_vector = ntl::mapped_bounded_vector<std::uint32_t, 10>;
+
+      {
+         record_vector v(path, ntl::map_mode::create);
+         NTL_CHECK(v.empty());
+         NTL_CHECK(v.verify());
+      }
+
+      // create also replaces a file whose layout does not match
+      {
+         word_vector words(path, ntl::map_mode::create);
+         words.push_back(5);
+         words.sync();
+      }
+
+      struct stat st;
+      NTL_CHECK(::stat(path, &st) == 0 && static_cast<std::size_t>(st.st_size) == word_vector::file_size);
+      word_vector reopened(path, ntl::map_mode::open_existing);
+      NTL_CHECK(reopened.size() == 1 && reopened[0] == 5);
+   }
+}
+
+NTL_TEST_SUITE(mapped_vector)
+{
+   std::string path = temp_path();
+   std::remove(path.c_str());
+
+   run_round_trip(ctx, path.c_str());
+   run_unsynced_change(ctx, path.c_str());
+   run_layout_rejection(ctx, path.c_str());
+   run_truncate(ctx, path.c_str());
+   std::remove(path.c_str());
+
+   // Reference check value of CRC-32/ISO-HDLC
+   NTL_CHECK(ntl::detail::crc32("123456789", 9) == 0xCBF43926u);
+   NTL_CHECK(ntl::detail::crc32("56789", 5, ntl::detail::crc32("1234", 4)) == 0xCBF43926u);
+}
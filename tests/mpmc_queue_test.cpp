@@ -0,0 +1,172 @@
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "mpmc_bounded_queue.h"
+#include "test.h"
+
+namespace
+{
+   // Throws from the copy constructor or move assignment while armed
+   struct fragile
+   {
+      static int s_ThrowOnCopy;
+      static int s_ThrowOnAssign;
+      static int s_Live;
+
+      int m_Value;
+
+      explicit fragile(int value) :
+         m_Value(value)
+      {
+         ++s_Live;
+      }
+
+      fragile(const fragile& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         if (s_ThrowOnCopy == rhs.m_Value)
+         {
+            throw std::runtime_error("copy");
+         }
+
+         ++s_Live;
+      }
+
+      fragile& operator = (fragile&& rhs)
+      {
+         if (s_ThrowOnAssign == rhs.m_Value)
+         {
+            throw std::runtime_error("assign");
+         }
+
+         m_Value = rhs.m_Value;
+         return *this;
+      }
+
+      ~fragile()
+      {
+         --s_Live;
+      }
+   };
+
+   int fragile::s_ThrowOnCopy = -1;
+   int fragile::s_ThrowOnAssign = -1;
+   int fragile::s_Live = 0;
+
+   void run_throwing_elements(test::context& ctx)
+   {
+      {
+         ntl::mpmc_bounded_queue<fragile, 4> q;
+         fragile::s_ThrowOnCopy = 2;
+         for (int i = 1; i <= 4; ++i)
+         {
+            fragile value(i);
+            if (i == 2)
+            {
+               NTL_CHECK_THROWS(q.try_push(value), std::runtime_error);
+            }
+            else
+            {
+               NTL_CHECK(q.try_push(value));
+            }
+         }
+
+         fragile::s_ThrowOnCopy = -1;
+
+         // The abandoned slot is skipped and then reused
+         fragile out(0);
+         NTL_CHECK(q.try_pop(out) && out.m_Value == 1);
+         NTL_CHECK(q.try_pop(out) && out.m_Value == 3);
+         NTL_CHECK(q.try_push(fragile(5)));
+         NTL_CHECK(q.try_push(fragile(6)));
+
+         // A throwing move out loses that element but frees its slot
+         fragile::s_ThrowOnAssign = 4;
+         NTL_CHECK_THROWS(q.try_pop(out), std::runtime_error);
+         fragile::s_ThrowOnAssign = -1;
+         NTL_CHECK(q.try_push(fragile(7)));
+         NTL_CHECK(q.try_pop(out) && out.m_Value == 5);
+         NTL_CHECK(q.try_pop(out) && out.m_Value == 6);
+         NTL_CHECK(q.try_pop(out) && out.m_Value == 7);
+         NTL_CHECK(!q.try_pop(out));
+
+         // Left behind for the destructor, next to an abandoned slot
+         fragile::s_ThrowOnCopy = 9;
+         fragile left(8);
+         fragile dropped(9);
+         NTL_CHECK(q.try_push(left));
+         NTL_CHECK_THROWS(q.try_push(dropped), std::runtime_error);
+         fragile::s_ThrowOnCopy = -1;
+      }
+
+      NTL_CHECK(fragile::s_Live == 0);
+   }
+
+   // Several producers and consumers mixing blocking and try_ calls; every
+   // value must come out exactly once
+   void run_threads(test::context& ctx)
+   {
+      constexpr unsigned numProducers = 3;
+      constexpr unsigned numConsumers = 3;
+      constexpr std::uint64_t perProducer = 50000;
+
+      ntl::mpmc_bounded_queue<std::uint64_t, 64> q;
+      std::vector<std::uint64_t> sums(numConsumers, 0);
+      std::vector<std::thread> threads;
+      for (unsigned p = 0; p < numProducers; ++p)
+      {
+         threads.emplace_back([&q, p]()
+         {
+            for (std::uint64_t i = 1; i <= perProducer; ++i)
+            {
+               if (i % 2 == 0)
+               {
+                  q.push(i);
+               }
+               else
+               {
+                  while (!q.try_push(i))
+                  {
+                     std::this_thread::yield();
+                  }
+               }
+            }
+         });
+      }
+
+      for (unsigned c = 0; c < numConsumers; ++c)
+      {
+         threads.emplace_back([&q, &sums, c]()
+         {
+            for (std::uint64_t i = 0; i < perProducer; ++i)
+            {
+               std::uint64_t value = 0;
+               q.pop(value);
+               sums[c] += value;
+            }
+         });
+      }
+
+      for (std::thread& th : threads)
+      {
+         th.join();
+      }
+
+      std::uint64_t total = 0;
+      for (std::uint64_t sum : sums)
+      {
+         total += sum;
+      }
+
+      NTL_CHECK(total == numProducers * perProducer * (perProducer + 1) / 2);
+      NTL_CHECK(q.size() == 0);
+   }
+}
+
+NTL_TEST_SUITE(mpmc_queue)
+{
+   run_throwing_elements(ctx);
+   run_threads(ctx);
+}
@@ -0,0 +1,177 @@
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "bounded_flat_map.h"
+#include "bounded_flat_set.h"
+#include "bounded_hash_map.h"
+#include "bounded_slot_map.h"
+#include "bounded_soa_vector.h"
+#include "bounded_vector.h"
+#include "concurrent_bounded_vector.h"
+#include "container_stats.h"
+#include "mpmc_bounded_queue.h"
+#include "ntl_config.h"
+#include "overflow_policy.h"
+#include "simd_compare.h"
+#include "small_vector.h"
+#include "spsc_ring.h"
+#include "stats_policy.h"
+#include "test.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "mapped_bounded_vector.h"
+#include "shared_bounded_vector.h"
+
+#define NTL_TEST_CAN_FORK 1
+#else
+#define NTL_TEST_CAN_FORK 0
+#endif
+
+// Built with -fno-exceptions: every header has to compile that way, the
+// containers have to work as usual, and a failed check has to abort
+// instead of throwing.
+#if NTL_HAS_EXCEPTIONS
+#error "no_exceptions_test.cpp must be built without exceptions"
+#endif
+
+namespace
+{
+#if NTL_TEST_CAN_FORK
+   // Runs fail() in a child process and reports whether it died of SIGABRT
+   template <typename Func>
+   bool aborts(Func fail)
+   {
+      std::fflush(stdout);
+      pid_t pid = fork();
+      if (pid == 0)
+      {
+         // No core file for the expected abort; the assert message stays
+         struct rlimit noCore = { 0, 0 };
+         setrlimit(RLIMIT_CORE, &noCore);
+         fail();
+         _exit(0);
+      }
+
+      int status = 0;
+      return pid > 0 && waitpid(pid, &status, 0) == pid && WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+   }
+#endif
+
+   void run_containers(test::context& ctx)
+   {
+      ntl::bounded_vector<int, 8> v{ 1, 2, 3 };
+      v.push_back(4);
+      NTL_CHECK(v.try_push_back(5) != nullptr);
+      NTL_CHECK(v.at(4) == 5);
+      NTL_CHECK(v.contains(3));
+
+      ntl::bounded_vector<std::uint16_t, 8, std::allocator<std::uint16_t>, ntl::overflow::saturate> saturating;
+      saturating.resize(8);
+      saturating.push_back(1);
+      NTL_CHECK(saturating.get_overflow_policy().dropped() == 1);
+
+      ntl::bounded_flat_map<int, int, 4> flatMap{ { 2, 20 }, { 1, 10 } };
+      NTL_CHECK(flatMap.at(2) == 20);
+      ntl::bounded_flat_set<int, 4> flatSet{ 3, 1, 3 };
+      NTL_CHECK(flatSet.size() == 2);
+      ntl::bounded_hash_map<int, int, 4> hashMap{ { 1, 10 } };
+      NTL_CHECK(hashMap.at(1) == 10);
+
+      ntl::bounded_slot_map<std::string, 4> slotMap;
+      auto h = slotMap.insert("slot");
+      NTL_CHECK(slotMap.at(h) == "slot");
+
+      ntl::bounded_soa_vector<4, int, float> soa;
+      soa.emplace_back(1, 2.0f);
+      NTL_CHECK(soa.column<0>()[0] == 1);
+
+      ntl::small_vector<std::string, 2> small{ "a", "b", "c" };
+      NTL_CHECK(small.size() == 3 && small.at(2) == "c");
+
+      ntl::spsc_ring<int, 4> ring;
+      int out = 0;
+      NTL_CHECK(ring.try_push(7) && ring.try_pop(out) && out == 7);
+
+      ntl::mpmc_bounded_queue<int, 4> queue;
+      NTL_CHECK(queue.try_push(8) && queue.try_pop(out) && out == 8);
+
+      ntl::concurrent_bounded_vector<int, 4> concurrent;
+      concurrent.push_back(9);
+      NTL_CHECK(concurrent.published_size() == 1 && concurrent[0] == 9);
+
+#if NTL_TEST_CAN_FORK
+      std::string path = "/tmp/ntl_no_exceptions_" + std::to_string(getpid()) + ".vec";
+      {
+         ntl::mapped_bounded_vector<int, 16> mapped(path.c_str(), ntl::map_mode::create);
+         mapped.push_back(10);
+         NTL_CHECK(mapped.size() == 1 && mapped[0] == 10);
+      }
+      std::remove(path.c_str());
+
+      std::string name = "/ntl_no_exceptions_" + std::to_string(getpid());
+      {
+         ntl::shared_bounded_vector<int, 16> shared(name.c_str(), ntl::map_mode::create);
+         NTL_CHECK(shared.try_push_back(11) && shared[0] == 11);
+      }
+      ntl::shared_bounded_vector<int, 16>::unlink(name.c_str());
+#endif
+   }
+
+   void run_abort_paths(test::context& ctx)
+   {
+#if NTL_TEST_CAN_FORK
+      NTL_CHECK(aborts([]
+      {
+         ntl::bounded_vector<int, 2> v{ 1, 2 };
+         v.push_back(3);
+      }));
+
+      NTL_CHECK(aborts([]
+      {
+         ntl::bounded_vector<int, 2> v{ 1 };
+         (void)v.at(1);
+      }));
+
+      NTL_CHECK(aborts([]
+      {
+         ntl::bounded_flat_map<int, int, 2> m{ { 1, 1 }, { 2, 2 } };
+         m[3] = 3;
+      }));
+
+      NTL_CHECK(aborts([]
+      {
+         ntl::bounded_hash_map<int, int, 2> m;
+         (void)m.at(1);
+      }));
+
+      NTL_CHECK(aborts([]
+      {
+         ntl::bounded_slot_map<int, 1> m;
+         m.insert(1);
+         m.insert(2);
+      }));
+
+      NTL_CHECK(aborts([]
+      {
+         ntl::mapped_bounded_vector<int, 4> m("/nonexistent-dir/ntl.vec", ntl::map_mode::open_existing);
+      }));
+
+      // Sanity check of the helper itself
+      NTL_CHECK(!aborts([] {}));
+#else
+      (void)ctx;
+#endif
+   }
+}
+
+NTL_TEST_SUITE(no_exceptions)
+{
+   run_containers(ctx);
+   run_abort_paths(ctx);
+}
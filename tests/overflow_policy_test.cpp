@@ -0,0 +1,148 @@
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <stdexcept>
+
+#include "bounded_vector.h"
+#include "test.h"
+
+namespace
+{
+   template <typename OverflowPolicy>
+   using int_vector = ntl::bounded_vector<int, 4, std::allocator<int>, OverflowPolicy>;
+
+   template <typename Vector>
+   bool holds(const Vector& v, std::initializer_list<int> expected)
+   {
+      return v.size() == expected.size() && std::equal(v.begin(), v.end(), expected.begin());
+   }
+
+   void run_throw_error(test::context& ctx)
+   {
+      int_vector<ntl::overflow::throw_error> v{ 1, 2 };
+      NTL_CHECK_THROWS(v.insert(v.cend(), { 3, 4, 5 }), std::runtime_error);
+      NTL_CHECK_THROWS(v.insert(v.cbegin(), 3, 9), std::runtime_error);
+      NTL_CHECK_THROWS(v.resize(5), std::runtime_error);
+      NTL_CHECK(holds(v, { 1, 2 }));
+
+      v.push_back(3);
+      v.push_back(4);
+      NTL_CHECK_THROWS(v.push_back(5), std::runtime_error);
+      NTL_CHECK(holds(v, { 1, 2, 3, 4 }));
+   }
+
+   void run_assert_only(test::context& ctx)
+   {
+      // No runtime check, so only inserts that fit are defined
+      static_assert(!ntl::overflow::assert_only::check_capacity, "");
+
+      int_vector<ntl::overflow::assert_only> v{ 1, 2 };
+      v.insert(v.cbegin() + 1, { 7, 8 });
+      NTL_CHECK(holds(v, { 1, 7, 8, 2 }));
+   }
+
+   void run_drop(test::context& ctx)
+   {
+      int_vector<ntl::overflow::drop> v;
+      v.insert(v.cend(), { 1, 2, 3, 4, 5, 6 });
+      NTL_CHECK(holds(v, { 1, 2, 3, 4 }));
+      v.push_back(7);
+      NTL_CHECK(holds(v, { 1, 2, 3, 4 }));
+
+      // A batch that partly fits keeps its leading elements
+      v.erase(v.cbegin() + 1, v.cbegin() + 3);
+      v.insert(v.cbegin() + 1, { 8, 9, 10 });
+      NTL_CHECK(holds(v, { 1, 8, 9, 4 }));
+
+      // Nothing fits at all
+      auto it = v.insert(v.cbegin(), 2, 0);
+      NTL_CHECK(it == v.end() && holds(v, { 1, 8, 9, 4 }));
+
+      v.resize(2);
+      v.resize(6, 5);
+      NTL_CHECK(holds(v, { 1, 8, 5, 5 }));
+
+      v.resize(3);
+      NTL_CHECK(v.append_uninitialized(3).size() == 1);
+   }
+
+   void run_saturate(test::context& ctx)
+   {
+      int_vector<ntl::overflow::saturate> v{ 1 };
+      v.insert(v.cbegin(), { 2, 3, 4, 5, 6 });
+      NTL_CHECK(holds(v, { 2, 3, 4, 1 }));
+      NTL_CHECK(v.get_overflow_policy().dropped() == 2);
+
+      v.push_back(7);
+      v.emplace(v.cbegin(), 8);
+      NTL_CHECK(v.get_overflow_policy().dropped() == 4);
+
+      v.pop_back();
+      v.insert(v.cend(), 3, 9);
+      NTL_CHECK(holds(v, { 2, 3, 4, 9 }));
+      NTL_CHECK(v.get_overflow_policy().dropped() == 6);
+
+      // Dropped elements are a running total that clear() does not reset
+      v.clear();
+      v.resize(5);
+      NTL_CHECK(v.size() == 4 && v.get_overflow_policy().dropped() == 7);
+   }
+
+   void run_overwrite_oldest(test::context& ctx)
+   {
+      int_vector<ntl::overflow::overwrite_oldest> v;
+      for (int i = 0; i < 10; ++i)
+      {
+         v.push_back(i);
+      }
+
+      // Ten appends into four slots: 8 and 9 wrapped onto slots 0 and 1
+      std::size_t oldest = v.get_overflow_policy().oldest_index();
+      NTL_CHECK(oldest == 2);
+      NTL_CHECK(holds(v, { 8, 9, 6, 7 }));
+      int expected = 6;
+      for (std::size_t i = 0; i < v.size(); ++i)
+      {
+         NTL_CHECK(v[(oldest + i) % v.size()] == expected++);
+      }
+
+      // Once an element is erased the ring restarts, so appends fill the end
+      // and the next wrap overwrites slot 0
+      v.erase(v.cbegin() + 3);
+      NTL_CHECK(v.get_overflow_policy().oldest_index() == 0);
+      v.push_back(10);
+      v.push_back(11);
+      NTL_CHECK(holds(v, { 11, 9, 6, 10 }));
+      NTL_CHECK(v.get_overflow_policy().oldest_index() == 1);
+
+      // Every way of shrinking resets it
+      v.pop_back();
+      NTL_CHECK(v.get_overflow_policy().oldest_index() == 0);
+      v.push_back(12);
+      v.push_back(13);
+      v.resize(2);
+      NTL_CHECK(v.get_overflow_policy().oldest_index() == 0);
+      v.resize(4);
+      v.push_back(14);
+      ntl::erase(v, 0);
+      NTL_CHECK(v.get_overflow_policy().oldest_index() == 0);
+      v.push_back(15);
+      v.push_back(16);
+      NTL_CHECK(holds(v, { 14, 9, 15, 16 }));
+
+      // A bulk insert keeps what fits
+      v.clear();
+      v.insert(v.cend(), { 1, 2, 3, 4, 5 });
+      NTL_CHECK(holds(v, { 1, 2, 3, 4 }));
+   }
+}
+
+NTL_TEST_SUITE(overflow_policy)
+{
+   run_throw_error(ctx);
+   run_assert_only(ctx);
+   run_drop(ctx);
+   run_saturate(ctx);
+   run_overwrite_oldest(ctx);
+}
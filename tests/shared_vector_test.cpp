@@ -0,0 +1,124 @@
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "shared_bounded_vector.h"
+#include "test.h"
+
+namespace
+{
+   constexpr int appenders = 4;
+   constexpr int appends_per_process = 250;
+
+   using log_vector = ntl::shared_bounded_vector<std::uint64_t, appenders * appends_per_process>;
+
+   std::string segment_name()
+   {
+      return "/ntl_shared_test_" + std::to_string(getpid());
+   }
+
+   std::uint64_t make_value(int appender, int i)
+   {
+      return static_cast<std::uint64_t>(appender) << 32 | static_cast<std::uint32_t>(i);
+   }
+
+   // Runs in the forked child: the appenders race to create the segment
+   // and then fill it together
+   [[noreturn]] void append_and_exit(const char* name, int appender)
+   {
+      int status = 0;
+      try
+      {
+         log_vector v(name);
+         for (int i = 0; i < appends_per_process; ++i)
+         {
+            v.push_back(make_value(appender, i));
+         }
+      }
+      catch (...)
+      {
+         status = 1;
+      }
+
+      ::_exit(status);
+   }
+
+   void run_appenders(test::context& ctx, const char* name)
+   {
+      std::vector<pid_t> pids;
+      for (int appender = 0; appender < appenders; ++appender)
+      {
+         pid_t pid = ::fork();
+         if (pid == 0)
+         {
+            append_and_exit(name, appender);
+         }
+
+         NTL_CHECK(pid > 0);
+         pids.push_back(pid);
+      }
+
+      for (pid_t pid : pids)
+      {
+         int status = 0;
+         NTL_CHECK(::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0);
+      }
+
+      log_vector v(name, ntl::map_mode::open_existing);
+      NTL_CHECK(v.full());
+      NTL_CHECK(v.published_prefix() == v.capacity());
+      NTL_CHECK(!v.try_push_back(0));
+      NTL_CHECK(v.size() == v.capacity());
+
+      // Every value exactly once, and each appender's values in the order
+      // it appended them, since its slots were reserved in that order
+      std::vector<int> next(appenders, 0);
+      bool inOrder = true;
+      for (std::size_t i = 0; i < v.size(); ++i)
+      {
+         int appender = static_cast<int>(v[i] >> 32);
+         int seq = static_cast<int>(v[i] & 0xFFFFFFFFu);
+         if (appender >= appenders || seq != next[appender]++)
+         {
+            inOrder = false;
+         }
+      }
+
+      NTL_CHECK(inOrder);
+      NTL_CHECK(next == std::vector<int>(appenders, appends_per_process));
+
+      v.clear();
+      NTL_CHECK(v.empty() && v.published_prefix() == 0 && v.try_get(0) == nullptr);
+   }
+
+   void run_layout_rejection(test::context& ctx, const char* name)
+   {
+      // A different capacity changes the segment size
+      NTL_CHECK_THROWS((ntl::shared_bounded_vector<std::uint64_t, 999>(name)), std::runtime_error);
+
+      // Same segment size, different element size: caught by the header
+      using word_vector = ntl::shared_bounded_vector<std::uint32_t, 2 * appenders * appends_per_process>;
+      static_assert(word_vector::segment_size == log_vector::segment_size, "sizes must match for this case");
+      NTL_CHECK_THROWS(word_vector(name, ntl::map_mode::open_existing), std::runtime_error);
+
+      // The rejected attempts left the segment alone
+      log_vector v(name, ntl::map_mode::open_existing);
+      v.push_back(7);
+      NTL_CHECK(v.size() == 1 && v[0] == 7);
+   }
+}
+
+NTL_TEST_SUITE(shared_vector)
+{
+   std::string name = segment_name();
+   log_vector::unlink(name.c_str());
+
+   NTL_CHECK_THROWS(log_vector(name.c_str(), ntl::map_mode::open_existing), std::runtime_error);
+   run_appenders(ctx, name.c_str());
+   run_layout_rejection(ctx, name.c_str());
+   NTL_CHECK(log_vector::unlink(name.c_str()));
+}
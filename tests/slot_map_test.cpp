@@ -0,0 +1,125 @@
+#include <cstdint>
+#include <iterator>
+#include <map>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bounded_slot_map.h"
+#include "test.h"
+
+namespace
+{
+   int int_value(int i)
+   {
+      return i;
+   }
+
+   std::string string_value(int i)
+   {
+      return std::to_string(i) + "-padding-past-the-sso-buffer";
+   }
+
+   // Random inserts and erases, tracking live handles in a std::map; erased
+   // handles must never resolve again, even once their slot is reused
+   template <typename Map, typename MakeValue>
+   void run_differential(test::context& ctx, MakeValue makeValue)
+   {
+      using handle = typename Map::handle;
+
+      std::mt19937 rng(3);
+      Map m;
+      std::map<std::uint32_t, int> live;
+      std::vector<handle> dead;
+      NTL_CHECK(!m.contains(handle()));
+      for (int i = 0; i < 50000; ++i)
+      {
+         if (rng() % 2 != 0 && m.size() < m.capacity())
+         {
+            handle h = m.emplace(makeValue(i));
+            NTL_CHECK(static_cast<bool>(h));
+            NTL_CHECK(live.count(h.raw()) == 0);
+            live[h.raw()] = i;
+         }
+         else if (!live.empty())
+         {
+            auto it = live.begin();
+            std::advance(it, rng() % live.size());
+            handle h(it->first);
+            NTL_CHECK(m.erase(h));
+            NTL_CHECK(!m.erase(h));
+            dead.push_back(h);
+            live.erase(it);
+         }
+
+         NTL_CHECK(m.size() == live.size());
+         if (i % 501 == 0)
+         {
+            for (const auto& entry : live)
+            {
+               handle h(entry.first);
+               NTL_CHECK(m.contains(h));
+               NTL_CHECK(m[h] == makeValue(entry.second));
+               NTL_CHECK(m.get(h) != nullptr && *m.get(h) == makeValue(entry.second));
+            }
+
+            for (handle h : dead)
+            {
+               NTL_CHECK(!m.contains(h));
+               NTL_CHECK(m.get(h) == nullptr);
+            }
+
+            std::size_t visited = 0;
+            for (auto it = m.begin(); it != m.end(); ++it)
+            {
+               handle h = m.handle_of(it);
+               NTL_CHECK(live.count(h.raw()) == 1 && *it == makeValue(live[h.raw()]));
+               ++visited;
+            }
+
+            NTL_CHECK(visited == live.size());
+         }
+      }
+
+      Map copy = m;
+      NTL_CHECK(copy.size() == m.size());
+      for (const auto& entry : live)
+      {
+         NTL_CHECK(copy.contains(handle(entry.first)));
+      }
+
+      m.clear();
+      NTL_CHECK(m.empty());
+      for (const auto& entry : live)
+      {
+         NTL_CHECK(!m.contains(handle(entry.first)));
+      }
+
+      if (!live.empty())
+      {
+         NTL_CHECK_THROWS(m.at(handle(live.begin()->first)), std::out_of_range);
+      }
+   }
+}
+
+NTL_TEST_SUITE(slot_map)
+{
+   run_differential<ntl::bounded_slot_map<int, 100>>(ctx, int_value);
+   run_differential<ntl::bounded_slot_map<std::string, 37>>(ctx, string_value);
+
+   // A single slot cycles through every generation; the handle in use must
+   // always resolve and the default handle never may
+   ntl::bounded_slot_map<int, 1> one;
+   for (int i = 0; i < 1000; ++i)
+   {
+      auto h = one.insert(i);
+      NTL_CHECK(static_cast<bool>(h));
+      NTL_CHECK(one[h] == i);
+      NTL_CHECK(one.erase(h));
+      NTL_CHECK(!one.contains(h));
+   }
+
+   one.insert(1);
+   NTL_CHECK_THROWS(one.insert(2), std::runtime_error);
+}
@@ -0,0 +1,310 @@
+#include <algorithm>
+#include <cstddef>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "small_vector.h"
+#include "test.h"
+
+namespace
+{
+   using string_vector = ntl::small_vector<std::string, 4>;
+
+   std::string make_string(int i)
+   {
+      return std::to_string(i) + "-padding-past-the-sso-buffer";
+   }
+
+   bool same_elements(const string_vector& v, const std::vector<std::string>& ref)
+   {
+      return v.size() == ref.size() && std::equal(v.begin(), v.end(), ref.begin());
+   }
+
+   // Inserts, erases and shrinks across the inline/heap boundary so every
+   // grow path runs
+   void run_differential(test::context& ctx)
+   {
+      std::mt19937 rng(12);
+      string_vector v;
+      std::vector<std::string> ref;
+      for (int i = 0; i < 20000; ++i)
+      {
+         switch (rng() % 6)
+         {
+         case 0:
+         case 1:
+            v.push_back(make_string(i));
+            ref.push_back(make_string(i));
+            break;
+         case 2:
+         {
+            std::size_t pos = rng() % (ref.size() + 1);
+            std::size_t count = rng() % 6;
+            v.insert(v.cbegin() + pos, count, make_string(i));
+            ref.insert(ref.begin() + pos, count, make_string(i));
+            break;
+         }
+         case 3:
+            if (!ref.empty())
+            {
+               std::size_t pos = rng() % ref.size();
+               std::size_t count = std::min<std::size_t>(rng() % 4, ref.size() - pos);
+               v.erase(v.cbegin() + pos, v.cbegin() + pos + count);
+               ref.erase(ref.begin() + pos, ref.begin() + pos + count);
+            }
+            break;
+         case 4:
+            if (rng() % 8 == 0)
+            {
+               v.shrink_to_fit();
+               NTL_CHECK(v.is_inline() == (ref.size() <= 4));
+            }
+            break;
+         default:
+            if (ref.size() > 40)
+            {
+               v.clear();
+               ref.clear();
+            }
+            break;
+         }
+
+         NTL_CHECK(same_elements(v, ref));
+      }
+   }
+
+   // Its move constructor is not noexcept, so growing has to copy, and the
+   // copy throws while armed
+   struct fragile
+   {
+      static int s_ThrowOnCopy;
+      static int s_Live;
+
+      int m_Value;
+
+      explicit fragile(int value) :
+         m_Value(value)
+      {
+         ++s_Live;
+      }
+
+      fragile(const fragile& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         if (s_ThrowOnCopy == rhs.m_Value)
+         {
+            throw std::runtime_error("copy");
+         }
+
+         ++s_Live;
+      }
+
+      fragile(fragile&& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         ++s_Live;
+      }
+
+      fragile& operator = (const fragile&) = default;
+      fragile& operator = (fragile&&) = default;
+
+      ~fragile()
+      {
+         --s_Live;
+      }
+   };
+
+   int fragile::s_ThrowOnCopy = -1;
+   int fragile::s_Live = 0;
+
+   using fragile_vector = ntl::small_vector<fragile, 4>;
+
+   bool holds_sequence(const fragile_vector& v, int count)
+   {
+      if (v.size() != static_cast<std::size_t>(count))
+      {
+         return false;
+      }
+
+      for (int i = 0; i < count; ++i)
+      {
+         if (v[i].m_Value != i)
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   void run_throwing_growth(test::context& ctx)
+   {
+      {
+         fragile_vector v;
+         for (int i = 0; i < 4; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         // Each grow path copies the old elements and throws on element 2;
+         // the vector keeps its inline buffer and its contents
+         fragile::s_ThrowOnCopy = 2;
+         NTL_CHECK_THROWS(v.emplace_back(4), std::runtime_error);
+         NTL_CHECK(v.is_inline() && holds_sequence(v, 4));
+         NTL_CHECK_THROWS(v.reserve(16), std::runtime_error);
+         NTL_CHECK(v.is_inline() && holds_sequence(v, 4));
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 1, 3, fragile(9)), std::runtime_error);
+         NTL_CHECK(v.is_inline() && holds_sequence(v, 4));
+         NTL_CHECK(fragile::s_Live == 4);
+         fragile::s_ThrowOnCopy = -1;
+
+         // Past the inline buffer: a failed regrow keeps the old heap buffer
+         for (int i = 4; i < 8; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         NTL_CHECK(!v.is_inline());
+         const fragile* data = v.data();
+         std::size_t capacity = v.capacity();
+         fragile::s_ThrowOnCopy = 6;
+         NTL_CHECK_THROWS(v.emplace_back(8), std::runtime_error);
+         NTL_CHECK(v.data() == data && v.capacity() == capacity && holds_sequence(v, 8));
+
+         // Dropping to the inline buffer copies too
+         v.erase(v.cbegin() + 4, v.cend());
+         fragile::s_ThrowOnCopy = 1;
+         NTL_CHECK_THROWS(v.shrink_to_fit(), std::runtime_error);
+         NTL_CHECK(v.data() == data && holds_sequence(v, 4));
+         NTL_CHECK(fragile::s_Live == 4);
+
+         fragile::s_ThrowOnCopy = -1;
+         v.shrink_to_fit();
+         NTL_CHECK(v.is_inline() && holds_sequence(v, 4));
+         for (int i = 4; i < 20; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         NTL_CHECK(holds_sequence(v, 20));
+      }
+
+      NTL_CHECK(fragile::s_Live == 0);
+   }
+
+   // A copy that throws partway through an insert leaves the vector as it
+   // was, whether the elements fit or a new buffer is needed
+   void run_throwing_insert(test::context& ctx)
+   {
+      {
+         fragile_vector v;
+         for (int i = 0; i < 2; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         std::vector<fragile> src;
+         for (int i = 10; i < 13; ++i)
+         {
+            src.emplace_back(i);
+         }
+
+         fragile::s_ThrowOnCopy = 11;
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 1, src.begin(), src.begin() + 2), std::runtime_error);
+         NTL_CHECK(v.is_inline() && holds_sequence(v, 2));
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 1, src.begin(), src.end()), std::runtime_error);
+         NTL_CHECK(v.is_inline() && holds_sequence(v, 2));
+         NTL_CHECK(fragile::s_Live == 2 + 3);
+
+         for (int i = 2; i < 6; ++i)
+         {
+            v.emplace_back(i);
+         }
+
+         const fragile* data = v.data();
+         NTL_CHECK_THROWS(v.insert(v.cbegin() + 3, src.begin(), src.end()), std::runtime_error);
+         NTL_CHECK(v.data() == data && holds_sequence(v, 6));
+         NTL_CHECK(fragile::s_Live == 6 + 3);
+
+         fragile::s_ThrowOnCopy = -1;
+         v.insert(v.cbegin() + 1, src.begin(), src.end());
+         v.emplace(v.cbegin() + 1, 9);
+         NTL_CHECK(v.size() == 10 && v[0].m_Value == 0 && v[1].m_Value == 9 && v[2].m_Value == 10 && v[4].m_Value == 12 && v[5].m_Value == 1);
+      }
+
+      NTL_CHECK(fragile::s_Live == 0);
+   }
+
+   // Stateful allocator whose instances only compare equal to copies of
+   // themselves
+   template <typename T>
+   struct tagged_allocator
+   {
+      using value_type = T;
+
+      int m_Tag;
+
+      explicit tagged_allocator(int tag) :
+         m_Tag(tag)
+      {
+      }
+
+      template <typename U>
+      tagged_allocator(const tagged_allocator<U>& rhs) :
+         m_Tag(rhs.m_Tag)
+      {
+      }
+
+      T* allocate(std::size_t count)
+      {
+         return std::allocator<T>().allocate(count);
+      }
+
+      void deallocate(T* p, std::size_t count)
+      {
+         std::allocator<T>().deallocate(p, count);
+      }
+
+      bool operator == (const tagged_allocator& rhs) const
+      {
+         return m_Tag == rhs.m_Tag;
+      }
+
+      bool operator != (const tagged_allocator& rhs) const
+      {
+         return m_Tag != rhs.m_Tag;
+      }
+   };
+
+   using tagged_vector = ntl::small_vector<int, 2, tagged_allocator<int>>;
+
+   static_assert(std::is_nothrow_move_constructible<ntl::small_vector<int, 2>>::value, "");
+   static_assert(!std::is_nothrow_move_constructible<tagged_vector>::value, "");
+   static_assert(!std::is_nothrow_move_assignable<tagged_vector>::value, "");
+
+   // Moving a heap buffer between unequal allocators relocates the elements
+   void run_unequal_allocators(test::context& ctx)
+   {
+      tagged_vector a(tagged_allocator<int>(1));
+      for (int i = 0; i < 5; ++i)
+      {
+         a.push_back(i);
+      }
+
+      tagged_vector b(tagged_allocator<int>(2));
+      b = std::move(a);
+      NTL_CHECK(a.empty() && b.size() == 5 && b[4] == 4);
+      NTL_CHECK(b.get_allocator().m_Tag == 2);
+   }
+}
+
+NTL_TEST_SUITE(small_vector)
+{
+   run_differential(ctx);
+   run_throwing_growth(ctx);
+   run_throwing_insert(ctx);
+   run_unequal_allocators(ctx);
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#include "bounded_soa_vector.h"
+#include "test.h"
+
+namespace
+{
+   using row_type = std::tuple<int, std::string, double>;
+   using soa_type = ntl::bounded_soa_vector<40, int, std::string, double>;
+
+   row_type make_row(int i)
+   {
+      return row_type(i, std::to_string(i) + "-padding-past-the-sso-buffer", i * 0.25);
+   }
+
+   bool same_rows(const soa_type& v, const std::vector<row_type>& ref)
+   {
+      if (v.size() != ref.size())
+      {
+         return false;
+      }
+
+      for (std::size_t i = 0; i < ref.size(); ++i)
+      {
+         if (row_type(v[i]) != ref[i])
+         {
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   void run_differential(test::context& ctx)
+   {
+      std::mt19937 rng(5);
+      soa_type v;
+      std::vector<row_type> ref;
+      for (int i = 0; i < 20000; ++i)
+      {
+         switch (rng() % 5)
+         {
+         case 0:
+            if (ref.size() < v.capacity())
+            {
+               v.push_back(make_row(i));
+               ref.push_back(make_row(i));
+            }
+            else
+            {
+               NTL_CHECK_THROWS(v.push_back(make_row(i)), std::runtime_error);
+            }
+            break;
+         case 1:
+            if (ref.size() < v.capacity())
+            {
+               std::size_t pos = rng() % (ref.size() + 1);
+               auto it = v.insert(v.cbegin() + pos, make_row(i));
+               ref.insert(ref.begin() + pos, make_row(i));
+               NTL_CHECK(it - v.begin() == static_cast<std::ptrdiff_t>(pos));
+            }
+            break;
+         case 2:
+            if (!ref.empty())
+            {
+               std::size_t pos = rng() % ref.size();
+               std::size_t count = std::min<std::size_t>(rng() % 3, ref.size() - pos);
+               v.erase(v.cbegin() + pos, v.cbegin() + pos + count);
+               ref.erase(ref.begin() + pos, ref.begin() + pos + count);
+            }
+            break;
+         case 3:
+            if (!ref.empty())
+            {
+               v.pop_back();
+               ref.pop_back();
+            }
+            break;
+         default:
+         {
+            soa_type copy(v);
+            NTL_CHECK(copy == v);
+            soa_type moved(std::move(copy));
+            NTL_CHECK(moved == v);
+            copy = moved;
+            NTL_CHECK(copy == v);
+            v = std::move(copy);
+            break;
+         }
+         }
+
+         NTL_CHECK(same_rows(v, ref));
+      }
+   }
+
+   // Throws from its copy constructor while armed
+   struct fragile
+   {
+      static int s_ThrowOnCopy;
+
+      int m_Value;
+
+      fragile(int value) :
+         m_Value(value)
+      {
+      }
+
+      fragile(const fragile& rhs) :
+         m_Value(rhs.m_Value)
+      {
+         if (s_ThrowOnCopy == m_Value)
+         {
+            throw std::runtime_error("copy");
+         }
+      }
+
+      fragile(fragile&&) noexcept = default;
+      fragile& operator = (const fragile&) = default;
+      fragile& operator = (fragile&&) noexcept = default;
+
+      bool operator == (const fragile& rhs) const
+      {
+         return m_Value == rhs.m_Value;
+      }
+   };
+
+   int fragile::s_ThrowOnCopy = -1;
+
+   // Its move constructor may throw
+   struct throwing_move
+   {
+      throwing_move() = default;
+      throwing_move(const throwing_move&) = default;
+
+      throwing_move(throwing_move&&)
+      {
+      }
+   };
+
+   static_assert(std::is_nothrow_move_constructible<ntl::bounded_soa_vector<8, int, std::string, fragile>>::value, "");
+   static_assert(std::is_nothrow_move_assignable<ntl::bounded_soa_vector<8, int, std::string, fragile>>::value, "");
+   static_assert(!std::is_nothrow_move_constructible<ntl::bounded_soa_vector<8, int, throwing_move>>::value, "");
+   static_assert(!std::is_nothrow_move_assignable<ntl::bounded_soa_vector<8, int, throwing_move>>::value, "");
+
+   void run_throwing_fields(test::context& ctx)
+   {
+      using fragile_soa = ntl::bounded_soa_vector<8, int, fragile, std::string>;
+
+      fragile_soa v;
+      for (int i = 0; i < 4; ++i)
+      {
+         v.emplace_back(i, fragile(i), std::to_string(i));
+      }
+
+      // The second field throws after the first is built; every column
+      // keeps its rows in step
+      fragile::s_ThrowOnCopy = 9;
+      const std::tuple<int, fragile, std::string> row(9, fragile(9), "nine");
+      NTL_CHECK_THROWS(v.insert(v.cbegin() + 1, row), std::runtime_error);
+      fragile::s_ThrowOnCopy = -1;
+      NTL_CHECK(v.size() == 4);
+      for (int i = 0; i < 4; ++i)
+      {
+         NTL_CHECK(std::get<0>(v[i]) == i && std::get<1>(v[i]).m_Value == i && std::get<2>(v[i]) == std::to_string(i));
+      }
+
+      v.insert(v.cbegin() + 1, row);
+      NTL_CHECK(std::get<0>(v[1]) == 9 && std::get<1>(v[1]).m_Value == 9 && std::get<2>(v[1]) == "nine");
+      NTL_CHECK(std::get<0>(v[2]) == 1 && std::get<2>(v[4]) == "3");
+
+      // A copy that throws in the middle column leaves nothing behind
+      fragile::s_ThrowOnCopy = 2;
+      NTL_CHECK_THROWS(fragile_soa(v), std::runtime_error);
+      fragile_soa target;
+      target.emplace_back(7, fragile(7), "seven");
+      NTL_CHECK_THROWS(target = v, std::runtime_error);
+      fragile::s_ThrowOnCopy = -1;
+      NTL_CHECK(target.empty());
+      target = v;
+      NTL_CHECK(target == v);
+   }
+}
+
+NTL_TEST_SUITE(soa_vector)
+{
+   run_differential(ctx);
+   run_throwing_fields(ctx);
+}
@@ -0,0 +1,143 @@
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "spsc_ring.h"
+#include "test.h"
+
+namespace
+{
+   // push_n, pop_n, peek and consume each split at the end of the buffer
+   void run_wraparound(test::context& ctx)
+   {
+      ntl::spsc_ring<int, 8> r;
+      int in[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+      int out[8] = {};
+      NTL_CHECK(r.push_n(in, 5) == 5);
+      NTL_CHECK(r.pop_n(out, 5) == 5 && out[4] == 4);
+
+      // Slots 5..7 then 0..3; only seven of the ten fit
+      int wide[10] = { 10, 11, 12, 13, 14, 15, 16, 17, 18, 19 };
+      NTL_CHECK(r.push_n(wide, 7) == 7);
+      NTL_CHECK(r.push_n(wide + 7, 3) == 1);
+      NTL_CHECK(r.size() == 8 && !r.try_push(99));
+
+      // peek stops at the wrap point and continues after consume
+      auto first = r.peek();
+      NTL_CHECK(first.size() == 3 && first[0] == 10 && first[2] == 12);
+      r.consume(2);
+      auto second = r.peek();
+      NTL_CHECK(second.size() == 1 && second[0] == 12);
+      r.consume(1);
+      auto third = r.peek();
+      NTL_CHECK(third.size() == 5 && third[0] == 13 && third[4] == 17);
+      r.consume(1);
+
+      // pop_n across the next wrap
+      NTL_CHECK(r.push_n(in, 4) == 4);
+      NTL_CHECK(r.pop_n(out, 8) == 8);
+      NTL_CHECK(out[0] == 14 && out[3] == 17 && out[4] == 0 && out[7] == 3);
+      NTL_CHECK(r.empty() && r.peek().empty() && r.pop_n(out, 1) == 0);
+   }
+
+   // Non-trivial elements are copied in, moved out and destroyed once,
+   // including the ones the destructor has to clean up
+   void run_strings(test::context& ctx)
+   {
+      std::vector<std::string> in;
+      for (int i = 0; i < 6; ++i)
+      {
+         in.push_back(std::to_string(i) + "-padding-past-the-sso-buffer");
+      }
+
+      ntl::spsc_ring<std::string, 4> r;
+      std::string out[4];
+      NTL_CHECK(r.push_n(in.data(), 3) == 3);
+      NTL_CHECK(r.pop_n(out, 2) == 2 && out[1] == in[1]);
+      NTL_CHECK(r.push_n(in.data() + 3, 3) == 3);
+      NTL_CHECK(r.pop_n(out, 4) == 4 && out[0] == in[2] && out[3] == in[5]);
+
+      NTL_CHECK(r.try_emplace(in[0]));
+      NTL_CHECK(r.try_push(std::string(in[1])));
+      auto view = r.peek();
+      NTL_CHECK(view.size() == 2 && view[1] == in[1]);
+      r.consume(1);
+      NTL_CHECK(r.size() == 1);
+   }
+
+   // One producer pushing single values and bursts, one consumer draining
+   // with pop_n and peek/consume; the values must arrive in order
+   void run_threads(test::context& ctx)
+   {
+      constexpr std::uint64_t count = 200000;
+
+      ntl::spsc_ring<std::uint64_t, 64> r;
+      std::thread producer([&r]()
+      {
+         std::uint64_t next = 0;
+         std::uint64_t burst[16];
+         while (next < count)
+         {
+            if (next % 3 == 0)
+            {
+               if (r.try_push(next))
+               {
+                  ++next;
+               }
+            }
+            else
+            {
+               std::uint64_t wanted = std::min<std::uint64_t>(16, count - next);
+               for (std::uint64_t i = 0; i < wanted; ++i)
+               {
+                  burst[i] = next + i;
+               }
+
+               next += r.push_n(burst, wanted);
+            }
+
+            std::this_thread::yield();
+         }
+      });
+
+      std::uint64_t expected = 0;
+      bool inOrder = true;
+      std::uint64_t popped[16];
+      while (expected < count)
+      {
+         if (expected % 2 == 0)
+         {
+            std::size_t n = r.pop_n(popped, 16);
+            for (std::size_t i = 0; i < n; ++i)
+            {
+               inOrder = inOrder && popped[i] == expected++;
+            }
+         }
+         else
+         {
+            auto view = r.peek();
+            for (std::uint64_t value : view)
+            {
+               inOrder = inOrder && value == expected++;
+            }
+
+            r.consume(view.size());
+         }
+
+         std::this_thread::yield();
+      }
+
+      producer.join();
+      NTL_CHECK(inOrder);
+      NTL_CHECK(r.empty());
+   }
+}
+
+NTL_TEST_SUITE(spsc_ring)
+{
+   run_wraparound(ctx);
+   run_strings(ctx);
+   run_threads(ctx);
+}
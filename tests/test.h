@@ -0,0 +1,69 @@
+#pragma once
+#include <vector>
+
+// Minimal self-contained test harness for ntl_tests. Each suite is a
+// function registered at static initialization time; NTL_CHECK records a
+// failure and carries on, so one run reports every broken expectation.
+namespace test
+{
+   class context
+   {
+   public:
+      void check(bool passed, const char* file, int line, const char* expr);
+
+      unsigned checks() const noexcept
+      {
+         return m_Checks;
+      }
+
+      unsigned failures() const noexcept
+      {
+         return m_Failures;
+      }
+
+   private:
+      unsigned m_Checks = 0;
+      unsigned m_Failures = 0;
+   };
+
+   using suite_func = void (*)(context&);
+
+   struct suite
+   {
+      const char* m_Name;
+      suite_func m_Func;
+   };
+
+   std::vector<suite>& registry();
+
+   struct registrar
+   {
+      registrar(const char* name, suite_func func)
+      {
+         registry().push_back(suite{ name, func });
+      }
+   };
+}
+
+#define NTL_TEST_SUITE(name) \
+   static void name##_suite(::test::context&); \
+   static ::test::registrar name##_registrar(#name, &name##_suite); \
+   static void name##_suite(::test::context& ctx)
+
+#define NTL_CHECK(cond) \
+   ctx.check(static_cast<bool>(cond), __FILE__, __LINE__, #cond)
+
+#define NTL_CHECK_THROWS(expr, exception) \
+   do \
+   { \
+      bool threw = false; \
+      try \
+      { \
+         (void)(expr); \
+      } \
+      catch (const exception&) \
+      { \
+         threw = true; \
+      } \
+      ctx.check(threw, __FILE__, __LINE__, #expr " throws " #exception); \
+   } while (0)